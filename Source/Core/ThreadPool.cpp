@@ -0,0 +1,133 @@
+#include "PrecompiledHeader.h"
+#include "ThreadPool.h"
+
+namespace Delta3D::Core
+{
+ThreadPool::ThreadPool( unsigned int threadsCount ) :
+	threads(),
+	jobs(),
+	mutex(),
+	condition(),
+	stop( false )
+{
+	//Keep a hardware thread to the caller (device thread)
+	if( threadsCount == 0 )
+		threadsCount = std::max( std::thread::hardware_concurrency(), 2u ) - 1;
+
+	threads.reserve( threadsCount );
+
+	for( unsigned int i = 0; i < threadsCount; i++ )
+		threads.emplace_back( &ThreadPool::Worker, this );
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		stop = true;
+	}
+
+	condition.notify_all();
+
+	for( auto& thread : threads )
+		if( thread.joinable() )
+			thread.join();
+
+	threads.clear();
+}
+
+void ThreadPool::Push( std::function<void()> job )
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		jobs.push( std::move( job ) );
+	}
+
+	condition.notify_one();
+}
+
+void ThreadPool::ParallelFor( size_t count, const std::function<void( size_t )>& function )
+{
+	if( count == 0 )
+		return;
+
+	//Nothing to spread
+	if( count == 1 || threads.empty() )
+	{
+		for( size_t i = 0; i < count; i++ )
+			function( i );
+
+		return;
+	}
+
+	//Shared with helpers, they can start after the caller returns (busy workers)
+	struct State
+	{
+		std::function<void( size_t )> function;
+		std::atomic<size_t> next;
+		std::atomic<size_t> done;
+		std::mutex mutex;
+		std::condition_variable condition;
+	};
+
+	auto state = std::make_shared<State>();
+	state->function = function;
+	state->next = 0;
+	state->done = 0;
+
+	auto Run = [state, count]()
+	{
+		size_t i;
+		while( (i = state->next.fetch_add( 1 )) < count )
+		{
+			state->function( i );
+
+			if( state->done.fetch_add( 1 ) + 1 == count )
+			{
+				std::lock_guard<std::mutex> lock( state->mutex );
+				state->condition.notify_all();
+			}
+		}
+	};
+
+	//Helpers
+	size_t helpersCount = std::min( count - 1, threads.size() );
+
+	for( size_t i = 0; i < helpersCount; i++ )
+		Push( Run );
+
+	//Caller works too, so it never waits for a Job that wasn't picked up
+	Run();
+
+	std::unique_lock<std::mutex> lock( state->mutex );
+	state->condition.wait( lock, [&state, count]() { return state->done.load() == count; } );
+}
+
+ThreadPool* ThreadPool::Get()
+{
+	static ThreadPool threadPool;
+
+	return &threadPool;
+}
+
+void ThreadPool::Worker()
+{
+	while( true )
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			condition.wait( lock, [this]() { return stop || !jobs.empty(); } );
+
+			if( stop && jobs.empty() )
+				return;
+
+			job = std::move( jobs.front() );
+			jobs.pop();
+		}
+
+		job();
+	}
+}
+}
\ No newline at end of file
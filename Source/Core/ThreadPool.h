@@ -0,0 +1,47 @@
+#pragma once
+
+namespace Delta3D::Core
+{
+class ThreadPool
+{
+public:
+	/**
+	 * Construct a Thread Pool and start workers
+	 * @param threadsCount Number of workers (0 to use one less than hardware threads)
+	 */
+	ThreadPool( unsigned int threadsCount = 0 );
+
+	//! Deconstructor (finish queued jobs and join workers).
+	~ThreadPool();
+
+	//! Thread Pools can't be copied.
+	ThreadPool( const ThreadPool& ) = delete;
+	ThreadPool& operator=( const ThreadPool& ) = delete;
+
+	//! Push a Job to be run by a worker.
+	void Push( std::function<void()> job );
+
+	/**
+	 * Run a function for each index spread across workers and the calling thread
+	 * @param count Number of indices
+	 * @param function Function called with each index (must be thread safe)
+	 */
+	void ParallelFor( size_t count, const std::function<void( size_t )>& function );
+
+	//! Get Workers Count.
+	unsigned int GetThreadsCount() const { return (unsigned int)threads.size(); }
+
+	//! Get shared Thread Pool.
+	static ThreadPool* Get();
+private:
+	//! Worker Loop.
+	void Worker();
+private:
+	std::vector<std::thread> threads;	//!< Workers
+	std::queue<std::function<void()>> jobs;	//!< Pending Jobs
+
+	std::mutex mutex;	//!< Mutex for Jobs Queue
+	std::condition_variable condition;	//!< Signaled when a Job is pushed or Pool is stopping
+	bool stop;	//!< Flag to determinate if workers must finish
+};
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "PrecompiledHeader.h"
+#include "Animator.h"
+
+#include "Model.h"
+#include "Mesh.h"
+#include "Camera.h"
+
+#include "../Core/ThreadPool.h"
+
+namespace Delta3D::Graphics
+{
+Animator::Animator() :
+	phase( 0 ),
+	animatedModelsCount( 0 ),
+	time( 0.0f )
+{
+}
+
+void Animator::Push( Model* model )
+{
+	if( model == nullptr )
+		return;
+
+	models.push_back( AnimatedModel{ model } );
+}
+
+void Animator::Remove( const Model* model )
+{
+	models.erase( std::remove_if( models.begin(), models.end(), [model]( const AnimatedModel& animatedModel ) { return animatedModel.model == model; } ), models.end() );
+}
+
+void Animator::Run( Camera* camera, bool softwareSkinning )
+{
+	auto start = std::chrono::steady_clock::now();
+
+	phase++;
+
+	visibleModels.clear();
+	skeletons.clear();
+	skeletonsIndex.clear();
+
+	//Models outside of Frustum aren't rendered, so they aren't animated too (Models posed by SetFrameBlend are left to it)
+	for( auto& animatedModel : models )
+		if( animatedModel.model->frameBlendPhase != phase && (camera == nullptr || !animatedModel.model->IsCulled( camera )) )
+			visibleModels.push_back( &animatedModel );
+
+	//Skinned Models sharing a Skeleton evaluate it once (last Model pushed wins, as if they were rendered in order)
+	for( const auto animatedModel : visibleModels )
+	{
+		Model* model = animatedModel->model;
+
+		if( model->frame < 0 )
+			continue;
+
+		Model* skeleton = model->skeleton ? model->skeleton : model;
+
+		auto it = skeletonsIndex.find( skeleton );
+
+		if( it != skeletonsIndex.end() )
+			skeletons[it->second].source = animatedModel;
+		else
+		{
+			skeletonsIndex.emplace( skeleton, skeletons.size() );
+			skeletons.push_back( AnimatedSkeleton{ skeleton, animatedModel } );
+		}
+	}
+
+	//Workers don't use the device, Bones Textures are uploaded after Skeletons are evaluated
+	for( const auto& animatedSkeleton : skeletons )
+		animatedSkeleton.skeleton->deferBonesUpload = true;
+
+	auto threadPool = Core::ThreadPool::Get();
+
+	//Evaluate Skeletons and pack Bones palettes
+	threadPool->ParallelFor( skeletons.size(), [this]( size_t i )
+	{
+		const AnimatedSkeleton& animatedSkeleton = skeletons[i];
+		const AnimatedModel* source = animatedSkeleton.source;
+
+		IO::SMD::FrameInfo frameInfo = source->model->renderFrameInfo;
+
+		animatedSkeleton.skeleton->Animate( source->model->frame, source->model->rotation, frameInfo.startFrame >= 0 ? &frameInfo : nullptr );
+	} );
+
+	//Skinned Meshes follow Skeleton and Bounding Volumes are updated
+	threadPool->ParallelFor( visibleModels.size(), [this]( size_t i )
+	{
+		Model* model = visibleModels[i]->model;
+
+		if( model->frame >= 0 && model->skeleton )
+			model->UpdateMeshesWorld();
+
+		model->UpdateBoundingVolumes();
+
+		//Pose evaluated for Model (Render animates it again if Frame, Rotation or Frame Info changed, or if another Model posed Skeleton)
+		if( model->frame >= 0 )
+		{
+			Model* skeleton = model->skeleton ? model->skeleton : model;
+			const Model* source = skeletons[skeletonsIndex.at( skeleton )].source->model;
+
+			model->animatorFrame = skeleton->lastAnimationFrame;
+			model->animatorRotation = skeleton->lastRotation;
+			model->animatorFrameInfo = source->renderFrameInfo;
+			model->animatorPoseVersion = skeleton->poseVersion;
+		}
+
+		model->animatorPhase = phase;
+	} );
+
+	//Each Skeleton owns your Bones Texture, so Palettes packed by workers are uploaded once here
+	for( const auto& animatedSkeleton : skeletons )
+	{
+		animatedSkeleton.skeleton->deferBonesUpload = false;
+
+		if( animatedSkeleton.skeleton->bonesTextureDirty )
+			animatedSkeleton.skeleton->UploadBonesTexture();
+	}
+
+	if( softwareSkinning )
+		SkinMeshes( camera );
+
+	animatedModelsCount = visibleModels.size();
+
+	models.clear();
+	visibleModels.clear();
+
+	time = std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+void Animator::SkinMeshes( Camera* camera )
+{
+	skinningPass.Clear();
+	skinnedMeshes.clear();
+	skinnedSources.clear();
+
+	for( const auto animatedModel : visibleModels )
+	{
+		Model* model = animatedModel->model;
+
+		if( model->skeleton == nullptr || model->skeleton->orderedMeshes.empty() )
+			continue;
+
+		for( const auto mesh : model->meshes )
+		{
+			const Mesh* source = mesh->GetSourceMesh();
+
+			if( mesh->vertexPositionBuffer == nullptr || source->skinnedVertices.empty() )
+				continue;
+
+			//Same culling of Mesh::Render
+			if( camera && camera->Frustum().IsInside( mesh->worldBoundingBox.Transformed( mesh->translation ) ) == Math::Intersection::Outside )
+				continue;
+
+			//Vertex Buffer already holds this Pose
+			if( source->skinnedPose.skeleton == model->skeleton && source->skinnedPose.poseVersion == model->skeleton->poseVersion )
+			{
+				skinningStatistics.skipped.fetch_add( 1, std::memory_order_relaxed );
+				continue;
+			}
+
+			if( skinnedSources.emplace( source, skinnedMeshes.size() ).second == false )
+				continue;
+
+			//Skinning Matrices are built here, so workers only read them
+			const Math::Matrix4* bones = model->skeleton->GetSkinningMatrices();
+
+			const BoneInfluences* influences = source->GetSkinningInfluences( model->skeleton );
+			const BoneDualQuaternion* dualQuaternions = influences && Model::GetSkinningMode() == SkinningMode::DualQuaternion ? model->skeleton->GetSkinningDualQuaternions() : nullptr;
+
+			skinningPass.Push( source->skinnedVertices.data(), source->skinnedVertices.size(), bones, mesh->vertexPositionBuffer, influences, dualQuaternions );
+			skinnedMeshes.push_back( mesh );
+		}
+	}
+
+	skinningPass.Skin();
+	skinningPass.Upload();
+
+	for( size_t i = 0; i < skinnedMeshes.size(); i++ )
+	{
+		//Vertex Buffer couldn't take staged Positions, so Mesh is skinned right away (it would be drawn with last Pose)
+		if( skinningPass.IsUploaded( i ) == false )
+		{
+			skinnedMeshes[i]->Skinning();
+			continue;
+		}
+
+		const Mesh* source = skinnedMeshes[i]->GetSourceMesh();
+		source->skinnedPose.skeleton = skinnedMeshes[i]->modelParent->skeleton;
+		source->skinnedPose.poseVersion = skinnedMeshes[i]->modelParent->skeleton->poseVersion;
+
+		skinningStatistics.performed.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+}
\ No newline at end of file
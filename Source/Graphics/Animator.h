@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SkinningPass.h"
+
+namespace Delta3D::Graphics
+{
+class Model;
+class Mesh;
+class Camera;
+
+class Animator
+{
+public:
+	//! Default Constructor for Animator.
+	Animator();
+
+	//! Deconstructor.
+	~Animator() = default;
+
+	/**
+	 * Push a Model to be animated by next Run (Model::Render pushes every Model it renders, so it's animated ahead on next frame)
+	 * Skeleton is evaluated with Frame, Rotation and Frame Info of last Render, and Render animates it again if any of them changed (Models posed by SetFrameBlend aren't animated)
+	 * @param model Model to be rendered on next frame (a deleted Model is removed by its Deconstructor)
+	 */
+	void Push( Model* model );
+
+	/**
+	 * Animate pushed Models inside of Camera Frustum across worker threads, then upload Bones Palette of each evaluated Skeleton to its Bones Texture (device thread)
+	 * Skeleton evaluation, Bones palette packing, Software Skinning and Bounding Volumes are done before it returns, so it must run before rendering
+	 * @param camera Camera used to cull Models (nullptr to animate every pushed Model)
+	 * @param softwareSkinning Skin visible Meshes into your Vertex Buffers (Software Skinning)
+	 */
+	void Run( Camera* camera, bool softwareSkinning = false );
+
+	//! Clear pushed Models.
+	void Clear() { models.clear(); }
+
+	//! Remove a pushed Model (Model is being deleted before next Run).
+	void Remove( const Model* model );
+
+	//! Get Phase of last Run (Models animated by it aren't animated again by Model::Render on same Pose).
+	unsigned int GetPhase() const { return phase; }
+
+	//! Get number of Models animated by last Run.
+	size_t GetAnimatedModelsCount() const { return animatedModelsCount; }
+
+	//! Get number of Skeletons evaluated by last Run.
+	size_t GetSkeletonsCount() const { return skeletons.size(); }
+
+	//! Get time spent by last Run in milliseconds.
+	float GetTime() const { return time; }
+
+	//! Get Skinning Pass of last Run (Jobs, Vertices and times).
+	const SkinningPass& GetSkinningPass() const { return skinningPass; }
+private:
+	/**
+	 * Skin Meshes of visible Skinned Models across worker threads and upload them (device thread)
+	 * Vertex Buffers shared by instances of different Skeletons take the first Skeleton, others are skinned by Mesh::Render
+	 * @param camera Camera used to cull Meshes (nullptr to skin every Mesh)
+	 */
+	void SkinMeshes( Camera* camera );
+private:
+	struct AnimatedModel
+	{
+		Model* model;	//!< Model pushed
+	};
+
+	struct AnimatedSkeleton
+	{
+		Model* skeleton;	//!< Model evaluated (Skeleton of a Skinned Model or the Model itself)
+		const AnimatedModel* source;	//!< Last Model pushed animating it (gives Frame, Rotation and Frame Info)
+	};
+
+	std::vector<AnimatedModel> models;	//!< Models pushed since last Run
+	std::vector<AnimatedModel*> visibleModels;	//!< Models inside of Camera Frustum
+	std::vector<AnimatedSkeleton> skeletons;	//!< Skeletons evaluated by last Run (each one once)
+	std::unordered_map<Model*, size_t> skeletonsIndex;	//!< Index of each Skeleton on Skeletons List
+
+	SkinningPass skinningPass;	//!< Software Skinning of visible Meshes
+	std::vector<Mesh*> skinnedMeshes;	//!< Mesh of each Skinning Job
+	std::unordered_map<const Mesh*, size_t> skinnedSources;	//!< Skinning Job of each Asset Mesh (Vertex Buffer holds one Pose)
+
+	unsigned int phase;	//!< Runs Counter
+	size_t animatedModelsCount;	//!< Models animated by last Run
+	float time;	//!< Time of last Run in milliseconds
+};
+}
\ No newline at end of file
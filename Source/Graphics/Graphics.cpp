@@ -14,6 +14,12 @@
 #include "VertexDeclaration.h"
 #include "IndexBuffer.h"
 #include "Particle.h"
+#include "Model.h"
+#include "PoseCache.h"
+#include "Animator.h"
+
+#include "../Resource/BackgroundLoader.h"
+#include "../IO/FileSystem.h"
 
 namespace Delta3D::Graphics
 {
@@ -46,12 +52,22 @@ Graphics::Graphics() :
 	shaderFactory = std::make_unique<ShaderFactory>( this );
 	attributeAnimationFactory = std::make_unique<Resource::AttributeAnimationFactory>();
 	particleFactory = std::make_unique<ParticleFactory>( this );
+	modelFactory = std::make_unique<ModelFactory>( this );
+	poseCache = std::make_unique<PoseCache>();
+	animator = std::make_unique<Animator>();
+	backgroundLoader = std::make_unique<Resource::BackgroundLoader>();
 
 	renderer = std::make_unique<Renderer>( this );
 }
 
 Graphics::~Graphics()
 {
+	//Stop workers before resources are released
+	backgroundLoader.reset();
+
+	//Release Model Assets while device is alive
+	modelFactory.reset();
+
 	effectManager->Destroy();
 	effectRenderer->Destroy();
 
@@ -226,6 +242,15 @@ void Graphics::Run()
 {
 	if( IsDeviceReady() )
 	{
+		//Create GPU resources of loaded assets (time budgeted)
+		backgroundLoader->Update();
+
+		//Fill Textures decoded by workers (limited per frame)
+		textureFactory->Update();
+
+		//Release Poses not used recently
+		poseCache->Update();
+
 		renderer->Run();
 	}
 }
@@ -677,6 +702,10 @@ bool Graphics::SetMode( int width_, int height_, bool windowed_, int colorDepth_
 		Sprite::Default = spriteFactory->Create( false );
 		Font::Default = fontFactory->Create( Sprite::Default, "Arial", 16 );
 
+		//Precompiled Effects (optional)
+		if( IO::FileSystem::Get()->Exists( "game\\scripts\\shaders\\shaders.bundle" ) )
+			shaderFactory->LoadBundle( "game\\scripts\\shaders\\shaders.bundle" );
+
 		//Create Default Vertex Declarations
 		for( int i = 0; i < 2; i++ )
 		{
@@ -687,9 +716,12 @@ bool Graphics::SetMode( int width_, int height_, bool windowed_, int colorDepth_
 				pElements->AddElement( 1, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL, 0 );
 				pElements->AddElement( 2, 0, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR, 0 );
 
-				//Skinned Texture (Bone Index)
+				//Skinned Texture (Bones Influences, 4 Bone Indices and 4 Weights)
 				if( i == 1 )
-					pElements->AddElement( 3, 0, D3DDECLTYPE_FLOAT1, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_BLENDINDICES, 0 );
+				{
+					pElements->AddElement( 3, 0, D3DDECLTYPE_UBYTE4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_BLENDINDICES, 0 );
+					pElements->AddElement( 3, 4, D3DDECLTYPE_UBYTE4N, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_BLENDWEIGHT, 0 );
+				}
 
 				//Textures Coordinate Buffer
 				for( int k = 0; k < j; k++ )
@@ -1036,6 +1068,13 @@ bool Graphics::CheckSupport()
 		supportHardwareSkinning = false;
 	}
 
+	//Check Vertex Declaration Types of Bones Influences
+	if( (deviceCaps.DeclTypes & D3DDTCAPS_UBYTE4) == 0 || (deviceCaps.DeclTypes & D3DDTCAPS_UBYTE4N) == 0 )
+	{
+		DELTA3D_LOGERROR( "Your graphics hardware doest not support UBYTE4 Vertex Elements for Hardware Skinning" );
+		supportHardwareSkinning = false;
+	}
+
 	pixelShaderVersionMajor = D3DSHADER_VERSION_MAJOR( deviceCaps.PixelShaderVersion );
 	vertexShaderVersionMajor = D3DSHADER_VERSION_MAJOR( deviceCaps.VertexShaderVersion );
 
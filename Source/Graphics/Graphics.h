@@ -8,6 +8,7 @@
 
 namespace Effekseer{ class Manager; class Effect; typedef int Handle; struct Matrix44; };
 namespace EffekseerRendererDX9{ class Renderer; };
+namespace Delta3D::Resource{ class BackgroundLoader; };
 
 namespace Delta3D::Graphics
 {
@@ -31,6 +32,9 @@ class IndexBuffer;
 class VertexElements;
 class Particle;
 class ParticleFactory;
+class ModelFactory;
+class PoseCache;
+class Animator;
 
 using namespace Math;
 
@@ -120,6 +124,16 @@ public:
 	ShaderFactory* GetShaderFactory() const { return shaderFactory.get(); }
 	Resource::AttributeAnimationFactory* GetAttributeAnimationFactory() const { return attributeAnimationFactory.get(); }
 	ParticleFactory* GetParticleFactory() const{ return particleFactory.get(); }
+	ModelFactory* GetModelFactory() const { return modelFactory.get(); }
+
+	//! Pose Cache Getter.
+	PoseCache* GetPoseCache() const { return poseCache.get(); }
+
+	//! Animator Getter.
+	Animator* GetAnimator() const { return animator.get(); }
+
+	//! Background Loader Getter.
+	Resource::BackgroundLoader* GetBackgroundLoader() const { return backgroundLoader.get(); }
 
 	//! Get Vertex and Pixel Shader Version.
 	int GetVertexShaderVersionMajor() const{ return vertexShaderVersionMajor; }
@@ -270,6 +284,12 @@ public:
 	std::unique_ptr<ShaderFactory> shaderFactory;	//!< Effect Factory
 	std::unique_ptr<Resource::AttributeAnimationFactory> attributeAnimationFactory;	//!< Attribute Animation Factory
 	std::unique_ptr<ParticleFactory> particleFactory;	//!< Particle Factory
+	std::unique_ptr<ModelFactory> modelFactory;	//!< Model Factory
+
+	std::unique_ptr<PoseCache> poseCache;	//!< Evaluated Skeleton Poses shared by instances
+	std::unique_ptr<Animator> animator;	//!< Animation Phase of visible Models
+
+	std::unique_ptr<Resource::BackgroundLoader> backgroundLoader;	//!< Background Loader
 
 	std::unique_ptr<Renderer> renderer;	//!< Renderer
 
@@ -3,6 +3,8 @@
 
 #include "Texture.h"
 
+#include "../IO/FileSystem.h"
+
 namespace Delta3D::Graphics
 {
 
@@ -103,6 +105,8 @@ void Material::PrepareBlendingMaterial()
 
 void Material::Apply()
 {
+	auto textureFactory = graphics->GetTextureFactory();
+
 	//Animated Texture?
 	if( isAnimated && !animatedTextures.empty() )
 	{
@@ -115,7 +119,10 @@ void Material::Apply()
 
 		//Set texture frame
 		if( animationFrame >= 0 && animationFrame < (int)animatedTextures.size() )
+		{
+			textureFactory->MarkUsed( animatedTextures[animationFrame] );
 			device->SetTexture( 0, animatedTextures[animationFrame]->Get() );
+		}
 	}
 	else
 	{
@@ -125,13 +132,19 @@ void Material::Apply()
 
 			//Set Texture
 			if( (i < (int)textures.size()) && textures[i] )
+			{
+				textureFactory->MarkUsed( textures[i] );
 				device->SetTexture( i, textures[i]->Get() );
+			}
 		}
 
 		//Set Blending Material for Device
 		if( useBlendingMaterial && blendingMaterial )
 			if( !blendingMaterial->textures.empty() )
+			{
+				textureFactory->MarkUsed( blendingMaterial->textures[0] );
 				device->SetTexture( 2, blendingMaterial->textures[0]->Get() );
+			}
 	}
 
 	//Texture Blending
@@ -144,36 +157,40 @@ void Material::Apply()
 		device->SetRenderState( D3DRS_CULLMODE, D3DCULL_CW );
 }
 
-bool Material::Build( FILE* file, bool skinned, bool loadTextures, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+bool Material::Read( IO::BinaryReader& reader, bool loadTextures )
 {
-	if( file )
+	if( reader.IsGood() )
 	{
 		unsigned int texturesCount = 0;
 		unsigned int animTexturesCount = 0;
 
-		auto ReadBooleanFile = [=]( bool& out ) { BOOL b; fread( &b, sizeof( BOOL ), 1, file ); out = b; };
+		auto ReadBooleanFile = [&]( bool& out ) { BOOL b = FALSE; reader.Read( b ); out = b ? true : false; };
 
-		fread( &useCount, sizeof( DWORD ), 1, file );
-		fread( &texturesCount, sizeof( int ), 1, file );
-		fseek( file, 32, SEEK_CUR );
-		fread( &textureStageState, sizeof( type ) + offsetof( Material, type ) - offsetof( Material, textureStageState ), 1, file );
+		reader.Read( &useCount, sizeof( DWORD ) );
+		reader.Read( &texturesCount, sizeof( int ) );
+		reader.Skip( 32 );
+		reader.Read( &textureStageState, sizeof( type ) + offsetof( Material, type ) - offsetof( Material, textureStageState ) );
 		ReadBooleanFile( hasOpacityMap );
 		ReadBooleanFile( isAnimated );
-		fread( &blendType, sizeof( int ), 1, file );
+		reader.Read( &blendType, sizeof( int ) );
 		ReadBooleanFile( shading );
 		ReadBooleanFile( twoSided );
-		fread( &serialID, sizeof( selfIlluminationAmount ) + offsetof( Material, selfIlluminationAmount ) - offsetof( Material, serialID ), 1, file );
-		fseek( file, 12, SEEK_CUR );
-		fread( &colorTransform, sizeof( meshTransform ) + offsetof( Material, meshTransform ) - offsetof( Material, colorTransform ), 1, file );
-		fseek( file, 128, SEEK_CUR );
-		fread( &animTexturesCount, sizeof( int ), 1, file );
-		fread( &frameTotal, sizeof( animationFrame ) + offsetof( Material, animationFrame ) - offsetof( Material, frameTotal ), 1, file );
+		reader.Read( &serialID, sizeof( selfIlluminationAmount ) + offsetof( Material, selfIlluminationAmount ) - offsetof( Material, serialID ) );
+		reader.Skip( 12 );
+		reader.Read( &colorTransform, sizeof( meshTransform ) + offsetof( Material, meshTransform ) - offsetof( Material, colorTransform ) );
+		reader.Skip( 128 );
+		reader.Read( &animTexturesCount, sizeof( int ) );
+		reader.Read( &frameTotal, sizeof( animationFrame ) + offsetof( Material, animationFrame ) - offsetof( Material, frameTotal ) );
 
-		if( loadTextures == true )
-		{	
-			std::vector<std::string> attributeAnimationsFile;
-			std::vector<ShaderDefine> defines;
+		if( !reader.IsGood() )
+			return false;
 
+		texturesFile.clear();
+		animatedTexturesFile.clear();
+		texturesRead = loadTextures;
+
+		if( loadTextures == true )
+		{
 			//Fix Transparency
 			diffuseColor.a = 1.0f - diffuseColor.a;
 
@@ -186,123 +203,159 @@ bool Material::Build( FILE* file, bool skinned, bool loadTextures, bool useVerte
 					char materialName[4096] = { 0 };
 
 					//Read String Name and Length
-					fread( &stringLength, sizeof( int ), 1, file );
-					fread_s( materialName, sizeof( materialName ), stringLength, 1, file );
+					reader.Read( &stringLength, sizeof( int ) );
+
+					if( stringLength < 0 || (size_t)stringLength >= sizeof( materialName ) || !reader.Read( materialName, stringLength ) )
+						return false;
 
 					char* curMaterialName = materialName;
 
-					//Read Textures from Material
+					//Read Textures Names from Material
 					for( unsigned int j = 0; j < texturesCount; j++ )
 					{
-						//Blending Mode
-						if( textureStageState[j] == D3DTOP_ADD )
-							selfIllumBlendingMode = 1;
-
-						//Texture Name
 						char* name = curMaterialName;
 						curMaterialName += strlen( name ) + 1;
 						curMaterialName += strlen( curMaterialName ) + 1;
 
-						//Add Texture to Texture Handler
-						auto texture = graphics->GetTextureFactory()->Create( name, false, false, mipMapsDefault, temporaryTextures, use3D ? graphics->reduceQualityTexture : 0 );
-
-						if( texture )
-						{
-							if( j >= 0 && j < materialType.size() )
-								defines.push_back( ShaderDefine{ materialType[j].c_str(), "1" } );
-
-							textures.push_back( texture );
-						}
+						texturesFile.push_back( name );
 					}
 
-					//Read Animated Textures from Material
+					//Read Animated Textures Names from Material
 					for( unsigned int j = 0; j < animTexturesCount; j++ )
 					{
-						//Texture Name
 						char* name = curMaterialName;
 						curMaterialName += strlen( name ) + 1;
 						curMaterialName += strlen( curMaterialName ) + 1;
 
-						//Add Texture to Texture Handler
-						auto texture = graphics->GetTextureFactory()->Create( name, false, false, mipMapsDefault, temporaryTextures, use3D ? graphics->reduceQualityTexture : 0 );
-
-						if( texture )
-							animatedTextures.push_back( texture );
+						animatedTexturesFile.push_back( name );
 
 						isAnimated = true;
 					}
 				}
 			}
+		}
+		else
+		{
+			unsigned int offset = 0;
+			reader.Read( &offset, sizeof( int ) );
+			reader.Skip( offset );
+		}
 
-			//Texture Transform
-			for( int i = 0; i < _countof( textureTransform ); i++ )
-			{
-				//Ignore Texture Transform Reflex
-				if( textureTransform[i] == TextureTransform::Reflex )
-					continue;
-
-				if( textureTransform[i] == TextureTransform::Scrolling )
-					attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll1.xml" );
-				else if( textureTransform[i] == TextureTransform::Scrolling2x )
-					attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll2.xml" );
-				else if( textureTransform[i] == TextureTransform::Scrolling4x )
-					attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll4.xml" );
-				else if( textureTransform[i] >= TextureTransform::Scrolling )
-					attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll2.xml" );
-			}
+		return reader.IsGood();
+	}
 
-			//Water Material
-			if( meshTransform& MeshTransform::Water )
-				attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll1.xml" );
+	return false;
+}
 
-			//Load Attribute Animations File
-			for( auto file : attributeAnimationsFile )
-			{
-				int index = 0;
-				while( true )
-				{
-					auto animation = graphics->GetAttributeAnimationFactory()->Create( file, index );
+void Material::Create( bool skinned, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+{
+	if( texturesRead == false )
+		return;
 
-					if( animation )
-					{
-						if( animation->GetType() == Resource::AttributeAnimationType::ScrollUV )
-							defines.push_back( ShaderDefine{ "SCROLLUV", "1" } );
+	std::vector<std::string> attributeAnimationsFile;
+	std::vector<ShaderDefine> defines;
 
-						attributeAnimations.push_back( animation );
-					}
-					else
-						break;
+	//Add Textures to Texture Handler
+	for( size_t j = 0; j < texturesFile.size(); j++ )
+	{
+		//Blending Mode
+		if( j < _countof( textureStageState ) && textureStageState[j] == D3DTOP_ADD )
+			selfIllumBlendingMode = 1;
 
-					index++;
-				}
-			}
+		auto texture = graphics->GetTextureFactory()->CreateAsync( texturesFile[j], false, false, mipMapsDefault, temporaryTextures, use3D ? graphics->reduceQualityTexture : 0 );
 
-			//Prepare Effect Defines
-			if( skinned && !graphics->useSoftwareSkinning )
-				defines.push_back( ShaderDefine{ "SKINNED", "1" } );
+		if( texture )
+		{
+			if( j < materialType.size() )
+				defines.push_back( ShaderDefine{ materialType[j].c_str(), "1" } );
 
-			//Vertex Color Define
-			if( useVertexColor )
-				defines.push_back( ShaderDefine{ "VERTEXCOLOR", "1" } );
+			textures.push_back( texture );
+		}
+	}
 
-			//Supports Pixel Shader 3.0
-			if( graphics->pixelShaderVersionMajor == 3 )
-				defines.push_back( ShaderDefine{ "_PS_3_0", "1" } );
+	//Add Animated Textures to Texture Handler
+	for( const auto& animatedTextureFile : animatedTexturesFile )
+	{
+		auto texture = graphics->GetTextureFactory()->CreateAsync( animatedTextureFile, false, false, mipMapsDefault, temporaryTextures, use3D ? graphics->reduceQualityTexture : 0 );
 
-			//Create Effect
-			effect = graphics->GetShaderFactory()->Create( "game\\scripts\\shaders\\LitSolid.fx", defines );
-		}
-		else
+		if( texture )
+			animatedTextures.push_back( texture );
+	}
+
+	//Texture Transform
+	for( int i = 0; i < _countof( textureTransform ); i++ )
+	{
+		//Ignore Texture Transform Reflex
+		if( textureTransform[i] == TextureTransform::Reflex )
+			continue;
+
+		if( textureTransform[i] == TextureTransform::Scrolling )
+			attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll1.xml" );
+		else if( textureTransform[i] == TextureTransform::Scrolling2x )
+			attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll2.xml" );
+		else if( textureTransform[i] == TextureTransform::Scrolling4x )
+			attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll4.xml" );
+		else if( textureTransform[i] >= TextureTransform::Scrolling )
+			attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll2.xml" );
+	}
+
+	//Water Material
+	if( meshTransform& MeshTransform::Water )
+		attributeAnimationsFile.push_back( "game\\scripts\\animations\\scroll1.xml" );
+
+	//Load Attribute Animations File
+	for( auto file : attributeAnimationsFile )
+	{
+		for( const auto& animation : graphics->GetAttributeAnimationFactory()->CreateAll( file ) )
 		{
-			unsigned int offset = 0;
-			fread( &offset, sizeof( int ), 1, file );
-			fseek( file, offset, SEEK_CUR );
-		}
+			if( animation->GetType() == Resource::AttributeAnimationType::ScrollUV )
+				defines.push_back( ShaderDefine{ "SCROLLUV", "1" } );
 
-		return true;
+			attributeAnimations.push_back( animation );
+		}
 	}
 
-	return false;
+	//Prepare Effect Defines
+	if( skinned && !graphics->useSoftwareSkinning )
+		defines.push_back( ShaderDefine{ "SKINNED", "1" } );
+
+	//Vertex Color Define
+	if( useVertexColor )
+		defines.push_back( ShaderDefine{ "VERTEXCOLOR", "1" } );
+
+	//Supports Pixel Shader 3.0
+	if( graphics->pixelShaderVersionMajor == 3 )
+		defines.push_back( ShaderDefine{ "_PS_3_0", "1" } );
+
+	//Create Effect
+	effect = graphics->GetShaderFactory()->Create( "game\\scripts\\shaders\\LitSolid.fx", defines );
+}
+
+void Material::Release()
+{
+	//Textures used only by this Material leave Texture Cache
+	auto textureFactory = graphics->GetTextureFactory();
+
+	for( auto& texture : textures )
+		textureFactory->Release( texture );
+
+	for( auto& texture : animatedTextures )
+		textureFactory->Release( texture );
+
+	textures.clear();
+	animatedTextures.clear();
+	attributeAnimations.clear();
+	effect = nullptr;
+}
+
+bool Material::Build( IO::BinaryReader& reader, bool skinned, bool loadTextures, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+{
+	if( !Read( reader, loadTextures ) )
+		return false;
+
+	Create( skinned, useVertexColor, mipMapsDefault, temporaryTextures, use3D );
+
+	return true;
 }
 
 bool Material::Load( const std::string& filePath, bool defaultSettings, bool use3D )
@@ -323,8 +376,13 @@ bool Material::Load( const std::string& filePath, bool defaultSettings, bool use
 		blendType = StateBlock::Blend_None;
 	}
 
+	IO::FileView file;
+
+	if( !IO::FileSystem::Get()->Open( filePath, file ) )
+		return false;
+
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file( filePath.c_str() );
+	pugi::xml_parse_result result = doc.load_buffer( file.Data(), file.Size() );
 
 	if( !result )
 		return false;
@@ -395,22 +453,12 @@ bool Material::Load( const std::string& filePath, bool defaultSettings, bool use
 
 		if( !animationFilePath.empty() )
 		{
-			int index = 0;
-			while( true )
+			for( const auto& animation : graphics->GetAttributeAnimationFactory()->CreateAll( animationFilePath ) )
 			{
-				auto animation = graphics->GetAttributeAnimationFactory()->Create( animationFilePath, index );
-
-				if( animation )
-				{
-					if( animation->GetType() == Resource::AttributeAnimationType::ScrollUV )
-						definesString.push_back( "SCROLLUV" );
-
-					attributeAnimations.push_back( animation );
-				}
-				else
-					break;
+				if( animation->GetType() == Resource::AttributeAnimationType::ScrollUV )
+					definesString.push_back( "SCROLLUV" );
 
-				index++;
+				attributeAnimations.push_back( animation );
 			}
 		}
 	}
@@ -6,6 +6,7 @@
 
 #include "../Math/Vector3.h"
 #include "../Resource/AttributeAnimation.h"
+#include "../IO/BinaryReader.h"
 
 namespace Delta3D::Graphics
 {
@@ -55,7 +56,8 @@ public:
 		frameSpeed( 0 ), 
 		colorTransform( 0 ), 
 		blendType( StateBlock::None ),
-		animationFrame( 0 )
+		animationFrame( 0 ),
+		texturesRead( false )
 	{
 	}
 
@@ -71,8 +73,17 @@ public:
 	//! Apply Material to Device.
 	void Apply();
 
-	//! Build Material.
-	bool Build( FILE* file, bool skinned, bool loadTextures = true, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+	//! Read Material from SMD Material Data (no GPU resources are created, safe on worker threads).
+	bool Read( IO::BinaryReader& reader, bool loadTextures = true );
+
+	//! Create Textures, Attribute Animations and Effect of Material read from SMD Material Data.
+	void Create( bool skinned, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+
+	//! Release Textures (cached ones nothing else uses are dropped), Attribute Animations and Effect (Create can be called again).
+	void Release();
+
+	//! Build Material from SMD Material Data.
+	bool Build( IO::BinaryReader& reader, bool skinned, bool loadTextures = true, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
 
 	//! Load Material from XML File.
 	bool Load( const std::string& filePath, bool defaultSettings = false, bool use3D = false );
@@ -125,5 +136,9 @@ public:
 	std::shared_ptr<Shader> effect;
 
 	bool customMaterial;
+
+	std::vector<std::string> texturesFile;	//!< Textures Files read from SMD Material Data
+	std::vector<std::string> animatedTexturesFile;	//!< Animated Textures Files read from SMD Material Data
+	bool texturesRead;	//!< Flag to determinate if Textures Files was read (Create will load them)
 };
 }
\ No newline at end of file
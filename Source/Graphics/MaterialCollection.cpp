@@ -4,6 +4,8 @@
 #include "Material.h"
 #include "Texture.h"
 
+#include "../IO/FileSystem.h"
+
 namespace Delta3D::Graphics
 {
 MaterialCollection::MaterialCollection() : 
@@ -144,52 +146,92 @@ void MaterialCollection::SetBlendingMaterial( Material* material, bool useBlendi
 			materials[i].SetBlendingMaterial( material, useBlendingMap );
 }
 
-bool MaterialCollection::Build( FILE* file, bool skinned, bool loadTextures, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+bool MaterialCollection::Read( IO::BinaryReader& reader, bool loadTextures )
 {
-	if( file )
-	{
-		fread( &header, sizeof( materialType ) + offsetof( MaterialCollection, materialType ) - offsetof( MaterialCollection, header ), 1, file );
-		fseek( file, 72, SEEK_CUR );
+	reader.Read( &header, sizeof( DWORD ) );
+	reader.Skip( 4 );
+	reader.Read( &materialsCount, sizeof( int ) );
+	reader.Read( &materialType, sizeof( int ) );
+	reader.Skip( 72 );
+
+	if( !reader.IsGood() || materialsCount < 0 )
+		return false;
 
-		//Allocate Materials
-		materials = new Material[materialsCount];
+	//Allocate Materials
+	materials = new Material[materialsCount];
 
-		//Read Each Material
+	//Read Each Material
+	for( int i = 0; i < materialsCount; i++ )
+		if( !materials[i].Read( reader, loadTextures ) )
+			return false;
+
+	return true;
+}
+
+void MaterialCollection::Create( bool skinned, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+{
+	if( materials )
 		for( int i = 0; i < materialsCount; i++ )
-			materials[i].Build( file, skinned, loadTextures, useVertexColor, mipMapsDefault, temporaryTextures, use3D );
+			materials[i].Create( skinned, useVertexColor, mipMapsDefault, temporaryTextures, use3D );
+}
 
-		return true;
-	}
+void MaterialCollection::CreateMaterialResources( int materialID, bool skinned, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+{
+	if( materials == nullptr || materialID < 0 || materialID >= materialsCount )
+		return;
 
-	return false;
+	materials[materialID].Create( skinned, useVertexColor, mipMapsDefault, temporaryTextures, use3D );
+
+	if( materialID < (int)materialsFile.size() && !materialsFile[materialID].empty() )
+		materials[materialID].Load( materialsFile[materialID], use3D );
 }
 
-bool MaterialCollection::Load( const std::string& filePath, bool use3D )
+void MaterialCollection::ReleaseMaterialResources( int materialID )
+{
+	if( materials == nullptr || materialID < 0 || materialID >= materialsCount )
+		return;
+
+	materials[materialID].Release();
+}
+
+bool MaterialCollection::Build( IO::BinaryReader& reader, bool skinned, bool loadTextures, bool useVertexColor, unsigned int mipMapsDefault, bool temporaryTextures, bool use3D )
+{
+	bool result = Read( reader, loadTextures );
+
+	//Materials read before a failure are still used
+	Create( skinned, useVertexColor, mipMapsDefault, temporaryTextures, use3D );
+
+	return result;
+}
+
+bool MaterialCollection::ReadList( const std::string& filePath )
 {
 	filesystem::path p( filePath );
 
+	materialsFile.clear();
+
 	if( p.has_filename() )
 	{
-		std::ifstream file( filePath );
+		IO::FileView file;
 
-		if( file.is_open() )
+		if( IO::FileSystem::Get()->Open( filePath, file ) )
 		{
+			std::istringstream stream( std::string( (const char*)file.Data(), file.Size() ) );
 			std::string line;
-			unsigned int materialID = 0;
 
-			while( std::getline( file, line ) )
+			while( std::getline( stream, line ) )
 			{
-				//Check if this material exists on XML Format
-				if( filesystem::exists( line ) && filesystem::is_regular_file( line ) )
-					if( line.find( "NoTexture") == std::string::npos )
-						if( materials )
-							materials[materialID].Load( line, use3D );
+				//Read in binary mode
+				if( !line.empty() && line.back() == '\r' )
+					line.pop_back();
 
-				materialID++;
+				//Check if this material exists on XML Format
+				if( line.find( "NoTexture") == std::string::npos && IO::FileSystem::Get()->Exists( line ) )
+					materialsFile.push_back( line );
+				else
+					materialsFile.push_back( std::string() );
 			}
 
-			file.close();
-
 			return true;
 		}
 	}
@@ -197,4 +239,17 @@ bool MaterialCollection::Load( const std::string& filePath, bool use3D )
 	return false;
 }
 
+bool MaterialCollection::Load( const std::string& filePath, bool use3D )
+{
+	if( !ReadList( filePath ) )
+		return false;
+
+	if( materials )
+		for( size_t i = 0; i < materialsFile.size() && i < (size_t)materialsCount; i++ )
+			if( !materialsFile[i].empty() )
+				materials[i].Load( materialsFile[i], use3D );
+
+	return true;
+}
+
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "Graphics.h"
 
+#include "../IO/BinaryReader.h"
+
 namespace Delta3D::Graphics
 {
 class Material;
@@ -65,8 +67,26 @@ public:
 	//! Set Blending Material.
 	void SetBlendingMaterial( Material* material, bool useBlendingMap = false );
 
-	//! Build Material Collection.
-	bool Build( FILE* file, bool skinned = false, bool loadTextures = true, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+	//! Read Material Collection from SMD Material Data (no GPU resources are created, safe on worker threads).
+	bool Read( IO::BinaryReader& reader, bool loadTextures = true );
+
+	//! Create GPU resources of Materials read from SMD Material Data.
+	void Create( bool skinned = false, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+
+	/**
+	 * Create GPU resources of a single Material (Material List read by ReadList is applied too)
+	 * @param materialID Material ID
+	 */
+	void CreateMaterialResources( int materialID, bool skinned = false, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+
+	//! Release GPU resources of a single Material.
+	void ReleaseMaterialResources( int materialID );
+
+	//! Build Material Collection from SMD Material Data.
+	bool Build( IO::BinaryReader& reader, bool skinned = false, bool loadTextures = true, bool useVertexColor = false, unsigned int mipMapsDefault = 0, bool temporaryTextures = false, bool use3D = false );
+
+	//! Read Material List (XML File per Material ID), no GPU resources are created.
+	bool ReadList( const std::string& filePath );
 
 	//! Load Material List.
 	bool Load( const std::string& filePath, bool use3D = false );
@@ -77,5 +97,6 @@ public:
 	int materialType;	//!< Material Type
 
 	std::string name;	//!< Material Collection Name
+	std::vector<std::string> materialsFile;	//!< XML File per Material ID read from Material List (empty if none)
 };
 }
\ No newline at end of file
@@ -16,16 +16,15 @@ namespace Delta3D::Graphics
 Mesh::Mesh() : 
 	GraphicsImpl(), 
 	modelParent( nullptr ), 
+	sourceMesh( nullptr ), 
 	parent( nullptr ), 
 	faces( nullptr ), 
 	vertices( nullptr ), 
 	texturesCoord( nullptr ), 
-	frameRotation( nullptr ),
-	framePosition( nullptr ), 
-	frameScaling( nullptr ), 
 	frameRotationCount( 0 ), 
 	framePositionCount( 0 ), 
 	frameScalingCount( 0 ),
+	boneInfluencesBones( 0 ),
 	postRender( false ),
 	loaded( false )
 {
@@ -34,19 +33,18 @@ Mesh::Mesh() :
 Mesh::Mesh( int verticesCount_, int facesCount_ ) : 
 	GraphicsImpl(), 
 	modelParent( nullptr ), 
+	sourceMesh( nullptr ), 
 	parent( nullptr ), 
 	faces( nullptr ), 
 	vertices( nullptr ), 
 	texturesCoord( nullptr ),	
-	frameRotation( nullptr ), 
-	framePosition( nullptr ),
-	frameScaling( nullptr ), 
 	frameRotationCount( 0 ),
 	framePositionCount( 0 ),
 	frameScalingCount( 0 ),
 	verticesCount( 0 ),
 	facesCount( 0 ),
 	texturesCount( 0 ),
+	boneInfluencesBones( 0 ),
 	postRender( false ),
 	loaded( false )
 {
@@ -55,26 +53,98 @@ Mesh::Mesh( int verticesCount_, int facesCount_ ) :
 	texturesCoord = new IO::SMD::TextureLink[facesCount_* 2];
 }
 
+Mesh::Mesh( const Mesh* sourceMesh_, Model* modelParent_ ) : 
+	GraphicsImpl(), 
+	header( sourceMesh_->header ), 
+	vertices( sourceMesh_->vertices ), 
+	faces( sourceMesh_->faces ), 
+	texturesCoord( sourceMesh_->texturesCoord ), 
+	boundingBox( sourceMesh_->boundingBox ), 
+	worldBoundingBox( sourceMesh_->worldBoundingBox ), 
+	boundingSphere( sourceMesh_->boundingSphere ), 
+	verticesCount( sourceMesh_->verticesCount ), 
+	facesCount( sourceMesh_->facesCount ), 
+	texturesCount( sourceMesh_->texturesCount ), 
+	position( sourceMesh_->position ), 
+	rotation( sourceMesh_->rotation ), 
+	translation( sourceMesh_->translation ), 
+	parent( nullptr ), 
+	baseFrame( sourceMesh_->baseFrame ), 
+	baseFrameInverse( sourceMesh_->baseFrameInverse ), 
+	resultAnimation( sourceMesh_->resultAnimation ), 
+	baseRotation( sourceMesh_->baseRotation ), 
+	world( sourceMesh_->world ), 
+	local( sourceMesh_->local ), 
+	lastFrame( sourceMesh_->lastFrame ), 
+	basePosition( sourceMesh_->basePosition ), 
+	frameRotationCount( sourceMesh_->frameRotationCount ), 
+	framePositionCount( sourceMesh_->framePositionCount ), 
+	frameScalingCount( sourceMesh_->frameScalingCount ), 
+	framesInfoCount( sourceMesh_->framesInfoCount ), 
+	vertexPositionBuffer( sourceMesh_->vertexPositionBuffer ), 
+	vertexNormalBuffer( sourceMesh_->vertexNormalBuffer ), 
+	vertexColorBuffer( sourceMesh_->vertexColorBuffer ), 
+	vertexBlendIndicesBuffer( sourceMesh_->vertexBlendIndicesBuffer ), 
+	textureCoordsBuffer( sourceMesh_->textureCoordsBuffer ), 
+	boneInfluencesBones( 0 ), 
+	meshParts( sourceMesh_->meshParts ), 
+	modelParent( modelParent_ ), 
+	sourceMesh( sourceMesh_->GetSourceMesh() ), 
+	postRender( sourceMesh_->postRender ), 
+	loaded( sourceMesh_->loaded )
+{
+	memcpy( name, sourceMesh_->name, sizeof( name ) );
+	memcpy( parentName, sourceMesh_->parentName, sizeof( parentName ) );
+	memcpy( framesInfoRotation, sourceMesh_->framesInfoRotation, sizeof( framesInfoRotation ) );
+	memcpy( framesInfoPosition, sourceMesh_->framesInfoPosition, sizeof( framesInfoPosition ) );
+	memcpy( framesInfoScaling, sourceMesh_->framesInfoScaling, sizeof( framesInfoScaling ) );
+}
+
 Mesh::~Mesh()
 {
 	auto DeleteArrayPointer = []( auto* p ) { delete[]p; p = nullptr; };
 
-	DeleteArrayPointer( frameScaling );
-	DeleteArrayPointer( framePosition );
-	DeleteArrayPointer( frameRotation );
-	DeleteArrayPointer( previousRotation );
-	DeleteArrayPointer( texturesCoord );
-	DeleteArrayPointer( faces );
-	DeleteArrayPointer( vertices );
+	//Instance doesn't own Asset data
+	if( sourceMesh == nullptr )
+	{
+		DeleteArrayPointer( texturesCoord );
+		DeleteArrayPointer( faces );
+		DeleteArrayPointer( vertices );
+
+		for( auto& p : meshParts )
+		{
+			delete p.second;
+			p.second = nullptr;
+		}
+	}
+
+	meshParts.clear();
+	textureCoordsBuffer.clear();
+}
 
-	for( auto& p : meshParts )
+void Mesh::ReleaseBuffers()
+{
+	if( sourceMesh == nullptr )
 	{
-		delete p.second;
-		p.second = nullptr;
+		for( auto& p : meshParts )
+		{
+			delete p.second;
+			p.second = nullptr;
+		}
 	}
 
 	meshParts.clear();
+
+	vertexPositionBuffer = nullptr;
+	vertexNormalBuffer = nullptr;
+	vertexColorBuffer = nullptr;
+	vertexBlendIndicesBuffer = nullptr;
 	textureCoordsBuffer.clear();
+
+	skinnedVerticesIndex.clear();
+	skinnedVertices.clear();
+
+	loaded = false;
 }
 
 int Mesh::AddVertex( int x, int y, int z )
@@ -156,189 +226,313 @@ int Mesh::AddTextureCoord( int faceIndex, Math::Vector2 texA, Math::Vector2 texB
 	return texturesCount - 1;
 }
 
-void Mesh::ApplyRotationTransform( Math::Matrix4& out, Math::Matrix4* previousRotation_, IO::SMD::KeyRotation* frameRotation_, int frame_, IO::SMD::FrameInfo* frameInfo )
+bool Mesh::SampleRotation( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Quaternion& out, const Math::Matrix4*& previousMatrix )
 {
-	if( frameRotation_[0].frame > frame_ )
-		return;
+	previousMatrix = nullptr;
 
-	int i = 0;
-	int previousFrame, currentFrame;
-	while( true )
-	{
-		previousFrame = frameRotation_[i].frame;
-		currentFrame = frameRotation_[i + 1].frame;
+	int i = track.Find( firstKey, frame_, cursor );
 
-		if( previousFrame <= frame_ && currentFrame > frame_ )
-			break;
+	if( i < 0 )
+		return false;
 
-		i++;
-	}
+	int previousFrame = track.GetFrame( i );
+	int currentFrame = track.GetFrame( i + 1 );
 
 	int frameDiff = currentFrame - previousFrame;
 	int frameDelta = frame_ - previousFrame;
 
 	float alpha = (float)frameDelta / (float)frameDiff;
 
-	if( frameInfo && currentFrame > (int)frameInfo->endFrame )
-		out = previousRotation_[i];
+	//Scaled or mirrored Accumulated Rotation is applied as Matrix (GetLocalTransform)
+	if( track.HasPreviousMatrices() )
+	{
+		previousMatrix = &track.GetPreviousMatrix( i );
+		out = Math::Quaternion().Slerp( track.GetRotation( i + 1 ), alpha );
+	}
+	else
+		out = track.GetPreviousRotation( i )* Math::Quaternion().Slerp( track.GetRotation( i + 1 ), alpha );
 
-	out = Math::Quaternion().Slerp( Math::Quaternion( frameRotation_[i + 1].x, frameRotation_[i + 1].y, frameRotation_[i + 1].z, frameRotation_[i + 1].w ), alpha ).ToMatrix();
-	out = previousRotation_[i]* out;
+	return true;
 }
 
-void Mesh::ApplyScalingTransform( Math::Matrix4& out, IO::SMD::KeyScale* frameScaling_, int frame_ )
+bool Mesh::SampleScaling( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Vector3& out )
 {
-	if( frameScaling[0].frame > frame_ )
-		return;
+	int i = track.Find( firstKey, frame_, cursor );
 
-	int i = 0;
-	int previousFrame, currentFrame;
-	while( true )
-	{
-		previousFrame = frameScaling[i].frame;
-		currentFrame = frameScaling[i + 1].frame;
+	if( i < 0 )
+		return false;
 
-		if( previousFrame <= frame_ && currentFrame > frame_ )
-			break;
-
-		i++;
-	}
+	int previousFrame = track.GetFrame( i );
+	int currentFrame = track.GetFrame( i + 1 );
 
 	int frameDiff = currentFrame - previousFrame;
 	int frameDelta = frame_ - previousFrame;
 
 	float alpha = (float)frameDelta / (float)frameDiff;
 
-	out._11 = (frameScaling[i].x / 256.0f) + ( ( (frameScaling[i + 1].x / 256.0f) - (frameScaling[i].x / 256.0f) )* alpha );
-	out._22 = (frameScaling[i].y / 256.0f) + ( ( (frameScaling[i + 1].y / 256.0f) - (frameScaling[i].y / 256.0f) )* alpha );
-	out._33 = (frameScaling[i].z / 256.0f) + ( ( (frameScaling[i + 1].z / 256.0f) - (frameScaling[i].z / 256.0f) )* alpha );
+	//Scaling Keyframes are fixed point (256 = 1.0)
+	Math::Vector3 previousScaling = track.GetVector( i ) / 256.0f;
+	Math::Vector3 currentScaling = track.GetVector( i + 1 ) / 256.0f;
+
+	out = previousScaling + ( ( currentScaling - previousScaling )* alpha );
+	return true;
 }
 
-void Mesh::ApplyTranslationTransform( Math::Matrix4& out, IO::SMD::KeyPosition* framePosition_, int frame_ )
+bool Mesh::SampleTranslation( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Vector3& out )
 {
-	if( framePosition_[0].frame > frame_ )
-		return;
-
-	int i = 0;
-	int previousFrame, currentFrame;
-	while( true )
-	{
-		previousFrame = framePosition_[i].frame;
-		currentFrame = framePosition_[i + 1].frame;
+	int i = track.Find( firstKey, frame_, cursor );
 
-		if( previousFrame <= frame_ && currentFrame > frame_ )
-			break;
+	if( i < 0 )
+		return false;
 
-		i++;
-	}
+	int previousFrame = track.GetFrame( i );
+	int currentFrame = track.GetFrame( i + 1 );
 
 	int frameDiff = currentFrame - previousFrame;
 	int frameDelta = frame_ - previousFrame;
 
 	float alpha = (float)frameDelta / (float)frameDiff;
 
-	out._41 = framePosition_[i].x + ( ( framePosition_[i + 1].x - framePosition_[i].x )* alpha );
-	out._42 = framePosition_[i].y + ( ( framePosition_[i + 1].y - framePosition_[i].y )* alpha );
-	out._43 = framePosition_[i].z + ( ( framePosition_[i + 1].z - framePosition_[i].z )* alpha );
+	Math::Vector3 previousPosition = track.GetVector( i );
+	Math::Vector3 currentPosition = track.GetVector( i + 1 );
+
+	out = previousPosition + ( ( currentPosition - previousPosition )* alpha );
+	return true;
 }
 
-int Mesh::FindAnimationPosition( int frame )
+const AnimationRange* Mesh::FindAnimationRange( int frame ) const
 {
-	if( framesInfoCount > 0 )
-	{
-		for( int i = 0; i < framesInfoCount; i++ )
-		{
-			if( i > _countof( framesInfoPosition ) )
-				break;
+	const auto& ranges = GetSourceMesh()->animationRanges;
 
-			if( framesInfoPosition[i].keyFrameCount > 0 && framesInfoPosition[i].startFrame <= frame && framesInfoPosition[i].endFrame > frame )
-				return framesInfoPosition[i].keyFrameStartIndex;
-		}
-	}
+	//Last Range closes the previous one and has no Motion
+	auto it = std::upper_bound( ranges.begin(), ranges.end(), frame, []( int value, const AnimationRange& range ) { return value < range.startFrame; } );
+
+	if( it == ranges.begin() )
+		return nullptr;
+
+	return &(*(it - 1));
+}
+
+int Mesh::FindAnimationPosition( int frame )
+{
+	const AnimationRange* range = FindAnimationRange( frame );
 
-	return -1;
+	return range ? range->positionIndex : -1;
 }
 
 int Mesh::FindAnimationRotation( int frame )
 {
-	if( framesInfoCount > 0 )
+	const AnimationRange* range = FindAnimationRange( frame );
+
+	return range ? range->rotationIndex : -1;
+}
+
+int Mesh::FindAnimationScaling( int frame )
+{
+	const AnimationRange* range = FindAnimationRange( frame );
+
+	return range ? range->scalingIndex : -1;
+}
+
+bool Mesh::SampleTransform( int frame_, IO::SMD::KeyCursor& cursor, BoneTransform& out ) const
+{
+	int rotationIndex = 0, scalingIndex = 0, positionIndex = 0;
+
+	//Active Motion of each Track
+	if( framesInfoCount )
 	{
-		for( int i = 0; i < framesInfoCount; i++ )
-		{
-			if( i > _countof( framesInfoRotation ) )
-				break;
+		const AnimationRange* range = FindAnimationRange( frame_ );
 
-			if( framesInfoRotation[i].keyFrameCount > 0 && framesInfoRotation[i].startFrame <= frame && framesInfoRotation[i].endFrame > frame )
-				return framesInfoRotation[i].keyFrameStartIndex;
-		}
+		rotationIndex = range ? range->rotationIndex : -1;
+		scalingIndex = range ? range->scalingIndex : -1;
+		positionIndex = range ? range->positionIndex : -1;
+	}
+
+	//Animation was found?
+	if( (!framesInfoCount && (frameRotationCount > 0 || framePositionCount > 0 || frameScalingCount > 0)) || (framesInfoCount && (rotationIndex >= 0 || positionIndex >= 0 || scalingIndex > 0) ) )
+	{
+		const Mesh* source = GetSourceMesh();
+
+		bool hasRotationAnimation = frameRotationCount > 0  && (framesInfoCount ? rotationIndex >= 0 : source->rotationTrack.GetFrame( frameRotationCount - 1 ) > frame_);
+		bool hasScalingAnimation = frameScalingCount > 0  && (framesInfoCount ? scalingIndex >= 0 : source->scalingTrack.GetFrame( frameScalingCount - 1 ) > frame_);
+		bool hasPositionAnimation = framePositionCount > 0 && (framesInfoCount ? positionIndex >= 0 : source->positionTrack.GetFrame( framePositionCount - 1 ) > frame_);
+
+		//Rotation (Base Rotation otherwise)
+		out.rotation = Math::Quaternion::Identity;
+		out.previousRotation = nullptr;
+		out.rotationAnimated = hasRotationAnimation;
+
+		if( hasRotationAnimation )
+			SampleRotation( source->rotationTrack, rotationIndex, frame_, cursor.rotation, out.rotation, out.previousRotation );
+
+		//Scaling
+		out.scaling = Math::Vector3( 1.0f, 1.0f, 1.0f );
+		out.scalingAnimated = hasScalingAnimation;
+
+		if( hasScalingAnimation )
+			SampleScaling( source->scalingTrack, scalingIndex, frame_, cursor.scaling, out.scaling );
+
+		//Position
+		out.translation = Math::Vector3( float( basePosition.x ) / 256.0f, float( basePosition.y ) / 256.0f, float( basePosition.z ) / 256.0f );
+
+		if( hasPositionAnimation )
+			SampleTranslation( source->positionTrack, positionIndex, frame_, cursor.position, out.translation );
+
+		return true;
 	}
 
-	return -1;
+	return false;
 }
 
-int Mesh::FindAnimationScaling( int frame )
+Math::Matrix4 Mesh::GetLocalTransform( const BoneTransform& transform ) const
 {
-	if( framesInfoCount > 0 )
+	Math::Matrix4 result = transform.rotationAnimated ? transform.rotation.ToMatrix() : baseRotation;
+
+	if( transform.rotationAnimated && transform.previousRotation )
+		result = *transform.previousRotation* result;
+
+	if( transform.scalingAnimated )
 	{
-		for( int i = 0; i < framesInfoCount; i++ )
-		{
-			if( i > _countof( framesInfoScaling ) )
-				break;
+		Math::Matrix4 scaling = Math::Matrix4::Identity;
+		scaling.Scale( transform.scaling );
 
-			if( framesInfoScaling[i].keyFrameCount > 0 && framesInfoScaling[i].startFrame <= frame && framesInfoScaling[i].endFrame > frame )
-				return framesInfoScaling[i].keyFrameStartIndex;
-		}
+		result = result* scaling;
 	}
 
-	return -1;
+	result._41 = transform.translation.x;
+	result._42 = transform.translation.y;
+	result._43 = transform.translation.z;
+
+	return result;
+}
+
+Math::Matrix4 Mesh::GetBaseTransform() const
+{
+	if( parent )
+		return baseFrame* parent->baseFrameInverse;
+
+	return baseFrame;
 }
 
 void Mesh::Animate( int frame_, Math::Vector3Int rotation_, IO::SMD::FrameInfo* frameInfo )
 {
-	auto PTDegreeToRadians = []( const int deg ) { return (float)deg* D3DX_PI / 2048.0f; };
+	BoneTransform transform;
 
-	int rotationIndex = framesInfoCount ? FindAnimationRotation( frame_ ) : 0;
-	int scalingIndex = framesInfoCount ? FindAnimationScaling( frame_ ) : 0;
-	int positionIndex = framesInfoCount ? FindAnimationPosition( frame_ ) : 0;
+	if( SampleTransform( frame_, keyCursors[0], transform ) )
+		UpdateWorld( GetLocalTransform( transform ), rotation_ );
+	else
+		UpdateWorld( GetBaseTransform(), rotation_ );
+}
 
-	Math::Matrix4 result = Math::Matrix4::Identity;
+void Mesh::AnimateBlend( const AnimationLayer* layers, int layersCount, Math::Vector3Int rotation_ )
+{
+	BoneTransform transforms[maxAnimationLayers];
+	bool animated[maxAnimationLayers];
+	bool anyAnimated = false;
 
-	//Animation was found?
-	if( (!framesInfoCount && (frameRotationCount > 0 || framePositionCount > 0 || frameScalingCount > 0)) || (framesInfoCount && (rotationIndex >= 0 || positionIndex >= 0 || scalingIndex > 0) ) )
+	layersCount = std::min( layersCount, maxAnimationLayers );
+
+	//Each Layer samples with your own Cursor, so forward playback of every Layer stays cheap
+	for( int i = 0; i < layersCount; i++ )
 	{
-		bool hasRotationAnimation = frameRotationCount > 0  && (framesInfoCount ? rotationIndex >= 0 : frameRotation[frameRotationCount - 1].frame > frame_);
-		bool hasScalingAnimation = frameScalingCount > 0  && (framesInfoCount ? scalingIndex >= 0 : frameScaling[frameScalingCount - 1].frame > frame_);
-		bool hasPositionAnimation = framePositionCount > 0 && (framesInfoCount ? positionIndex >= 0 : framePosition[framePositionCount - 1].frame > frame_);
+		animated[i] = layers[i].weight > 0.0f && SampleTransform( layers[i].frame, keyCursors[i], transforms[i] );
+		anyAnimated |= animated[i];
+	}
 
-		//Rotation
-		if( hasRotationAnimation )
-			ApplyRotationTransform( result, &previousRotation[rotationIndex], &frameRotation[rotationIndex], frame_, frameInfo );
-		else
-			result = baseRotation;
+	if( !anyAnimated )
+	{
+		UpdateWorld( GetBaseTransform(), rotation_ );
+		return;
+	}
 
-		//Scaling
-		if( hasScalingAnimation )
+	//Scaled or mirrored Accumulated Rotations aren't held by quaternions, so local Matrices are blended
+	bool blendMatrices = false;
+
+	for( int i = 0; i < layersCount; i++ )
+		if( animated[i] && transforms[i].rotationAnimated && transforms[i].previousRotation )
+			blendMatrices = true;
+
+	if( blendMatrices )
+	{
+		float blended[4][4] = {};
+		float weightSum = 0.0f;
+
+		for( int i = 0; i < layersCount; i++ )
 		{
-			Math::Matrix4 scaling = Math::Matrix4::Identity;
-			ApplyScalingTransform( scaling, &frameScaling[scalingIndex], frame_ );
+			float weight = layers[i].weight;
 
-			result = result* scaling;
+			if( weight <= 0.0f )
+				continue;
+
+			Math::Matrix4 local = animated[i] ? GetLocalTransform( transforms[i] ) : GetBaseTransform();
+
+			for( int j = 0; j < 4; j++ )
+				for( int k = 0; k < 4; k++ )
+					blended[j][k] += local.m[j][k]* weight;
+
+			weightSum += weight;
 		}
 
-		//Position
-		if( hasPositionAnimation )
-			ApplyTranslationTransform( result, &framePosition[positionIndex], frame_ );
-		else
+		Math::Matrix4 result;
+
+		for( int j = 0; j < 4; j++ )
+			for( int k = 0; k < 4; k++ )
+				result.m[j][k] = blended[j][k] / weightSum;
+
+		UpdateWorld( result, rotation_ );
+		return;
+	}
+
+	Math::Quaternion rotationSum( 0.0f, 0.0f, 0.0f, 0.0f );
+	Math::Vector3 scalingSum( 0.0f, 0.0f, 0.0f );
+	Math::Vector3 translationSum( 0.0f, 0.0f, 0.0f );
+	float weightSum = 0.0f;
+
+	for( int i = 0; i < layersCount; i++ )
+	{
+		float weight = layers[i].weight;
+
+		if( weight <= 0.0f )
+			continue;
+
+		BoneTransform& transform = transforms[i];
+
+		//Tracks not animated on Layer are blended from Base Transform
+		if( !animated[i] )
 		{
-			result._41 = float( basePosition.x ) / 256.0f;
-			result._42 = float( basePosition.y ) / 256.0f;
-			result._43 = float( basePosition.z ) / 256.0f;
+			Math::Matrix4 base = GetBaseTransform();
+
+			transform.rotation.FromRotationMatrix( base );
+			transform.scaling = Math::Vector3( 1.0f, 1.0f, 1.0f );
+			transform.translation = Math::Vector3( base._41, base._42, base._43 );
 		}
+		else if( !transform.rotationAnimated )
+			transform.rotation.FromRotationMatrix( baseRotation );
+
+		//Shortest path
+		if( weightSum > 0.0f && rotationSum.DotProduct( transform.rotation ) < 0.0f )
+			transform.rotation = -transform.rotation;
+
+		rotationSum = rotationSum + transform.rotation* weight;
+		scalingSum = scalingSum + transform.scaling* weight;
+		translationSum = translationSum + transform.translation* weight;
+		weightSum += weight;
 	}
-	else if( parent )
-		result = baseFrame* parent->baseFrameInverse;
-	else
-		result = baseFrame;
+
+	BoneTransform blended;
+	blended.rotation = rotationSum.Normalized();
+	blended.previousRotation = nullptr;
+	blended.rotationAnimated = true;
+	blended.scaling = scalingSum / weightSum;
+	blended.scalingAnimated = true;
+	blended.translation = translationSum / weightSum;
+
+	UpdateWorld( GetLocalTransform( blended ), rotation_ );
+}
+
+void Mesh::UpdateWorld( const Math::Matrix4& result, Math::Vector3Int rotation_ )
+{
+	auto PTDegreeToRadians = []( const int deg ) { return (float)deg* D3DX_PI / 2048.0f; };
 
 	//Multiply by Parent Animation Matrix
 	if( parent )
@@ -346,17 +540,12 @@ void Mesh::Animate( int frame_, Math::Vector3Int rotation_, IO::SMD::FrameInfo*
 	else
 		memcpy( &resultAnimation, &result, sizeof( Math::Matrix4 ) );
 
-	//Scaling Matrix
-	static Math::Matrix4 scaling;
-	static bool scaleModel = false;
+	//Scaling Matrix (Meshes of different Models are animated by Animator workers at same time)
+	Math::Matrix4 scaling;
+	bool scaleModel = modelParent->scaling != Math::Vector3( 1.0f, 1.0f, 1.0f );
 
-	if( modelParent->scaling != Math::Vector3( 1.0f, 1.0f, 1.0f ) )
-	{
+	if( scaleModel )
 		scaling.Scale( modelParent->scaling );
-		scaleModel = true;
-	}
-	else
-		scaleModel = false;
 
 	//Rotate Final World Matrix
 	if( rotation_ == Math::Vector3Int::Null )
@@ -407,23 +596,29 @@ void Mesh::UpdateBoundingVolumes()
 	if( verticesCount <= 0 )
 		return;
 
+	//Vertices of streamed Mesh aren't resident, keep Bounding Volumes built when they were
+	if( vertices == nullptr )
+		return;
+
 	bool first = true;
 
+	const auto& sourceSkinnedVerticesIndex = GetSourceMesh()->skinnedVerticesIndex;
+
 	//Building Bounding Box Volume
 	for( int i = 0; i < verticesCount; i++ )
 	{
 		Math::Matrix4 matrix;
 
 		//Skinned Mesh
-		if( (modelParent->skeleton) && skinnedVerticesIndex.size() )
+		if( (modelParent->skeleton) && sourceSkinnedVerticesIndex.size() )
 		{
 			const auto& bones = modelParent->skeleton->orderedMeshes;
 
 			if( bones.size() )
-				if( skinnedVerticesIndex.size() > 0 )
-					if( auto boneIndex = skinnedVerticesIndex[i]; i >= 0 && i < skinnedVerticesIndex[i] )
+				if( sourceSkinnedVerticesIndex.size() > 0 )
+					if( auto boneIndex = sourceSkinnedVerticesIndex[i]; i >= 0 && i < sourceSkinnedVerticesIndex[i] )
 						if( boneIndex >= 0 && boneIndex < (int)bones.size() )
-							matrix = bones[skinnedVerticesIndex[i]]->world;
+							matrix = bones[sourceSkinnedVerticesIndex[i]]->world;
 		}
 		else
 			matrix = world;
@@ -461,22 +656,6 @@ void Mesh::UpdateBoundingVolumes()
 	boundingSphere.center = worldBoundingBox.Center();
 }
 
-inline int Mesh::FindSimilarVertex( IO::SMD::PackedVertex& packed, std::map<IO::SMD::PackedVertex, unsigned int>& cache, unsigned short& out )
-{
-	auto it = cache.find( packed );
-
-	//Not Found
-	if( it == cache.end() )
-		return false;
-	else
-	{
-		out = it->second;
-		return true;
-	}
-
-	return false;
-}
-
 MeshRenderResult Mesh::CanRender()
 {
 	MeshRenderResult ret = MeshRenderResult::Undefined;
@@ -492,7 +671,7 @@ MeshRenderResult Mesh::CanRender()
 	return ret;
 }
 
-inline void Mesh::Skinning()
+void Mesh::Skinning()
 {
 	if( modelParent == nullptr )
 		return;
@@ -500,25 +679,109 @@ inline void Mesh::Skinning()
 	if( modelParent->skeleton == nullptr )
 		return;
 
-	if( vertexPositionBuffer && !vertexData.empty() )
+	const Mesh* source = GetSourceMesh();
+	const Model* skeleton = modelParent->skeleton;
+
+	if( vertexPositionBuffer && !source->skinnedVertices.empty() && !skeleton->orderedMeshes.empty() )
 	{
-		float* vertexPositionData = (float*)vertexPositionBuffer->Lock();
-		const auto& bones = modelParent->skeleton->orderedMeshes;
+		//Vertex Buffer already holds this Pose
+		if( source->skinnedPose.skeleton == skeleton && source->skinnedPose.poseVersion == skeleton->poseVersion )
+		{
+			skinningStatistics.skipped.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+
+		//Bones are flipped once per Pose
+		const Math::Matrix4* bones = modelParent->skeleton->GetSkinningMatrices();
 
-		if( vertexPositionData && bones.size() )
+		//Dual Quaternions are only blended by Vertices with weighted Bones
+		const BoneInfluences* influences = source->GetSkinningInfluences( skeleton );
+		const BoneDualQuaternion* dualQuaternions = influences && Model::GetSkinningMode() == SkinningMode::DualQuaternion ? modelParent->skeleton->GetSkinningDualQuaternions() : nullptr;
+
+		if( float* vertexPositionData = (float*)vertexPositionBuffer->Lock() )
 		{
-			for( const auto& v : vertexData )
-			{
-				Math::Vector3 out = bones[v.second]->world.FlippedYZ()* v.first;
+			SkinVertices( source->skinnedVertices.data(), influences, source->skinnedVertices.size(), bones, dualQuaternions, vertexPositionData );
+
+			vertexPositionBuffer->Unlock();
+
+			source->skinnedPose.skeleton = skeleton;
+			source->skinnedPose.poseVersion = skeleton->poseVersion;
 
-				*(vertexPositionData++) = out.x;
-				*(vertexPositionData++) = out.y;
-				*(vertexPositionData++) = out.z;
+			skinningStatistics.performed.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}
+}
+
+bool Mesh::SetBoneInfluences( const std::vector<BoneInfluences>& influences, const Model* skeleton )
+{
+	//Vertex Buffers belong to Asset Mesh
+	if( sourceMesh )
+	{
+		DELTA3D_LOGERROR( "Bone Influences must be set on Asset Mesh (%s)", name );
+		return false;
+	}
+
+	if( skeleton == nullptr || skeleton->orderedMeshes.empty() )
+	{
+		DELTA3D_LOGERROR( "Bone Influences of Mesh (%s) need a Skeleton", name );
+		return false;
+	}
+
+	if( vertexPositionBuffer == nullptr || skinnedVerticesIndex.empty() || influences.size() != vertexPositionBuffer->ElementCount() )
+	{
+		DELTA3D_LOGERROR( "Bone Influences don't match Skinned Vertices of Mesh (%s)", name );
+		return false;
+	}
+
+	//Every Bone must be on Skeleton and on Bones Palette
+	const int bonesCount = std::min( (int)skeleton->orderedMeshes.size(), maxPaletteBones );
+
+	std::vector<BoneInfluences> normalized( influences.size() );
+	int usedBones = 0;
+
+	for( size_t i = 0; i < influences.size(); i++ )
+	{
+		normalized[i] = NormalizeBoneInfluences( influences[i] );
+
+		for( int j = 0; j < maxBoneInfluences && normalized[i].weights[j]; j++ )
+		{
+			if( normalized[i].bones[j] >= bonesCount )
+			{
+				DELTA3D_LOGERROR( "Bone Influences of Mesh (%s) use an invalid Bone (%d of %d)", name, normalized[i].bones[j], bonesCount );
+				return false;
 			}
 
-			vertexPositionBuffer->Unlock();
+			usedBones = std::max( usedBones, normalized[i].bones[j] + 1 );
 		}
 	}
+
+	boneInfluences = std::move( normalized );
+	boneInfluencesBones = usedBones;
+
+	//Hardware Skinning reads Bones and Weights from Vertex Stream (shared by instances)
+	if( vertexBlendIndicesBuffer && vertexBlendIndicesBuffer->ElementCount() == boneInfluences.size() )
+	{
+		if( void* vertexBufferData = vertexBlendIndicesBuffer->Lock() )
+		{
+			memcpy( vertexBufferData, boneInfluences.data(), boneInfluences.size()* sizeof( BoneInfluences ) );
+			vertexBlendIndicesBuffer->Unlock();
+		}
+	}
+
+	//Vertex Buffer must be skinned again
+	skinnedPose = SkinnedPose();
+
+	return true;
+}
+
+const BoneInfluences* Mesh::GetSkinningInfluences( const Model* skeleton ) const
+{
+	const Mesh* source = GetSourceMesh();
+
+	if( skeleton == nullptr || source->boneInfluences.size() != source->skinnedVertices.size() || source->boneInfluencesBones > (int)skeleton->orderedMeshes.size() )
+		return nullptr;
+
+	return source->boneInfluences.data();
 }
 
 void Mesh::Update( float timeElapsed )
@@ -532,7 +795,7 @@ int Mesh::Render()
 		bool skinnedMesh = false;
 
 		//Skinned Mesh
-		if( modelParent->skeleton && skinnedVerticesIndex.size() )
+		if( modelParent->skeleton && GetSourceMesh()->skinnedVerticesIndex.size() )
 			skinnedMesh = true;
 
 		//Frustum Culling
@@ -546,6 +809,10 @@ int Mesh::Render()
 		if( renderer->IsDebugGeometry( DebugGeometry::DebugMesh ) )
 			renderer->DrawDebugAABB( worldBoundingBox.Transformed( translation ) );
 
+		//Software Skinning (once per Mesh per Pose)
+		if( skinnedMesh && graphics->useSoftwareSkinning )
+			Skinning();
+
 		//Set Vertex Position Buffer to Stream
 		if( FAILED( device->SetStreamSource( 0, vertexPositionBuffer->Get(), 0, vertexPositionBuffer->ElementSize() ) ) )
 			return false;
@@ -569,16 +836,11 @@ int Mesh::Render()
 				return false;
 
 		//Scaling Matrix
-		static Math::Matrix4 scalingMesh;
-		static bool scaleMesh = false;
+		Math::Matrix4 scalingMesh;
+		bool scaleMesh = modelParent->scaling != Math::Vector3( 1.0f, 1.0f, 1.0f );
 
-		if( modelParent->scaling != Math::Vector3( 1.0f, 1.0f, 1.0f ) )
-		{
+		if( scaleMesh )
 			scalingMesh.Scale( modelParent->scaling );
-			scaleMesh = true;
-		}
-		else
-			scaleMesh = false;
 
 		//Draw Mesh Parts (per material)
 		for( const auto& p : meshParts )
@@ -595,11 +857,8 @@ int Mesh::Render()
 				//Update Bones Transformations and set it to Texture Data
 				if( skinnedMesh )
 				{
-					//Software Skinning
-					if( graphics->useSoftwareSkinning )
-						Skinning();
 					//Hardware Skinning
-					else if( (modelParent->skeleton) && modelParent->skeleton->bonesTexture )
+					if( !graphics->useSoftwareSkinning && (modelParent->skeleton) && modelParent->skeleton->bonesTexture )
 					{
 						//Update Bones Texture Fetch
 						if( p.second->material->GetEffect() )
@@ -609,9 +868,37 @@ int Mesh::Render()
 					}
 				}
 
+				//Material is shared by every instance of Asset, so instance colors are applied only while rendering
+				Material* material = p.second->material;
+				bool instanceColors = modelParent->asset && material && (modelParent->useInstanceDiffuseColor || modelParent->useInstanceAddColor);
+				bool lastCustomMaterial = false;
+				Math::Color lastDiffuseColor, lastAddColor;
+
+				if( instanceColors )
+				{
+					lastCustomMaterial = material->customMaterial;
+					lastDiffuseColor = material->diffuseColor;
+					lastAddColor = material->addColor;
+
+					material->customMaterial = true;
+
+					if( modelParent->useInstanceDiffuseColor )
+						material->diffuseColor = modelParent->instanceDiffuseColor;
+
+					if( modelParent->useInstanceAddColor )
+						material->addColor = modelParent->instanceAddColor;
+				}
+
 				//Render It!
 				p.second->Render( vertexPositionBuffer, skinnedMesh );
 
+				if( instanceColors )
+				{
+					material->customMaterial = lastCustomMaterial;
+					material->diffuseColor = lastDiffuseColor;
+					material->addColor = lastAddColor;
+				}
+
 				//Pop Scaling Matrix
 				if( scaleMesh )
 					renderer->PopWorldMatrix();
@@ -626,52 +913,36 @@ int Mesh::Render()
 	return false;
 }
 
-bool Mesh::Build( FILE* file, Model* skeleton, bool readVertexColor )
+bool Mesh::BuildData( const IO::SMD::MeshData& data )
 {
-	if( file )
+	if( data.header )
 	{
-		std::vector<IO::SMD::VertexColor> verticesColor;
-		bool hasVertexColor = false;
+		const IO::SMD::ObjectHeader& objectHeader = *data.header;
 
-		fread( &header, sizeof( texturesCoord ) + offsetof( Mesh, texturesCoord ) - offsetof( Mesh, header ), 1, file );
-		fseek( file, 4 + sizeof( IO::SMD::Vertex ), SEEK_CUR );
+		header = objectHeader.header;
 
 		Math::Vector3 min, max;
-
-		int i;
-		fread( &i, sizeof( int ), 1, file );
-		max.z = (float)i / 256.0f;
-
-		fread( &i, sizeof( int ), 1, file );
-		min.z = (float)i / 256.0f;
-
-		fread( &i, sizeof( int ), 1, file );
-		max.y = (float)i / 256.0f;
-
-		fread( &i, sizeof( int ), 1, file );
-		min.y = (float)i / 256.0f;
-
-		fread( &i, sizeof( int ), 1, file );
-		max.x = (float)i / 256.0f;
-
-		fread( &i, sizeof( int ), 1, file );
-		max.x = (float)i / 256.0f;
+		max.z = (float)objectHeader.maxZ / 256.0f;
+		min.z = (float)objectHeader.minZ / 256.0f;
+		max.y = (float)objectHeader.maxY / 256.0f;
+		min.y = (float)objectHeader.minY / 256.0f;
+		max.x = (float)objectHeader.maxX / 256.0f;
+		min.x = (float)objectHeader.minX / 256.0f;
 
 		//Create Bounding Box
 		boundingBox = Math::BoundingBox( min, max );
 
-		fseek( file, 16, SEEK_CUR );
-		fread( &verticesCount, sizeof( texturesCount ) + offsetof( Mesh, texturesCount ) - offsetof( Mesh, verticesCount ), 1, file );
-		fseek( file, 8, SEEK_CUR );
-		fread( &position, sizeof( Math::Vector3 ), 1, file );
-		fseek( file, 12, SEEK_CUR );
-		fread( &rotation, sizeof( Math::Vector3Int ), 1, file );
-		fseek( file, 32, SEEK_CUR );
+		verticesCount = (int)data.vertices.Size();
+		facesCount = (int)data.faces.Size();
+		texturesCount = (int)data.textureLinks.Size();
+
+		rotation = Math::Vector3Int( objectHeader.rotation[0], objectHeader.rotation[1], objectHeader.rotation[2] );
 
-		fread( name, 32, 1, file );
-		fread( &parentName, 32, 1, file );
+		memcpy( name, objectHeader.name, sizeof( name ) );
+		memcpy( parentName, objectHeader.parentName, sizeof( parentName ) );
 
-		fseek( file, 4, SEEK_CUR );
+		name[_countof( name ) - 1] = 0;
+		parentName[_countof( parentName ) - 1] = 0;
 
 		auto ConvertMatrixToFloat = []( const int b[4][4] )
 		{
@@ -684,297 +955,305 @@ bool Mesh::Build( FILE* file, Model* skeleton, bool readVertexColor )
 			return m;
 		};
 
-		int m[4][4] = { 0 };
-		fread( &m, sizeof( m ), 1, file );
-		baseFrame = ConvertMatrixToFloat( m );
+		baseFrame = ConvertMatrixToFloat( objectHeader.baseFrame );
+		baseFrameInverse = ConvertMatrixToFloat( objectHeader.baseFrameInverse );
+		memcpy( &resultAnimation, objectHeader.resultAnimation, sizeof( Math::Matrix4 ) );
+		baseRotation = ConvertMatrixToFloat( objectHeader.baseRotation );
+		world = ConvertMatrixToFloat( objectHeader.world );
+		local = ConvertMatrixToFloat( objectHeader.local );
 
-		fread( &m, sizeof( m ), 1, file );
-		baseFrameInverse = ConvertMatrixToFloat( m );
+		//Fix Position
+		position = Math::Vector3( baseFrame._41, baseFrame._42, baseFrame._43 );
 
-		fread( &resultAnimation, sizeof( m ), 1, file );
+		lastFrame = objectHeader.lastFrame;
+		basePosition = Math::Vector3Int( objectHeader.basePosition[0], objectHeader.basePosition[1], objectHeader.basePosition[2] );
 
-		fread( &m, sizeof( m ), 1, file );
-		baseRotation = ConvertMatrixToFloat( m );
+		frameRotationCount = (int)data.keyRotations.Size();
+		framePositionCount = (int)data.keyPositions.Size();
+		frameScalingCount = (int)data.keyScales.Size();
 
-		fread( &m, sizeof( m ), 1, file );
-		world = ConvertMatrixToFloat( m );
+		memcpy( framesInfoRotation, objectHeader.framesInfoRotation, sizeof( framesInfoRotation ) );
+		memcpy( framesInfoPosition, objectHeader.framesInfoPosition, sizeof( framesInfoPosition ) );
+		memcpy( framesInfoScaling, objectHeader.framesInfoScaling, sizeof( framesInfoScaling ) );
+		framesInfoCount = objectHeader.framesInfoCount;
 
-		fread( &m, sizeof( m ), 1, file );
-		local = ConvertMatrixToFloat( m );
+		BuildAnimationRanges();
 
-		//Fix Position
-		position = Math::Vector3( baseFrame._41, baseFrame._42, baseFrame._43 );
+		//Vertices and Keyframes are used after build, so keep a copy of them (mapped file will be closed)
+		BuildVertices( data );
+
+		//Keyframes are kept compressed
+		if( !rotationTrack.Build( data.keyRotations, data.previousRotations ) )
+			DELTA3D_LOGDEBUG( "Previous Rotations of %s aren't pure rotations, they are kept as Matrices", name );
 
-		fread( &lastFrame, sizeof( int ), 1, file );
-		fseek( file, 28, SEEK_CUR );
-		fread( &basePosition, sizeof( framesInfoCount ) + offsetof( Mesh, framesInfoCount ) - offsetof( Mesh, basePosition ), 1, file );
+		positionTrack.Build( data.keyPositions );
+		scalingTrack.Build( data.keyScales );
 
-		IO::SMD::TextureLink* psTextureTmp = texturesCoord;
+		return true;
+	}
 
-		//Allocate Vertexs
-		vertices = new IO::SMD::Vertex[verticesCount];
-		fread( vertices, sizeof(IO::SMD::Vertex)* verticesCount, 1, file );
+	return false;
+}
 
-		//Allocate Faces
-		faces = new IO::SMD::Face[facesCount];
-		fread( faces, sizeof(IO::SMD::Face)* facesCount, 1, file );
+void Mesh::BuildVertices( const IO::SMD::MeshData& data )
+{
+	ReleaseVertices();
 
-		//Allocate Textures Link
-		texturesCoord = new IO::SMD::TextureLink[texturesCount];
-		fread( texturesCoord, sizeof(IO::SMD::TextureLink)* texturesCount, 1, file );
+	vertices = new IO::SMD::Vertex[data.vertices.Size()];
 
-		//Allocate Animations Rotation, Position and Scale
-		frameRotation = new IO::SMD::KeyRotation[frameRotationCount];
-		fread( frameRotation, sizeof(IO::SMD::KeyRotation)* frameRotationCount, 1, file );
+	if( !data.vertices.Empty() )
+		memcpy( vertices, data.vertices.Data(), data.vertices.SizeBytes() );
 
-		framePosition = new IO::SMD::KeyPosition[framePositionCount];
-		fread( framePosition, sizeof(IO::SMD::KeyPosition)* framePositionCount, 1, file );
+	verticesCount = (int)data.vertices.Size();
+}
 
-		frameScaling = new IO::SMD::KeyScale[frameScalingCount];
-		fread( frameScaling, sizeof(IO::SMD::KeyScale)* frameScalingCount, 1, file );
+void Mesh::ReleaseVertices()
+{
+	//Instance doesn't own Asset data
+	if( sourceMesh == nullptr )
+		delete[] vertices;
 
-		//Allocate Previous Rotation
-		previousRotation = new Math::Matrix4[frameRotationCount];
-		fread( previousRotation, sizeof(Math::Matrix4)* frameRotationCount, 1, file );
+	vertices = nullptr;
+}
 
-		//Restore Texture Link
-		int iSubTextureLinkID = texturesCoord - psTextureTmp;
+void Mesh::BuildAnimationRanges()
+{
+	animationRanges.clear();
 
-		//Read Textures Link
-		for( int i = 0; i < texturesCount; i++ )
+	int count = std::min( std::max( framesInfoCount, 0 ), (int)_countof( framesInfoRotation ) );
+
+	if( count == 0 )
+		return;
+
+	//Frames where active Motion of any Track may change
+	std::vector<int> boundaries;
+
+	for( const auto* framesInfo : { framesInfoRotation, framesInfoPosition, framesInfoScaling } )
+	{
+		for( int i = 0; i < count; i++ )
 		{
-			if( texturesCoord[i].next )
+			if( framesInfo[i].keyFrameCount > 0 && framesInfo[i].startFrame < framesInfo[i].endFrame )
 			{
-				iSubTextureLinkID = texturesCoord[i].next - psTextureTmp;
-				texturesCoord[i].next = texturesCoord + iSubTextureLinkID;
+				boundaries.push_back( framesInfo[i].startFrame );
+				boundaries.push_back( framesInfo[i].endFrame );
 			}
 		}
+	}
+
+	std::sort( boundaries.begin(), boundaries.end() );
+	boundaries.erase( std::unique( boundaries.begin(), boundaries.end() ), boundaries.end() );
+
+	//First Motion containing frame wins, as Motions may overlap
+	auto FindMotion = [count]( const IO::SMD::Frame* framesInfo, int frame )
+	{
+		for( int i = 0; i < count; i++ )
+			if( framesInfo[i].keyFrameCount > 0 && framesInfo[i].startFrame <= frame && framesInfo[i].endFrame > frame )
+				return framesInfo[i].keyFrameStartIndex;
+
+		return -1;
+	};
+
+	for( int frame : boundaries )
+	{
+		AnimationRange range = { frame, FindMotion( framesInfoRotation, frame ), FindMotion( framesInfoPosition, frame ), FindMotion( framesInfoScaling, frame ) };
 
-		//Read Face Textures Link
-		for( int i = 0; i < facesCount; i++ )
+		//Merge with previous Range if nothing changed
+		if( !animationRanges.empty() )
 		{
-			if( faces[i].textureLink )
-			{
-				iSubTextureLinkID = faces[i].textureLink - psTextureTmp;
-				faces[i].textureLink = texturesCoord + iSubTextureLinkID;
-			}
+			const auto& previous = animationRanges.back();
+
+			if( previous.rotationIndex == range.rotationIndex && previous.positionIndex == range.positionIndex && previous.scalingIndex == range.scalingIndex )
+				continue;
 		}
 
-		skinnedVerticesIndex.clear();
-		skinnedVerticesIndex.reserve( verticesCount );
+		animationRanges.push_back( range );
+	}
+}
 
-		//Skinned Object? Generate Bones List and Skinned Indices
-		if( skeleton )
-		{
-			char* pszBuff = new char[verticesCount* 32];
-			fread( pszBuff, verticesCount* 32, 1, file );
+bool Mesh::BuildBuffers( const IO::SMD::MeshGeometryView& geometry )
+{
+	skinnedVerticesIndex.assign( geometry.skinnedVerticesIndex.begin(), geometry.skinnedVerticesIndex.end() );
 
-			for( int i = 0; i < verticesCount; i++ )
-			{
-				int boneIndex = skeleton->GetOrderedMeshIndex( pszBuff + i* 32 );
+	//Nothing to render (Skeleton Mesh or Mesh without Materials)
+	if( geometry.positions.Empty() )
+		return true;
 
-				if( boneIndex != -1 )
-					skinnedVerticesIndex.push_back( boneIndex );
-			}
+	//Cooked Geometry may be corrupt, every Stream needs a value per Vertex and Parts must index them
+	size_t count = geometry.positions.Size();
 
-			delete[] pszBuff;
-		}
+	if( geometry.normals.Size() != count || geometry.colors.Size() != count || (!geometry.blendIndices.Empty() && geometry.blendIndices.Size() != count) || geometry.textureCoordsCount > _countof( geometry.textureCoords ) )
+		return false;
 
-		//Read Vertices Colors
-		if( readVertexColor )
-		{
-			//Check if have Vertices Colors
-			fread( &hasVertexColor, sizeof( bool ), 1, file );
+	for( unsigned int i = 0; i < geometry.textureCoordsCount; i++ )
+		if( geometry.textureCoords[i].Size() != count )
+			return false;
 
-			if( hasVertexColor )
-			{
-				for( int i = 0; i < verticesCount; i++ )
-				{
-					float r, g, b;
-					fread( &r, sizeof( float ), 1, file );
-					fread( &g, sizeof( float ), 1, file );
-					fread( &b, sizeof( float ), 1, file );
+	for( const auto& part : geometry.parts )
+		if( part.indexStart > geometry.indices.Size() || part.indexCount > geometry.indices.Size() - part.indexStart )
+			return false;
 
-					verticesColor.push_back( IO::SMD::VertexColor{ r,g,b } );
-				}
+	for( auto index : geometry.indices )
+		if( index >= count )
+			return false;
+
+	//Create a Vertex Buffer and fill it with Stream Data
+	auto CreateVertexBuffer = [this]( const auto& stream, bool dynamic )
+	{
+		using Type = std::remove_const_t<std::remove_reference_t<decltype( *stream.Data() )>>;
+
+		auto vertexBuffer = dynamic ? graphics->CreateDynamicVertexBuffer( sizeof( Type ), stream.Size() ) : graphics->CreateStaticVertexBuffer( sizeof( Type ), stream.Size() );
+
+		if( vertexBuffer )
+		{
+			if( void* vertexBufferData = vertexBuffer->Lock() )
+			{
+				memcpy( vertexBufferData, stream.Data(), stream.SizeBytes() );
+				vertexBuffer->Unlock();
 			}
 		}
 
-		//Do not build Mesh if it's a Skeleton Mesh
-		if( facesCount > 0 && _strnicmp( name, "Bip01", 5 ) != 0 )
+		return vertexBuffer;
+	};
+
+	//Skinned Mesh Flag
+	bool skinnedMesh = !geometry.blendIndices.Empty();
+
+	//Create Vertex Buffer to store Bones and Weights (SMD Vertices follow only one Bone, unless Influences were set)
+	if( skinnedMesh && !graphics->useSoftwareSkinning )
+	{
+		std::vector<BoneInfluences> influences( boneInfluences );
+
+		if( influences.size() != geometry.blendIndices.Size() )
 		{
-			//Skinned Mesh Flag
-			bool skinnedMesh = skeleton && skinnedVerticesIndex.size() > 0;
+			influences.resize( geometry.blendIndices.Size() );
 
-			//Create Texture to store Bones Matrices
-			if( skinnedMesh && !graphics->useSoftwareSkinning )
-				vertexBlendIndicesBuffer = graphics->CreateStaticVertexBuffer( sizeof( float ), facesCount* 3 );
+			for( size_t i = 0; i < geometry.blendIndices.Size(); i++ )
+				influences[i] = BoneInfluences{ { (unsigned char)geometry.blendIndices[i], 0, 0, 0 }, { 255, 0, 0, 0 } };
+		}
 
-			//Create Vertex Buffer and Texture Coordinates Buffer
-			if( skinnedMesh && graphics->useSoftwareSkinning )
-				vertexPositionBuffer = graphics->CreateDynamicVertexBuffer( sizeof( Math::Vector3 ), facesCount* 3 );
-			else
-				vertexPositionBuffer = graphics->CreateStaticVertexBuffer( sizeof( Math::Vector3 ), facesCount* 3 );
+		vertexBlendIndicesBuffer = CreateVertexBuffer( IO::Span<BoneInfluences>( influences.data(), influences.size() ), false );
+	}
 
-			vertexNormalBuffer = graphics->CreateStaticVertexBuffer( sizeof( Math::Vector3 ), facesCount* 3 );
-			vertexColorBuffer = graphics->CreateStaticVertexBuffer( sizeof( D3DCOLOR ), facesCount* 3 );
+	vertexPositionBuffer = CreateVertexBuffer( geometry.positions, skinnedMesh && graphics->useSoftwareSkinning );
+	vertexNormalBuffer = CreateVertexBuffer( geometry.normals, false );
+	vertexColorBuffer = CreateVertexBuffer( geometry.colors, false );
 
-			//Vertex Buffer and Texture Coordinates Buffer was created successfully?
-			if( vertexPositionBuffer && vertexNormalBuffer && vertexColorBuffer )
-			{
-				float* vertexPositionData = (float*)vertexPositionBuffer->Lock();
-				float* vertexNormalData = (float*)vertexNormalBuffer->Lock();
-				float* vertexColorData = (float*)vertexColorBuffer->Lock();		
-				float* textureCoordData[8] = { 0 };
-				float* vertexBlendIndicesData = nullptr;
-
-				//Skinned Mesh
-				if( vertexBlendIndicesBuffer )
-					vertexBlendIndicesData = (float*)vertexBlendIndicesBuffer->Lock();
-
-				//Was locked successfully?
-				if( vertexPositionData && vertexNormalData && vertexColorData )
-				{
-					unsigned int curVertexIndex = 0;
-					std::map<IO::SMD::PackedVertex, unsigned int> verticesIndex;
+	//Vertex Buffers was created successfully?
+	if( !vertexPositionBuffer || !vertexNormalBuffer || !vertexColorBuffer )
+		return false;
 
-					//Build Texture Coordinates Before proceed
-					for( int i = 0; i < facesCount; i++ )
-					{
-						IO::SMD::Face* face = faces + i;
+	//Texture Coordinates Buffers
+	for( unsigned int i = 0; i < geometry.textureCoordsCount; i++ )
+		if( auto textureCoordBuffer = CreateVertexBuffer( geometry.textureCoords[i], false ) )
+			textureCoordsBuffer.push_back( textureCoordBuffer );
 
-						//First Face?
-						if( textureCoordsBuffer.empty() )
-						{
-							auto texCoord = face->textureLink;
-
-							while( texCoord )
-							{
-								if( textureCoordsBuffer.size() >= 8 )
-									break;
-
-								auto textureCoordBuffer = graphics->CreateStaticVertexBuffer( sizeof( Math::Vector2 ), facesCount* 3 );
-								if( textureCoordBuffer )
-								{
-									textureCoordData[textureCoordsBuffer.size()] = (float*)textureCoordBuffer->Lock();
-									textureCoordsBuffer.push_back( textureCoordBuffer );
-								}
-
-								texCoord = texCoord->next;
-							}
-						}
-						else
-							break;
-					}
+	//Fill structure for Software Skinning
+	if( skinnedMesh && graphics->useSoftwareSkinning )
+	{
+		skinnedVertices.resize( geometry.positions.Size() );
 
-					//Loop through Mesh Faces
-					for( int i = 0; i < facesCount; i++ )
-					{
-						IO::SMD::Face* face = faces + i;
-						Material* material = (modelParent) && modelParent->materialCollection ? &modelParent->materialCollection->materials[face->v[3]] : nullptr;
+		for( size_t i = 0; i < geometry.positions.Size(); i++ )
+			skinnedVertices[i] = SkinnedVertex{ geometry.positions[i].x, geometry.positions[i].y, geometry.positions[i].z, (int)geometry.blendIndices[i] };
+	}
 
-						//Material not found or face without textures coordinates? Do nothing!
-						if( !material || !face->textureLink )
-							continue;
+	//Mesh Parts (per material)
+	for( const auto& part : geometry.parts )
+	{
+		if( (modelParent == nullptr) || (modelParent->materialCollection == nullptr) || part.materialID >= modelParent->materialCollection->materialsCount )
+			continue;
+
+		Material* material = &modelParent->materialCollection->materials[part.materialID];
+
+		MeshPart* meshPart = new MeshPart();
+		meshPart->material = material;
+		meshPart->mesh = this;
+		meshPart->indices.assign( geometry.indices.Data() + part.indexStart, geometry.indices.Data() + part.indexStart + part.indexCount );
+		meshPart->boundingBox.min = part.min;
+		meshPart->boundingBox.max = part.max;
+		meshParts[material] = meshPart;
+	}
 
-						MeshPart* meshPart = nullptr;
+	return true;
+}
 
-						//Find Mesh Part by current face Material
-						if( meshParts.find( material ) != meshParts.end() )
-							meshPart = meshParts[material];
-						else
-						{
-							//Not Found? So create it and put on mesh parts vector
-							meshPart = new MeshPart();
-							meshPart->material = material;
-							meshPart->mesh = this;
-							meshParts[material] = meshPart;
-						}
-						
-						//Loop through Face Vertices (A,B,C)
-						for( int j = 0; j < 3; j++ )
-						{
-							//Temporary Variables used to find Vertex
-							Math::Vector3 position( vertices[face->v[j]].x / 256.0f, vertices[face->v[j]].y / 256.0f, vertices[face->v[j]].z / 256.0f );
-							Math::Vector3 normal( vertices[face->v[j]].nx / 256.0f, vertices[face->v[j]].ny / 256.0f, vertices[face->v[j]].nz / 256.0f );
-							Math::Vector2 uv1( face->textureLink->u[j], face->textureLink->v[j] );
-							D3DCOLOR vertexColor = hasVertexColor ? Math::Color( verticesColor[face->v[j]].r, verticesColor[face->v[j]].g, verticesColor[face->v[j]].b ).ToUInt() : -1;
-
-							IO::SMD::PackedVertex packedVertex = { 0 };
-							packedVertex.position = position;
-							packedVertex.color = vertexColor;
-							packedVertex.boneIndex = skinnedMesh ? skinnedVerticesIndex[face->v[j]] : -1;
-							
-							auto texCoord = face->textureLink;
-
-							//Fill Texture Coordinates Buffer Data
-							for( int k = 0; k < _countof( textureCoordData ); k++ )
-							{
-								if( texCoord == nullptr )
-									break;
-
-								if( textureCoordData[k] )
-								{
-									packedVertex.uv[k].u = texCoord->u[j];
-									packedVertex.uv[k].v = texCoord->v[j];
-
-									*(textureCoordData[k]++) = texCoord->u[j];
-									*(textureCoordData[k]++) = texCoord->v[j];
-								}
-
-								texCoord = texCoord->next;
-							}
-
-							//Find Similar Vertex to Build Index Buffer
-							unsigned short index = 0;
-							bool found = FindSimilarVertex( packedVertex, verticesIndex, index );
-
-							//Found? Push vertex index found, else, current vertex index
-							if( found )
-								meshPart->indices.push_back( index );
-							else
-								meshPart->indices.push_back( verticesIndex[packedVertex] = curVertexIndex );
-
-							//Fill Vertex Buffer Data
-							*(vertexPositionData++) = position.x;
-							*(vertexPositionData++) = position.y;
-							*(vertexPositionData++) = position.z;
-							*(vertexNormalData++) = normal.x;
-							*(vertexNormalData++) = normal.y;
-							*(vertexNormalData++) = normal.z;
-							*((DWORD*)(vertexColorData++)) = vertexColor;
-
-							//Fill structure for Software Skinning
-							if( graphics->useSoftwareSkinning )
-								vertexData.push_back( std::make_pair( Math::Vector3( position.x, position.y, position.z ), skinnedVerticesIndex[face->v[j]] ) );
-
-							//Skinned Mesh? So push the bone index
-							if( vertexBlendIndicesData )
-								*(vertexBlendIndicesData++) = (float)skinnedVerticesIndex[face->v[j]];
-
-							curVertexIndex++;
-						}	
-					}
+std::vector<int> Mesh::GetBonesIndex( const IO::SMD::MeshData& data, Model* skeleton )
+{
+	std::vector<int> bonesIndex;
 
-					vertexPositionBuffer->Unlock();
-					vertexNormalBuffer->Unlock();
-					vertexColorBuffer->Unlock();
+	//Skinned Object? Generate Bones List and Skinned Indices
+	if( skeleton )
+	{
+		bonesIndex.reserve( data.boneNames.Size() );
 
-					if( vertexBlendIndicesBuffer )
-						vertexBlendIndicesBuffer->Unlock();
+		//Bone Names already resolved on this Mesh (vertices share few Bones)
+		std::unordered_map<std::string, int> resolvedBones;
 
-					for( auto& texCoordBuffer : textureCoordsBuffer )
-						texCoordBuffer->Unlock();
-				}
-			}
+		for( const auto& boneName : data.boneNames )
+		{
+			std::string name( boneName.name, strnlen( boneName.name, sizeof( boneName.name ) ) );
+
+			auto it = resolvedBones.find( name );
+
+			if( it == resolvedBones.end() )
+				it = resolvedBones.emplace( name, skeleton->GetOrderedMeshIndex( name ) ).first;
+
+			if( it->second != -1 )
+				bonesIndex.push_back( it->second );
 		}
+	}
 
-		//Mesh loaded
-		loaded = true;
+	return bonesIndex;
+}
 
-		return true;
+bool Mesh::Build( const IO::SMD::MeshData& data, Model* skeleton, IO::SMD::MeshGeometry* geometryOut )
+{
+	if( !BuildData( data ) )
+		return false;
+
+	return BuildWeldedBuffers( data, skeleton, geometryOut );
+}
+
+bool Mesh::Build( const IO::SMD::MeshData& data, const IO::SMD::MeshGeometryView& geometry, Model* skeleton )
+{
+	if( !BuildData( data ) )
+		return false;
+
+	if( !BuildBuffers( geometry ) )
+	{
+		DELTA3D_LOGERROR( "Could not create Buffers of %s from Cooked Geometry, welding it again from SMD", name );
+
+		ReleaseBuffers();
+
+		return BuildWeldedBuffers( data, skeleton, nullptr );
 	}
 
-	return false;
+	//Mesh loaded
+	loaded = true;
+
+	return true;
+}
+
+bool Mesh::BuildWeldedBuffers( const IO::SMD::MeshData& data, Model* skeleton, IO::SMD::MeshGeometry* geometryOut )
+{
+	//Weld Vertices and split Faces by Material
+	IO::SMD::MeshGeometry geometry;
+	geometry.Build( data, GetBonesIndex( data, skeleton ), (modelParent) && modelParent->materialCollection ? modelParent->materialCollection->materialsCount : 0 );
+
+	if( !BuildBuffers( geometry.View() ) )
+	{
+		DELTA3D_LOGERROR( "Could not create Buffers of %s", name );
+
+		ReleaseBuffers();
+		return false;
+	}
+
+	//Keep Geometry to be cooked
+	if( geometryOut )
+		*geometryOut = std::move( geometry );
+
+	//Mesh loaded
+	loaded = true;
+
+	return true;
 }
 }
\ No newline at end of file
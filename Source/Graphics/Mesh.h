@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Graphics.h"
+#include "Skinning.h"
 
 #include "../IO/SMD/Frame.h"
 #include "../IO/SMD/Header.h"
@@ -8,9 +9,12 @@
 #include "../IO/SMD/KeyPosition.h"
 #include "../IO/SMD/KeyScale.h"
 #include "../IO/SMD/KeyRotation.h"
+#include "../IO/SMD/KeyTrack.h"
 #include "../IO/SMD/Face.h"
 #include "../IO/SMD/Vertex.h"
 #include "../IO/SMD/TextureLink.h"
+#include "../IO/SMD/MeshLoader.h"
+#include "../IO/SMD/MeshGeometry.h"
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 #include "../Math/Matrix4.h"
@@ -36,6 +40,33 @@ enum class MeshRenderResult
 	Opacity,
 };
 
+//! Max number of Animations blended by Model::AnimateBlend.
+const int maxAnimationLayers = 4;
+
+struct AnimationLayer
+{
+	int frame;	//!< Animation Frame
+	float weight;	//!< Blend Weight (Layers are normalized by the sum of weights)
+};
+
+struct BoneTransform
+{
+	Math::Quaternion rotation;	//!< Local Rotation
+	const Math::Matrix4* previousRotation;	//!< Accumulated Rotation kept as Matrix (scaled or mirrored Bone), rotation is only the interpolated Keyframe then
+	Math::Vector3 scaling;	//!< Local Scaling
+	Math::Vector3 translation;	//!< Local Translation
+	bool rotationAnimated;	//!< Rotation was sampled (Base Rotation is used otherwise)
+	bool scalingAnimated;	//!< Scaling was sampled
+};
+
+struct AnimationRange
+{
+	int startFrame;	//!< First Frame of Range (Range ends where next one starts)
+	int rotationIndex;	//!< First Rotation Keyframe of active Motion (-1 if none)
+	int positionIndex;	//!< First Position Keyframe of active Motion (-1 if none)
+	int scalingIndex;	//!< First Scaling Keyframe of active Motion (-1 if none)
+};
+
 class Mesh : public GraphicsImpl
 {
 public:
@@ -45,6 +76,13 @@ public:
 	//! Construct a Mesh with a number of Vertices and Faces specified.
 	Mesh( int verticesCount_, int facesCount_ );
 
+	/**
+	 * Construct a Mesh instance sharing Vertices, Keyframes, Buffers and Mesh Parts of an Asset Mesh
+	 * @param sourceMesh_ Asset Mesh (must be alive while instance exists)
+	 * @param modelParent_ Model instance owning this Mesh
+	 */
+	Mesh( const Mesh* sourceMesh_, Model* modelParent_ );
+
 	//! Deconstructor.
 	~Mesh();
 
@@ -81,19 +119,44 @@ public:
 	int AddTextureCoord( int faceIndex, Math::Vector2 texA = Math::Vector2::Null, Math::Vector2 texB = Math::Vector2::Null, Math::Vector2 texC = Math::Vector2::Null );
 
 	/**
-	 * Apply a Rotation Transform to Animation Matrix
+	 * Sample Rotation Track (Previous Rotation combined with interpolated Keyframe)
+	 * @param track Rotation Track
+	 * @param firstKey First Keyframe of active Motion
+	 * @param frame_ Frame to be sampled
+	 * @param cursor Track Cursor
+	 * @param out Receive Rotation
+	 * @param previousMatrix Receive Accumulated Rotation Matrix if Track keeps them (out is only the interpolated Keyframe then), nullptr otherwise
+	 * @return False if frame is out of Track
 	 */
-	void ApplyRotationTransform( Math::Matrix4& out, Math::Matrix4* previousRotation_, IO::SMD::KeyRotation* frameRotation_, int frame_, IO::SMD::FrameInfo* frameInfo = nullptr );
+	static bool SampleRotation( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Quaternion& out, const Math::Matrix4*& previousMatrix );
+
+	//! Sample Scaling Track (same parameters of SampleRotation).
+	static bool SampleScaling( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Vector3& out );
+
+	//! Sample Position Track (same parameters of SampleRotation).
+	static bool SampleTranslation( const IO::SMD::KeyTrack& track, int firstKey, int frame_, int& cursor, Math::Vector3& out );
 
 	/**
-	 * Apply a Scaling Transform to Animation Matrix
+	 * Sample local Transform of Mesh
+	 * @param frame_ Frame to be sampled
+	 * @param cursor Keyframe Cursors used to sample
+	 * @param out Receive Transform
+	 * @return False if Mesh has no Animation on frame (Base Transform is used)
 	 */
-	void ApplyScalingTransform( Math::Matrix4& out, IO::SMD::KeyScale* frameScaling_, int frame_ );
+	bool SampleTransform( int frame_, IO::SMD::KeyCursor& cursor, BoneTransform& out ) const;
+
+	//! Build local Matrix of a sampled Transform.
+	Math::Matrix4 GetLocalTransform( const BoneTransform& transform ) const;
+
+	//! Get local Matrix of Mesh without Animation.
+	Math::Matrix4 GetBaseTransform() const;
 
 	/**
-	 * Apply a Translation Transform to Animation Matrix
+	 * Find active Motion of each Keyframe Track specified by Frame
+	 * @param frame Frame desired to find
+	 * @return Pointer to Animation Range or nullptr if no Motion is active
 	 */
-	void ApplyTranslationTransform( Math::Matrix4& out, IO::SMD::KeyPosition* framePosition_, int frame_ );
+	const AnimationRange* FindAnimationRange( int frame ) const;
 
 	/**
 	 * Find Animation of Position specified by Frame
@@ -124,6 +187,21 @@ public:
 	 */
 	void Animate( int frame_ = 0, Math::Vector3Int rotation_ = Math::Vector3Int::Null, IO::SMD::FrameInfo* frameInfo = nullptr );
 
+	/**
+	 * Animate Mesh blending Animations (Rotations, Scalings and Translations are blended before Matrices are built)
+	 * @param layers Animations to be blended
+	 * @param layersCount Layers Count (up to maxAnimationLayers)
+	 * @param rotation_ Rotation to Model
+	 */
+	void AnimateBlend( const AnimationLayer* layers, int layersCount, Math::Vector3Int rotation_ = Math::Vector3Int::Null );
+
+	/**
+	 * Update Animation and World Matrices from local Matrix
+	 * @param result Local Matrix of Mesh
+	 * @param rotation_ Rotation to Model
+	 */
+	void UpdateWorld( const Math::Matrix4& result, Math::Vector3Int rotation_ );
+
 	/**
 	 * Set a Position and Rotation for Mesh
 	 * @param position_ Position desired
@@ -136,8 +214,8 @@ public:
 	 */
 	void UpdateBoundingVolumes();
 
-	//! Find a similar Vertex and return your Index.
-	inline int FindSimilarVertex( IO::SMD::PackedVertex& packed, std::map<IO::SMD::PackedVertex, unsigned int>& cache, unsigned short& out );
+	//! Get Mesh owning Geometry Data (Asset Mesh if this is an instance).
+	const Mesh* GetSourceMesh() const { return sourceMesh ? sourceMesh : this; }
 
 	//! Check if Mesh was already loaded.
 	inline const bool IsLoaded() const { return loaded; }
@@ -145,8 +223,24 @@ public:
 	//! Check if Mesh can be renderer now.
 	MeshRenderResult CanRender();
 
-	//! Software Skinning.
-	inline void Skinning();
+	//! Software Skinning (skipped if Vertex Buffer already holds the current Pose of Skeleton).
+	void Skinning();
+
+	/**
+	 * Set up to 4 weighted Bones for each Vertex of a Skinned Mesh (SMD Vertices follow only one Bone)
+	 * Influences follow Vertex Buffers order and are shared by instances, so they are set on Asset Mesh after it's built
+	 * Effects read only the heaviest Bone of each Vertex (Blend Indices), every Bone is blended by Software Skinning
+	 * @param influences Bones and Weights of each Vertex (normalized and sorted here)
+	 * @param skeleton Skeleton Model the Mesh is rendered with (every Bone must be on it and on Bones Palette)
+	 * @return True if Influences were set
+	 */
+	bool SetBoneInfluences( const std::vector<BoneInfluences>& influences, const Model* skeleton );
+
+	//! Get Bones and Weights of each Vertex (empty if each Vertex follows one Bone).
+	const std::vector<BoneInfluences>& GetBoneInfluences() const { return GetSourceMesh()->boneInfluences; }
+
+	//! Get Bones and Weights to skin this Mesh with a Skeleton (nullptr if Vertices follow one Bone or Skeleton lacks a Bone of them).
+	const BoneInfluences* GetSkinningInfluences( const Model* skeleton ) const;
 
 	//! Update Mesh.
 	void Update( float timeElapsed );
@@ -154,13 +248,63 @@ public:
 	//! Render Mesh.
 	int Render();
 
-	//! Build Mesh. (File should be already opened)
-	bool Build( FILE* file, Model* skeleton = nullptr, bool readVertexColor = false );
+	//! Read Mesh Header, Vertices and Keyframes from SMD Mesh Data.
+	bool BuildData( const IO::SMD::MeshData& data );
+
+	//! Build Animation Ranges from Frames Info of every Keyframe Track.
+	void BuildAnimationRanges();
+
+	//! Create Vertex Buffers and Mesh Parts from Geometry.
+	bool BuildBuffers( const IO::SMD::MeshGeometryView& geometry );
+
+	//! Release Vertex Buffers and Mesh Parts (Mesh Data is kept, so Buffers can be built again).
+	void ReleaseBuffers();
+
+	//! Copy Vertices from SMD Mesh Data (streamed Mesh copies them again when its Buffers are created).
+	void BuildVertices( const IO::SMD::MeshData& data );
+
+	//! Release copy of Vertices (Bounding Volumes built with them are kept).
+	void ReleaseVertices();
+
+	/**
+	 * Get Skeleton Bones Indices used by each Vertex of a Skinned Mesh (only reads Skeleton, safe on worker threads)
+	 * @param data Mesh Data views over the mapped SMD file
+	 * @param skeleton Skeleton Model (nullptr if not Skinned Mesh)
+	 * @return Bones Indices List
+	 */
+	static std::vector<int> GetBonesIndex( const IO::SMD::MeshData& data, Model* skeleton );
+
+	/**
+	 * Build Mesh from SMD Mesh Data
+	 * @param data Mesh Data views over the mapped SMD file
+	 * @param skeleton Skeleton Model (if Skinned Mesh)
+	 * @param geometryOut Receive welded Geometry (to be cooked)
+	 * @return True if Mesh was built
+	 */
+	bool Build( const IO::SMD::MeshData& data, Model* skeleton = nullptr, IO::SMD::MeshGeometry* geometryOut = nullptr );
+
+	/**
+	 * Build Mesh from SMD Mesh Data and Cooked Geometry (welded again from SMD if Cooked Geometry can't be used)
+	 * @param data Mesh Data views over the mapped SMD file
+	 * @param geometry Cooked Geometry of Mesh
+	 * @param skeleton Skeleton Model (if Skinned Mesh)
+	 * @return True if Mesh was built
+	 */
+	bool Build( const IO::SMD::MeshData& data, const IO::SMD::MeshGeometryView& geometry, Model* skeleton = nullptr );
+
+	/**
+	 * Weld Geometry from SMD Mesh Data and create Buffers with it
+	 * @param data Mesh Data views over the mapped SMD file
+	 * @param skeleton Skeleton Model (if Skinned Mesh)
+	 * @param geometryOut Receive welded Geometry (to be cooked)
+	 * @return True if Buffers were created (Mesh is left without Buffers otherwise)
+	 */
+	bool BuildWeldedBuffers( const IO::SMD::MeshData& data, Model* skeleton, IO::SMD::MeshGeometry* geometryOut );
 public:
 	DWORD header;	//!< Mesh Header
 	IO::SMD::Vertex* vertices;	//!< Vertices List
-	IO::SMD::Face* faces;	//!< Faces List
-	IO::SMD::TextureLink* texturesCoord;	//!< Textures Coordinate List 
+	IO::SMD::Face* faces;	//!< Faces List (only kept by Meshes created with AddFace)
+	IO::SMD::TextureLink* texturesCoord;	//!< Textures Coordinate List (only kept by Meshes created with AddFace)
 
 	Math::BoundingBox boundingBox;	//!< Bounding Box
 	Math::BoundingBox worldBoundingBox;	//!< World Bounding Box
@@ -192,10 +336,9 @@ public:
 
 	Math::Vector3Int basePosition;	//!< Mesh Base Position
 
-	IO::SMD::KeyRotation* frameRotation;	//!< Animation Frame Rotation
-	IO::SMD::KeyPosition* framePosition;	//!< Animation Frame Position
-	IO::SMD::KeyScale* frameScaling;	//!< Animation Frame Scaling
-	Math::Matrix4* previousRotation;	//!< Previous Animation Rotation Matrix
+	IO::SMD::KeyTrack rotationTrack;	//!< Animation Frame Rotation and Previous Rotation (only on Asset Mesh)
+	IO::SMD::KeyTrack positionTrack;	//!< Animation Frame Position (only on Asset Mesh)
+	IO::SMD::KeyTrack scalingTrack;	//!< Animation Frame Scaling (only on Asset Mesh)
 
 	int	frameRotationCount;	//!< Frames Rotation Count
 	int	framePositionCount;	//!< Frames Position Count
@@ -205,19 +348,26 @@ public:
 	IO::SMD::Frame framesInfoPosition[32];	//!< Frames Info of Position Animation
 	IO::SMD::Frame framesInfoScaling[32];	//!< Frames Info of Scaling Animation
 	int framesInfoCount;	//!< Frames Info Count
+	std::vector<AnimationRange> animationRanges;	//!< Frames Info of all Tracks merged in Ranges sorted by frame (only on Asset Mesh)
+
+	IO::SMD::KeyCursor keyCursors[maxAnimationLayers];	//!< Keyframe Segments sampled by last Animate of each Layer (per instance)
 
 	std::shared_ptr<VertexBuffer> vertexPositionBuffer;	//!< Mesh Vertex Buffer
 	std::shared_ptr<VertexBuffer> vertexNormalBuffer;	//!< Mesh Normals Buffer
 	std::shared_ptr<VertexBuffer> vertexColorBuffer;	//!< Mesh Vertex Color Buffer
-	std::shared_ptr<VertexBuffer> vertexBlendIndicesBuffer;	//!< Mesh Blend Indices Buffer
+	std::shared_ptr<VertexBuffer> vertexBlendIndicesBuffer;	//!< Mesh Bones Influences Buffer (Blend Indices and Weights)
 	std::vector<std::shared_ptr<VertexBuffer>> textureCoordsBuffer;	//!< Textures Coordinates Buffer
 
 	std::vector<int> skinnedVerticesIndex;	//!< Skinned Vertices Index (if Skinned Mesh)
-	std::vector<std::pair<Math::Vector3,int>> vertexData;	//!< Used for Software Skinning
+	std::vector<SkinnedVertex> skinnedVertices;	//!< Bind Pose Positions and Bones (Software Skinning)
+	std::vector<BoneInfluences> boneInfluences;	//!< Weighted Bones per Vertex (kept when Buffers are released, so they can be built again)
+	int boneInfluencesBones;	//!< Bones a Skeleton needs to skin Bone Influences (highest Bone + 1)
+	mutable SkinnedPose skinnedPose;	//!< Pose held by Vertex Position Buffer (kept on Asset Mesh, Buffer is shared by instances)
 
 	std::unordered_map<Material*, MeshPart*> meshParts;	//!< Mesh Parts (by material)
 
 	Model* modelParent;	//!< Pointer to Model Parent from this Mesh
+	const Mesh* sourceMesh;	//!< Asset Mesh owning shared data (nullptr if not an instance)
 
 	bool postRender;	//!< Flag to render mesh after everything
 	bool loaded;	//!< Flag to determinate if mesh was loaded successfully
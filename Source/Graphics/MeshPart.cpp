@@ -89,11 +89,7 @@ void MeshPart::Build()
 			//Build Indices Array
 			if( indicesArray )
 			{
-				int curIndice = 0;
-
-				//Append it to Array
-				for( const auto& i : indices )
-					indicesArray[curIndice++] = i;
+				memcpy( indicesArray, indices.data(), indices.size()* sizeof( unsigned short ) );
 
 				indexBuffer->Unlock();
 			}
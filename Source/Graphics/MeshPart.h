@@ -39,6 +39,7 @@ public:
 	Mesh* mesh;	//!< Parent Mesh
 	Material* material;	//!< Material Pointer
 	std::vector<unsigned short> indices;	//!< Indices of this Mesh Part
+	Math::BoundingBox boundingBox;	//!< Bounding Box of this Mesh Part
 	std::shared_ptr<IndexBuffer> indexBuffer;	//!< Index Buffer
 	MeshRenderResult canRender;	//!< Can Render Mesh Part Flag
 };
@@ -2,11 +2,21 @@
 #include "Model.h"
 
 #include "Renderer.h"
+#include "Camera.h"
+#include "Animator.h"
+#include "PoseCache.h"
+#include "SkeletonEvaluator.h"
+
+#include "../Core/ThreadPool.h"
+#include "../IO/Hash.h"
 
 namespace Delta3D::Graphics
 {
 std::function<void( Mesh* )> Model::customRenderer( nullptr );
 std::function<void( MaterialCollection* )> Model::customMaterialCollection( nullptr );
+bool Model::useMeshCache = true;
+bool Model::useSkeletonEvaluator = true;
+SkinningMode Model::skinningMode = SkinningMode::Linear;
 
 Model::Model() : 
 	GraphicsImpl::GraphicsImpl(), 
@@ -24,7 +34,25 @@ Model::Model() :
 	version( ModelVersion::SMDModelHeader62 ),
 	bonesWorldMatrices( nullptr ), 
 	bonesTransformations( nullptr ), 
-	forceUpdate( false )
+	deferBonesUpload( false ),
+	bonesTextureDirty( false ),
+	animatorPhase( 0 ),
+	animatorPushPhase( 0 ),
+	animatorFrame( -1 ),
+	animatorRotation( -1, -1, -1 ),
+	animatorFrameInfo{ -1, -1 },
+	animatorPoseVersion( 0 ),
+	renderFrameInfo{ -1, -1 },
+	frameBlendPhase( 0 ),
+	poseVersion( 0 ),
+	skinningMatricesVersion( 0 ),
+	skinningDualQuaternionsVersion( 0 ),
+	skinningDualQuaternionsValid( false ),
+	forceUpdate( false ),
+	streamMeshes( false ),
+	asset( nullptr ),
+	useInstanceDiffuseColor( false ),
+	useInstanceAddColor( false )
 {
 }
 
@@ -41,10 +69,15 @@ Model::~Model()
 
 	meshes.clear();
 	orderedMeshes.clear();
+	meshesIndex.clear();
+	orderedMeshesIndex.clear();
 
+	//Material Collection of instance belongs to Asset
 	if( materialCollection )
 	{
-		delete materialCollection;
+		if( asset == nullptr )
+			delete materialCollection;
+
 		materialCollection = nullptr;
 	}
 
@@ -60,6 +93,14 @@ Model::~Model()
 		bonesWorldMatrices = nullptr;
 	}
 
+	//Poses evaluated by this Skeleton can't be found anymore
+	if( asset == nullptr && graphics->GetPoseCache() )
+		graphics->GetPoseCache()->Remove( this );
+
+	//Model pushed by last Render isn't animated by next Animator Run
+	if( graphics->GetAnimator() )
+		graphics->GetAnimator()->Remove( this );
+
 	Core::Timer::DeleteTimer( this );
 }
 
@@ -74,14 +115,17 @@ bool Model::AddMesh( Mesh* mesh )
 
 		meshes.push_back( mesh );
 
+		//First Mesh with same name is kept
+		meshesIndex.emplace( GetMeshNameKey( mesh->name, sizeof( mesh->name ) ), (int)meshes.size() - 1 );
+
 		int newMaxFrame = 0;
 
 		//Check max frame of Mesh
-		if( mesh->frameRotationCount > 0 && mesh->frameRotation )
-			newMaxFrame = mesh->frameRotation[mesh->frameRotationCount-1].frame;
+		if( mesh->frameRotationCount > 0 && mesh->GetSourceMesh()->rotationTrack.Size() )
+			newMaxFrame = mesh->GetSourceMesh()->rotationTrack.GetFrame( mesh->frameRotationCount-1 );
 
-		if( mesh->framePositionCount > 0 && mesh->framePosition )
-			newMaxFrame = mesh->framePosition[mesh->framePositionCount-1].frame;
+		if( mesh->framePositionCount > 0 && mesh->GetSourceMesh()->positionTrack.Size() )
+			newMaxFrame = mesh->GetSourceMesh()->positionTrack.GetFrame( mesh->framePositionCount-1 );
 
 		//Set new max Frame of Model
 		if( newMaxFrame > maxFrame )
@@ -112,19 +156,19 @@ void Model::ReorderMeshes()
 	{
 		if( mesh->parentName[0] != 0 )
 		{
-			for( auto& parentMesh : meshes )
-			{
-				if( _strnicmp( mesh->parentName, parentMesh->name, 32 ) == 0 )
-				{
-					mesh->parent = parentMesh;
-					break;
-				}
-			}
+			auto it = meshesIndex.find( GetMeshNameKey( mesh->parentName, sizeof( mesh->parentName ) ) );
+
+			if( it != meshesIndex.end() )
+				mesh->parent = meshes[it->second];
 		}
 	}
 
+	//Evaluator is built again from new Ordered Meshes
+	skeletonEvaluator.reset();
+
 	//Clear List of Ordered Meshes
 	orderedMeshes.clear();
+	orderedMeshesIndex.clear();
 
 	//Build a Reserve
 	orderedMeshes.reserve( meshes.size() );
@@ -170,6 +214,12 @@ void Model::ReorderMeshes()
 
 		orderedMeshes.push_back( mesh );
 	}
+
+	//Build Ordered Meshes Dictionary (Skinned Meshes resolve Bones by name)
+	orderedMeshesIndex.reserve( orderedMeshes.size() );
+
+	for( size_t i = 0; i < orderedMeshes.size(); i++ )
+		orderedMeshesIndex.emplace( GetMeshNameKey( orderedMeshes[i]->name, sizeof( orderedMeshes[i]->name ) ), (int)i );
 }
 
 void Model::SetParent( Model* modelParent, Mesh* meshParent )
@@ -184,15 +234,9 @@ void Model::SetParent( Model* modelParent, Mesh* meshParent )
 
 Mesh* Model::GetMesh( std::string meshName )
 {
-	if( meshes.empty() )
-		return nullptr;
-
-	for( auto& mesh : meshes )
-		if( mesh )
-			if( _strcmpi( mesh->name, meshName.c_str() ) == 0 )
-				return mesh;
+	int meshIndex = GetMeshIndex( meshName );
 
-	return nullptr;
+	return meshIndex != -1 ? meshes[meshIndex] : nullptr;
 }
 
 int Model::GetOrderedMeshIndex( const std::string& meshName )
@@ -200,14 +244,9 @@ int Model::GetOrderedMeshIndex( const std::string& meshName )
 	if( orderedMeshes.empty() )
 		return -1;
 
-	for( size_t i = 0; i < orderedMeshes.size(); i++ )
-	{
-		if( orderedMeshes[i] )
-			if( _strcmpi( orderedMeshes[i]->name, meshName.c_str() ) == 0 )
-				return i;
-	}
+	auto it = orderedMeshesIndex.find( GetMeshNameKey( meshName.c_str(), meshName.size() ) );
 
-	return -1;
+	return it != orderedMeshesIndex.end() ? it->second : -1;
 }
 
 int Model::GetMeshIndex( const std::string& meshName )
@@ -215,14 +254,9 @@ int Model::GetMeshIndex( const std::string& meshName )
 	if( meshes.empty() )
 		return -1;
 
-	for( size_t i = 0; i < meshes.size(); i++ )
-	{
-		if( meshes[i] )
-			if( _strcmpi( meshes[i]->name, meshName.c_str() ) == 0 )
-				return i;
-	}
+	auto it = meshesIndex.find( GetMeshNameKey( meshName.c_str(), meshName.size() ) );
 
-	return -1;
+	return it != meshesIndex.end() ? it->second : -1;
 }
 
 std::vector<Mesh*> Model::GetMeshes( std::string meshName )
@@ -237,6 +271,26 @@ std::vector<Mesh*> Model::GetMeshes( std::string meshName )
 	return ret;
 }
 
+std::string Model::GetMeshNameKey( const char* name, size_t length )
+{
+	std::string key( name, strnlen( name, length ) );
+
+	for( auto& c : key )
+		c = (char)tolower( (unsigned char)c );
+
+	return key;
+}
+
+unsigned long long Model::GetBonesHash() const
+{
+	unsigned long long hash = 0;
+
+	for( const auto& mesh : orderedMeshes )
+		hash = IO::Hash64( mesh->name, strnlen( mesh->name, sizeof( mesh->name ) ), hash );
+
+	return hash;
+}
+
 void Model::SetFrame( int frame_, IO::SMD::FrameInfo* frameInfo )
 {
 	if( frame_ >= 0 )
@@ -245,6 +299,28 @@ void Model::SetFrame( int frame_, IO::SMD::FrameInfo* frameInfo )
 		{
 			skeleton->Animate( frame_, rotation, frameInfo );
 
+			//Update World Matrices
+			UpdateMeshesWorld();
+		}
+		else
+			Animate( frame_, rotation, frameInfo );
+	}
+
+	//Update Bounding Volumes not Forced
+	UpdateBoundingVolumes();
+}
+
+void Model::SetFrameBlend( const AnimationLayer* layers, int layersCount )
+{
+	if( layers && layersCount > 0 )
+	{
+		//Animator evaluates a single Frame, so its next Run leaves this Model to SetFrameBlend
+		frameBlendPhase = graphics->GetAnimator()->GetPhase() + 1;
+
+		if( skeleton )
+		{
+			skeleton->AnimateBlend( layers, layersCount, rotation );
+
 			//Update World Matrices
 			if( !meshes.empty() )
 				for( auto& mesh : meshes )
@@ -252,7 +328,7 @@ void Model::SetFrame( int frame_, IO::SMD::FrameInfo* frameInfo )
 						mesh->world = mesh->parent->world;
 		}
 		else
-			Animate( frame_, rotation, frameInfo );
+			AnimateBlend( layers, layersCount, rotation );
 	}
 
 	//Update Bounding Volumes not Forced
@@ -266,12 +342,74 @@ void Model::Animate( int frame_, Math::Vector3Int rotation_, IO::SMD::FrameInfo*
 
 	lastAnimationFrame = frame_;
 	lastRotation = rotation_;
+	poseVersion++;
+
+	//Instances of same Skeleton Asset on same Pose reuse it (Asset is shared when Model Factory and 2 instances or more hold it)
+	PoseCache* poseCache = asset && asset.use_count() > 2 ? graphics->GetPoseCache() : nullptr;
+
+	PoseKey poseKey;
+	poseKey.skeleton = asset.get();
+	poseKey.frame = frame_;
+	poseKey.rotation = rotation_;
+	poseKey.scaling = scaling;
+
+	if( poseCache && forceUpdate == false && poseCache->Apply( poseKey, this ) )
+		return;
+
+	if( useSkeletonEvaluator && skeletonEvaluator == nullptr )
+	{
+		skeletonEvaluator = std::make_unique<SkeletonEvaluator>();
+		skeletonEvaluator->Build( orderedMeshes );
+	}
+
+	//Animate every Bone at once
+	if( useSkeletonEvaluator && skeletonEvaluator->GetBonesCount() == (int)orderedMeshes.size() )
+	{
+		skeletonEvaluator->Evaluate( frame_, rotation_, scaling );
+		skeletonEvaluator->Apply( orderedMeshes );
+
+		if( bonesWorldMatrices )
+			memcpy( bonesWorldMatrices, skeletonEvaluator->GetWorlds(), orderedMeshes.size()* sizeof( Math::Matrix4 ) );
+	}
+	else
+	{
+		//Animate Meshes
+		int boneIndex = 0;
+		for( const auto& mesh : orderedMeshes )
+		{
+			mesh->Animate( frame_, rotation_, frameInfo );
+
+			if( bonesWorldMatrices )
+				bonesWorldMatrices[boneIndex++] = mesh->world;
+		}
+	}
+
+	//Update Bones Transformations
+	UpdateBonesTransformations();
+
+	IO::SMD::FlushKeyLookupStatistics();
+
+	if( poseCache )
+		poseCache->Store( poseKey, this );
+	else if( graphics->GetPoseCache() && bonesTexture )
+	{
+		//Bones Texture doesn't hold a cached Pose anymore
+		graphics->GetPoseCache()->ResetUploadedPose( bonesTexture.get() );
+	}
+}
+
+void Model::AnimateBlend( const AnimationLayer* layers, int layersCount, Math::Vector3Int rotation_ )
+{
+	//Next Animate can't skip the same frame, Pose was changed
+	lastAnimationFrame = -1;
+	lastRotation = rotation_;
+	poseVersion++;
 
 	//Animate Meshes
 	int boneIndex = 0;
 	for( const auto& mesh : orderedMeshes )
 	{
-		mesh->Animate( frame_, rotation_, frameInfo );
+		mesh->AnimateBlend( layers, layersCount, rotation_ );
 
 		if( bonesWorldMatrices )
 			bonesWorldMatrices[boneIndex++] = mesh->world;
@@ -279,6 +417,12 @@ void Model::Animate( int frame_, Math::Vector3Int rotation_, IO::SMD::FrameInfo*
 
 	//Update Bones Transformations
 	UpdateBonesTransformations();
+
+	IO::SMD::FlushKeyLookupStatistics();
+
+	//Bones Texture doesn't hold a cached Pose anymore
+	if( auto poseCache = graphics->GetPoseCache(); poseCache && bonesTexture )
+		poseCache->ResetUploadedPose( bonesTexture.get() );
 }
 
 void Model::SetPositionRotation( Math::Vector3* position_, Math::Vector3Int* rotation_ )
@@ -329,23 +473,91 @@ void Model::UpdateBonesTransformations()
 {
 	if( bonesTexture && bonesTransformations && bonesWorldMatrices )
 	{
+		//Effects blend 3x4 Matrices (Dual Quaternion mode is Software Skinning only)
 		Math::Matrix4::BulkTransposeTo3x4( bonesTransformations, (float*)bonesWorldMatrices, orderedMeshes.size() );
 
 		//Set Bone Transformations Data to Texture Data
-		if( bonesTexture )
-		{
-			if( bonesTexture->Lock() )
-			{
-				bonesTexture->SetPixelData( bonesTransformations, orderedMeshes.size()* sizeof( float )* 12 );
-				bonesTexture->Unlock();
-			}
-		}
+		UploadBonesTexture();
+	}
+}
+
+const Math::Matrix4* Model::GetSkinningMatrices()
+{
+	if( skinningMatricesVersion != poseVersion || skinningMatrices.size() != orderedMeshes.size() )
+	{
+		skinningMatrices.resize( orderedMeshes.size() );
+
+		for( size_t i = 0; i < orderedMeshes.size(); i++ )
+			skinningMatrices[i] = orderedMeshes[i]->world.FlippedYZ();
+
+		skinningMatricesVersion = poseVersion;
+	}
+
+	return skinningMatrices.data();
+}
+
+const BoneDualQuaternion* Model::GetSkinningDualQuaternions()
+{
+	if( skinningDualQuaternionsVersion != poseVersion || skinningDualQuaternions.size() != orderedMeshes.size() )
+	{
+		std::vector<Math::Matrix4> worlds( orderedMeshes.size() );
+
+		for( size_t i = 0; i < orderedMeshes.size(); i++ )
+			worlds[i] = orderedMeshes[i]->world;
+
+		skinningDualQuaternions.resize( orderedMeshes.size() );
+		skinningDualQuaternionsValid = BuildDualQuaternions( worlds.data(), worlds.size(), skinningDualQuaternions.data() );
+
+		skinningDualQuaternionsVersion = poseVersion;
+	}
+
+	return skinningDualQuaternionsValid ? skinningDualQuaternions.data() : nullptr;
+}
+
+void Model::UploadBonesTexture()
+{
+	if( bonesTexture == nullptr || bonesTransformations == nullptr )
+		return;
+
+	//Device is used only by rendering thread
+	if( deferBonesUpload )
+	{
+		bonesTextureDirty = true;
+		return;
+	}
+
+	if( bonesTexture->Lock() )
+	{
+		bonesTexture->SetPixelData( bonesTransformations, orderedMeshes.size()* sizeof( float )* bonePaletteStride );
+		bonesTexture->Unlock();
 	}
+
+	bonesTextureDirty = false;
+}
+
+void Model::UpdateMeshesWorld()
+{
+	for( auto& mesh : meshes )
+		if( mesh->parent )
+			mesh->world = mesh->parent->world;
+}
+
+bool Model::IsCulled( Camera* camera ) const
+{
+	bool useCustomRenderer = (materialCollection) && materialCollection->materialType && !skeleton && customRenderer;
+
+	return !useCustomRenderer && useFrustumCulling && boundingSphere.radius != 0.0f && camera->Frustum().IsInside( boundingSphere.Transformed( position ) ) == Intersection::Outside;
 }
 
 void Model::SetDiffuseColor( Math::Color color )
 {
-	if( materialCollection )
+	//Materials are shared with other instances
+	if( asset )
+	{
+		useInstanceDiffuseColor = true;
+		instanceDiffuseColor = color;
+	}
+	else if( materialCollection )
 	{
 		if( materialCollection->materials )
 		{
@@ -362,7 +574,13 @@ void Model::SetDiffuseColor( Math::Color color )
 
 void Model::SetAddColor( Math::Color color )
 {
-	if( materialCollection )
+	//Materials are shared with other instances
+	if( asset )
+	{
+		useInstanceAddColor = true;
+		instanceAddColor = color;
+	}
+	else if( materialCollection )
 	{
 		if( materialCollection->materials )
 		{
@@ -404,11 +622,30 @@ bool Model::Render( IO::SMD::FrameInfo* frameInfo, ModelGroup* modelGroup )
 		customMaterialCollection( materialCollection );
 
 	//Check Frustum Culling
-	if( !useCustomRenderer && useFrustumCulling && boundingSphere.radius != 0.0f && renderer->GetCamera()->Frustum().IsInside( boundingSphere.Transformed( position ) ) == Intersection::Outside )
+	if( IsCulled( renderer->GetCamera() ) )
 		return false;
 
-	//Set Model Frame
-	SetFrame( frame, frameInfo );
+	Animator* animator = graphics->GetAnimator();
+
+	renderFrameInfo = frameInfo ? *frameInfo : IO::SMD::FrameInfo{ -1, -1 };
+
+	//Set Model Frame (unless Animator did it already with same Frame, Rotation and Frame Info, and nothing posed Skeleton since)
+	const Model* posedModel = skeleton ? skeleton : this;
+
+	bool animated = animatorPhase == animator->GetPhase() && animatorPoseVersion == posedModel->poseVersion &&
+		animatorFrame == frame && posedModel->lastAnimationFrame == frame &&
+		animatorRotation == rotation && posedModel->lastRotation == rotation &&
+		animatorFrameInfo.startFrame == renderFrameInfo.startFrame && animatorFrameInfo.endFrame == renderFrameInfo.endFrame;
+
+	if( animated == false )
+		SetFrame( frame, frameInfo );
+
+	//Model rendered on this frame is animated by Animator on next one, before anything is rendered
+	if( animatorPushPhase != animator->GetPhase() )
+	{
+		animator->Push( this );
+		animatorPushPhase = animator->GetPhase();
+	}
 
 	//Draw Bounding Sphere on Debug Mode
 	if( renderer->IsDebugGeometry( DebugGeometry::DebugModel ) )
@@ -446,95 +683,432 @@ bool Model::Render( IO::SMD::FrameInfo* frameInfo, ModelGroup* modelGroup )
 	return true;
 }
 
-bool Model::Load( std::string filePath, Model* skeleton_, bool temporaryTextures )
+bool Model::Read( const std::string& filePath, Model* skeleton_, bool temporaryTextures )
 {
-	FILE* file = nullptr;
-	fopen_s( &file, filePath.c_str(), "rb" );
+	loadData = std::make_unique<ModelLoadData>();
+	loadData->filePath = filePath;
+	loadData->skeleton = skeleton_;
+	loadData->temporaryTextures = temporaryTextures;
+
+	IO::SMD::MeshLoader& meshLoader = loadData->meshLoader;
 
-	if( file )
+	if( meshLoader.Open( filePath ) )
 	{
 		//Get Model Name
 		filesystem::path f( filePath );
 		std::string name = f.filename().string();
 		name = name.substr( 0, name.size() - 4 );
 
-		IO::SMD::Header	header = { 0 };
-		IO::SMD::ObjectInfo* objectsInfo = nullptr;
-
-		//Read Header
-		fread( &header, sizeof(IO::SMD::Header), 1, file );
+		const IO::SMD::Header& header = *meshLoader.GetHeader();
 
 		//Identiy SMD Version
-		if( _strcmpi( header.header, "SMD Model data Ver 0.64" ) == 0 )
+		if( _strnicmp( header.header, "SMD Model data Ver 0.64", sizeof( header.header ) ) == 0 )
 			version = ModelVersion::SMDModelHeader64;
 
-		//Read Objects
-		objectsInfo = new IO::SMD::ObjectInfo[header.objectCount];
-		fread( objectsInfo, sizeof( IO::SMD::ObjectInfo )* header.objectCount, 1, file );
-
 		//Push Animations Frame Info
 		for( int i = 0; i < header.frameCount; i++ )
 			animationsFrameInfo.push_back( header.frames[i] );
 
-		//Load Materials
+		//Read Materials (Textures and Effects are created by Create)
 		if( header.materialCount )
 		{
-			std::string materialListPath = filePath.substr( 0, filePath.size() - 4 ) + ".txt";
-			filesystem::path p( materialListPath );
+			filesystem::path p( filePath.substr( 0, filePath.size() - 4 ) + ".txt" );
 
 			materialCollection = new MaterialCollection( name );
 
 			if( materialCollection )
+				materialCollection->Read( meshLoader.GetReader(), IO::FileSystem::Get()->Exists( p.string() ) ? false : true );
+		}
+
+		//Cooked Mesh Cache is valid only for the same SMD File and Skeleton
+		if( useMeshCache )
+		{
+			loadData->sourceHash = IO::Hash64( meshLoader.GetFile().Data(), meshLoader.GetFile().Size() );
+			loadData->skeletonHash = skeleton_ ? skeleton_->GetBonesHash() : 0;
+
+			loadData->meshCacheValid = loadData->meshCache.Open( filePath + "c", loadData->sourceHash, loadData->skeletonHash ) && loadData->meshCache.GetMeshCount() == meshLoader.GetObjects().Size();
+		}
+
+		//Read Objects (views over the mapped SMD File, nothing is copied)
+		std::vector<IO::SMD::MeshData>& meshesData = loadData->meshesData;
+		meshesData.reserve( meshLoader.GetObjects().Size() );
+
+		for( size_t i = 0; i < meshLoader.GetObjects().Size(); i++ )
+		{
+			//Set File Pointer
+			if( version != ModelVersion::SMDModelHeader64 )
+				meshLoader.SeekObject( i );
+
+			IO::SMD::MeshData meshData;
+
+			if( !meshLoader.ReadMesh( meshData, skeleton_ ? true : false, version == ModelVersion::SMDModelHeader64 ) )
 			{
-				if( version == ModelVersion::SMDModelHeader64 )
-				{
-					materialCollection->Build( file, skeleton_ ? true : false, filesystem::exists( p ) ? false : true, true, 3, temporaryTextures, true );
-					materialCollection->Load( materialListPath, true );
-					materialCollection->materialType = 0;
-				}
-				else
-					materialCollection->Build( file, skeleton_ ? true : false, filesystem::exists( p ) ? false : true, false, 0, temporaryTextures, true );
+				DELTA3D_LOGERROR( "Could not read object %d from %s", (int)i, filePath.c_str() );
+
+				loadData->allObjectsRead = false;
+				break;
 			}
+
+			meshesData.push_back( meshData );
 		}
 
-		//Add Objects to Pattern
-		for( int i = 0; i < header.objectCount; i++ )
+		//Weld Vertices and split Faces by Material on workers (Cooked Mesh Cache has it done)
+		std::vector<IO::SMD::MeshGeometry>& geometries = loadData->geometries;
+		geometries.resize( loadData->meshCacheValid ? 0 : meshesData.size() );
+
+		if( !geometries.empty() )
 		{
-			//Set File Pointer
-			if(  version != ModelVersion::SMDModelHeader64 )
-				fseek( file, objectsInfo[i].filePointerToObject, SEEK_SET );
+			int materialsCount = materialCollection ? materialCollection->materialsCount : 0;
 
-			Mesh* mesh = new Mesh();
-			if( mesh )
+			Core::ThreadPool::Get()->ParallelFor( meshesData.size(), [&]( size_t i )
+			{
+				geometries[i].Build( meshesData[i], Mesh::GetBonesIndex( meshesData[i], skeleton_ ), materialsCount );
+			} );
+		}
+
+		return true;
+	}
+
+	loadData.reset();
+
+	return false;
+}
+
+bool Model::Create( unsigned int meshesCount )
+{
+	if( !loadData )
+		return false;
+
+	//Create Materials (streamed Model creates them on demand)
+	if( !loadData->materialsCreated )
+	{
+		if( materialCollection && streamMeshes )
+		{
+			if( version == ModelVersion::SMDModelHeader64 )
+			{
+				materialCollection->ReadList( loadData->filePath.substr( 0, loadData->filePath.size() - 4 ) + ".txt" );
+				materialCollection->materialType = 0;
+			}
+
+			loadData->materialsReferences.resize( materialCollection->materialsCount, 0 );
+		}
+		else if( materialCollection )
+		{
+			if( version == ModelVersion::SMDModelHeader64 )
 			{
-				mesh->modelParent = this;
-				mesh->Build( file, skeleton_, version == ModelVersion::SMDModelHeader64 );
-				AddMesh( mesh );
+				materialCollection->Create( loadData->skeleton ? true : false, true, 3, loadData->temporaryTextures, true );
+				materialCollection->Load( loadData->filePath.substr( 0, loadData->filePath.size() - 4 ) + ".txt", true );
+				materialCollection->materialType = 0;
 			}
+			else
+				materialCollection->Create( loadData->skeleton ? true : false, false, 0, loadData->temporaryTextures, true );
+		}
+
+		loadData->materialsCreated = true;
+	}
+
+	//Add Objects to Pattern (Buffers are created on this thread)
+	const auto& meshesData = loadData->meshesData;
+	size_t meshesEnd = meshesCount ? std::min( loadData->meshesCreated + meshesCount, meshesData.size() ) : meshesData.size();
+
+	for( size_t& i = loadData->meshesCreated; i < meshesEnd; i++ )
+	{
+		Mesh* mesh = new Mesh();
+		if( mesh )
+		{
+			mesh->modelParent = this;
+
+			if( streamMeshes )
+				mesh->BuildData( meshesData[i] );
+			else
+				mesh->Build( meshesData[i], loadData->meshCacheValid ? *loadData->meshCache.GetMesh( i ) : loadData->geometries[i].View(), loadData->skeleton );
+
+			AddMesh( mesh );
 		}
+	}
+
+	//Remaining Meshes are created on next call
+	if( loadData->meshesCreated < meshesData.size() )
+		return true;
 
-		//Link Objets Parent
-		ReorderMeshes();
+	//Write Cooked Mesh Cache
+	if( useMeshCache && !loadData->meshCacheValid && loadData->allObjectsRead )
+	{
+		std::string meshCachePath = loadData->filePath + "c";
+		std::vector<IO::SMD::MeshGeometryView> views;
+		views.reserve( loadData->geometries.size() );
 
-		//Set Model Skeleton
-		skeleton = skeleton_;
+		for( const auto& geometry : loadData->geometries )
+			views.push_back( geometry.View() );
 
-		//Create Texture for bones fetch
-		if( skeleton && graphics->useSoftwareSkinning == false )
+		if( !IO::SMD::MeshCache::Write( meshCachePath, loadData->sourceHash, loadData->skeletonHash, views ) )
+			DELTA3D_LOGDEBUG( "Could not write Cooked Mesh Cache %s", meshCachePath.c_str() );
+		else if( streamMeshes )
 		{
-			skeleton->bonesTexture = graphics->GetTextureFactory()->CreateDynamicTexture( 384, 1 );
-			skeleton->bonesWorldMatrices = new Math::Matrix4[skeleton->orderedMeshes.size()];
-			skeleton->bonesTransformations = new float[skeleton->orderedMeshes.size()* 12];
+			//Streamed Model reads Geometry from mapped Cooked Mesh Cache, so welded Geometry can be released
+			loadData->meshCacheValid = loadData->meshCache.Open( meshCachePath, loadData->sourceHash, loadData->skeletonHash ) && loadData->meshCache.GetMeshCount() == loadData->geometries.size();
+
+			if( loadData->meshCacheValid )
+				loadData->geometries.clear();
 		}
+	}
+
+	//Link Objets Parent
+	ReorderMeshes();
 
-		//Delete Objects Info Pointer
-		delete[] objectsInfo;
-		fclose( file );
+	//Set Model Skeleton
+	SetSkeleton( loadData->skeleton );
 
+	//Release File Mapping and CPU Geometry (streamed Model keeps them to create Mesh Buffers on demand)
+	if( streamMeshes )
+		streamData = std::move( loadData );
+	else
+		loadData.reset();
+
+	return true;
+}
+
+void Model::PrefetchMeshBuffers( size_t meshIndex ) const
+{
+	if( !streamData || meshIndex >= streamData->meshesData.size() )
+		return;
+
+	//Read a byte of each page
+	auto Touch = []( const auto& span )
+	{
+		const volatile unsigned char* data = (const volatile unsigned char*)span.Data();
+
+		for( size_t i = 0; i < span.SizeBytes(); i += 4096 )
+			(void)data[i];
+	};
+
+	//Vertices copied by CreateMeshBuffers
+	Touch( streamData->meshesData[meshIndex].vertices );
+
+	if( !streamData->meshCacheValid || meshIndex >= streamData->meshCache.GetMeshCount() )
+		return;
+
+	const IO::SMD::MeshGeometryView& geometry = *streamData->meshCache.GetMesh( meshIndex );
+
+	Touch( geometry.positions );
+	Touch( geometry.normals );
+	Touch( geometry.colors );
+	Touch( geometry.indices );
+
+	for( unsigned int i = 0; i < geometry.textureCoordsCount; i++ )
+		Touch( geometry.textureCoords[i] );
+}
+
+bool Model::CreateMeshBuffers( size_t meshIndex )
+{
+	if( !streamData || meshIndex >= meshes.size() || meshIndex >= streamData->meshesData.size() )
+		return false;
+
+	Mesh* mesh = meshes[meshIndex];
+
+	if( mesh->IsLoaded() )
 		return true;
+
+	//Copy Vertices again from mapped SMD File (released with Buffers)
+	if( mesh->vertices == nullptr )
+		mesh->BuildVertices( streamData->meshesData[meshIndex] );
+
+	const IO::SMD::MeshGeometryView& geometry = streamData->meshCacheValid ? *streamData->meshCache.GetMesh( meshIndex ) : streamData->geometries[meshIndex].View();
+
+	if( !mesh->BuildBuffers( geometry ) )
+	{
+		mesh->ReleaseBuffers();
+
+		//Cooked Geometry can't be used, weld it again from mapped SMD File
+		if( !streamData->meshCacheValid || !mesh->BuildWeldedBuffers( streamData->meshesData[meshIndex], streamData->skeleton, nullptr ) )
+		{
+			DELTA3D_LOGERROR( "Could not create Buffers of streamed Mesh %s", mesh->name );
+			return false;
+		}
+	}
+
+	mesh->loaded = true;
+
+	//Create Materials used by Mesh Parts (same ones ReleaseMeshBuffers releases, whatever Geometry was used)
+	for( const auto& meshPart : mesh->meshParts )
+	{
+		int materialID = (int)(meshPart.first - materialCollection->materials);
+
+		if( materialID < 0 || materialID >= (int)streamData->materialsReferences.size() )
+			continue;
+
+		if( streamData->materialsReferences[materialID]++ == 0 )
+		{
+			if( version == ModelVersion::SMDModelHeader64 )
+				materialCollection->CreateMaterialResources( materialID, streamData->skeleton ? true : false, true, 3, streamData->temporaryTextures, true );
+			else
+				materialCollection->CreateMaterialResources( materialID, streamData->skeleton ? true : false, false, 0, streamData->temporaryTextures, true );
+		}
 	}
 
+	return true;
+}
+
+void Model::ReleaseMeshBuffers( size_t meshIndex )
+{
+	if( !streamData || meshIndex >= meshes.size() || meshIndex >= streamData->meshesData.size() )
+		return;
+
+	Mesh* mesh = meshes[meshIndex];
+
+	//Vertices are copied again by CreateMeshBuffers
+	mesh->ReleaseVertices();
+
+	if( !mesh->IsLoaded() )
+		return;
+
+	//Materials used by Mesh Parts
+	std::vector<int> materialsID;
+
+	for( const auto& meshPart : mesh->meshParts )
+		materialsID.push_back( (int)(meshPart.first - materialCollection->materials) );
+
+	mesh->ReleaseBuffers();
+
+	//Release Materials not used anymore
+	for( int materialID : materialsID )
+	{
+		if( materialID < 0 || materialID >= (int)streamData->materialsReferences.size() )
+			continue;
+
+		if( --streamData->materialsReferences[materialID] == 0 )
+			materialCollection->ReleaseMaterialResources( materialID );
+	}
+}
+
+size_t Model::GetMeshBuffersSize( size_t meshIndex ) const
+{
+	if( !streamData || meshIndex >= streamData->meshesData.size() )
+		return 0;
+
+	if( streamData->meshCacheValid )
+		return streamData->meshCache.GetMesh( meshIndex )->BuffersSize();
+
+	return meshIndex < streamData->geometries.size() ? streamData->geometries[meshIndex].View().BuffersSize() : 0;
+}
+
+bool Model::Load( std::string filePath, Model* skeleton_, bool temporaryTextures )
+{
+	if( Read( filePath, skeleton_, temporaryTextures ) )
+		return Create();
+
 	return false;
 }
 
+bool Model::LoadInstance( std::shared_ptr<Model> asset_, Model* skeleton_ )
+{
+	if( asset_ == nullptr || !meshes.empty() )
+		return false;
+
+	//Instance of an instance shares the same Asset
+	if( asset_->asset )
+		asset_ = asset_->asset;
+
+	asset = asset_;
+	version = asset->version;
+	materialCollection = asset->materialCollection;
+	animationsFrameInfo = asset->animationsFrameInfo;
+
+	//Meshes only keep transforms and animation state
+	meshes.reserve( asset->meshes.size() );
+
+	for( const auto& assetMesh : asset->meshes )
+		AddMesh( new Mesh( assetMesh, this ) );
+
+	//Link Objets Parent
+	ReorderMeshes();
+
+	//Set Model Skeleton
+	SetSkeleton( skeleton_ );
+
+	return true;
+}
+
+void Model::SetSkeleton( Model* skeleton_ )
+{
+	skeleton = skeleton_;
+
+	//Create Texture for bones fetch
+	if( skeleton && graphics->useSoftwareSkinning == false && skeleton->bonesWorldMatrices == nullptr )
+	{
+		//Each Skeleton owns your Bones Texture, so every Palette stays on it until Skeleton is animated again
+		skeleton->bonesTexture = graphics->GetTextureFactory()->CreateDynamicTexture( maxPaletteBones* 3, 1, false );
+		skeleton->bonesWorldMatrices = new Math::Matrix4[skeleton->orderedMeshes.size()];
+		skeleton->bonesTransformations = new float[skeleton->orderedMeshes.size()* bonePaletteStride];
+	}
+}
+
+ModelFactory::ModelFactory( Graphics* graphics_ ) : graphics( graphics_ )
+{
+}
+
+ModelFactory::~ModelFactory()
+{
+	cache.clear();
+}
+
+std::shared_ptr<Model> ModelFactory::GetAsset( const std::string& filePath, Model* skeleton )
+{
+	//Skinned Meshes are built against Skeleton Bones, so each Skeleton has its own Asset
+	std::string key = filePath;
+
+	for( auto& c : key )
+		c = (char)tolower( (unsigned char)c );
+
+	if( skeleton )
+		key += "|" + std::to_string( skeleton->GetBonesHash() );
+
+	auto it = cache.find( key );
+
+	if( it != cache.end() )
+		return it->second;
+
+	auto asset = std::make_shared<Model>();
+
+	if( !asset->Load( filePath, skeleton ) )
+	{
+		DELTA3D_LOGERROR( "Could not load Model Asset %s", filePath.c_str() );
+		return nullptr;
+	}
+
+	//Asset isn't rendered, instances are animated with their own Skeleton
+	asset->skeleton = nullptr;
+
+	cache[key] = asset;
+
+	return asset;
+}
+
+std::shared_ptr<Model> ModelFactory::Create( const std::string& filePath, Model* skeleton )
+{
+	auto asset = GetAsset( filePath, skeleton );
+
+	if( asset == nullptr )
+		return nullptr;
+
+	auto model = std::make_shared<Model>();
+
+	if( !model->LoadInstance( asset, skeleton ) )
+		return nullptr;
+
+	return model;
+}
+
+void ModelFactory::Clear()
+{
+	for( auto it = cache.begin(); it != cache.end(); )
+	{
+		//Only referenced by cache
+		if( it->second.use_count() == 1 )
+			it = cache.erase( it );
+		else
+			++it;
+	}
+}
+
 }
\ No newline at end of file
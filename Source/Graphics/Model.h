@@ -7,8 +7,13 @@
 #include "../Math/Vector3.h"
 #include "../Math/Vector2.h"
 
+#include "../IO/SMD/MeshCache.h"
+
 namespace Delta3D::Graphics
 {
+class SkeletonEvaluator;
+class Camera;
+
 enum class ModelVersion
 {
 	SMDModelHeader62,
@@ -21,6 +26,30 @@ struct ModelGroup
 	std::list<Mesh*> meshes;
 };
 
+struct ModelLoadData
+{
+	std::string filePath;	//!< SMD File Path
+	Model* skeleton;	//!< Skeleton Model
+	bool temporaryTextures;	//!< Load Textures on Temporary Cache
+
+	IO::SMD::MeshLoader meshLoader;	//!< Mapped SMD File
+	IO::SMD::MeshCache meshCache;	//!< Mapped Cooked Mesh Cache
+	std::vector<IO::SMD::MeshData> meshesData;	//!< Objects read from SMD File
+	std::vector<IO::SMD::MeshGeometry> geometries;	//!< Welded Geometry (empty when Cooked Mesh Cache is valid)
+
+	unsigned long long sourceHash;	//!< Hash of SMD File
+	unsigned long long skeletonHash;	//!< Hash of Skeleton Bones
+	bool meshCacheValid;	//!< Cooked Mesh Cache is valid
+	bool allObjectsRead;	//!< Every Object was read from SMD File
+
+	bool materialsCreated;	//!< Materials GPU resources already created
+	size_t meshesCreated;	//!< Meshes already created
+
+	std::vector<unsigned int> materialsReferences;	//!< Meshes with Buffers using each Material (streamed Model)
+
+	ModelLoadData() : skeleton( nullptr ), temporaryTextures( false ), sourceHash( 0 ), skeletonHash( 0 ), meshCacheValid( false ), allObjectsRead( true ), materialsCreated( false ), meshesCreated( 0 ) {}
+};
+
 class Model : public GraphicsImpl, public Core::TimerImpl
 {
 public:
@@ -70,6 +99,17 @@ public:
 	 */
 	std::vector<Mesh*> GetMeshes( std::string meshName );
 
+	/**
+	 * Get lowercase key of a Mesh Name used by names dictionaries
+	 * @param name Mesh Name (may not be null terminated)
+	 * @param length Max length of name
+	 * @return Lowercase name
+	 */
+	static std::string GetMeshNameKey( const char* name, size_t length );
+
+	//! Get a Hash from Ordered Meshes Names (Skinned Meshes are cooked against it).
+	unsigned long long GetBonesHash() const;
+
 	/**
 	 * Set an Animation Frame for Model
 	 * @param frame_ Frame desired of Animation
@@ -77,6 +117,13 @@ public:
 	 */
 	void SetFrame( int frame_, IO::SMD::FrameInfo* frameInfo = nullptr );
 
+	/**
+	 * Set blended Animation Frames for Model (cross-fade between Animations)
+	 * @param layers Animation Frames and Weights
+	 * @param layersCount Layers Count (up to maxAnimationLayers)
+	 */
+	void SetFrameBlend( const AnimationLayer* layers, int layersCount );
+
 	/**
 	 * Animate Model
 	 * @param frame_ Frame desired to make Animation
@@ -85,6 +132,14 @@ public:
 	 */
 	void Animate( int frame_ = 0, Math::Vector3Int rotation_ = Math::Vector3Int::Null, IO::SMD::FrameInfo* frameInfo = nullptr );
 
+	/**
+	 * Animate Model blending Animations (blended Poses aren't cached)
+	 * @param layers Animation Frames and Weights
+	 * @param layersCount Layers Count (up to maxAnimationLayers)
+	 * @param rotation_ Rotation to Model
+	 */
+	void AnimateBlend( const AnimationLayer* layers, int layersCount, Math::Vector3Int rotation_ = Math::Vector3Int::Null );
+
 	/**
 	 * Set a Position and Rotation for Model
 	 * @param position_ Position desired
@@ -104,6 +159,27 @@ public:
 	 */
 	static void SetCustomMaterialCollection( std::function<void( MaterialCollection* )> const& materialCollection ) { customMaterialCollection = materialCollection; }
 
+	/**
+	 * Set if Models will use Cooked Mesh Cache (<file>c next to SMD File)
+	 * @param value Boolean
+	 */
+	static void SetUseMeshCache( bool value ) { useMeshCache = value; }
+
+	/**
+	 * Set if Models are animated by a Skeleton Evaluator (every Bone at once) instead of Mesh by Mesh
+	 * @param value Boolean
+	 */
+	static void SetUseSkeletonEvaluator( bool value ) { useSkeletonEvaluator = value; }
+
+	/**
+	 * Set how Bones influencing a Vertex are blended (Dual Quaternions are used by Software Skinning only, Effects always blend Matrices)
+	 * @param mode Skinning Mode
+	 */
+	static void SetSkinningMode( SkinningMode mode ) { skinningMode = mode; }
+
+	//! Get Skinning Mode.
+	static SkinningMode GetSkinningMode() { return skinningMode; }
+
 	/**
 	 * Update Bounding Volumes from Model
 	 * @param force Force to Update Bounding Volumes
@@ -115,6 +191,25 @@ public:
 	 */
 	void UpdateBonesTransformations();
 
+	//! Get World Matrices of Bones with Y and Z flipped, used by Software Skinning (built once per Pose).
+	const Math::Matrix4* GetSkinningMatrices();
+
+	//! Get Dual Quaternions of Bones World Matrices, used by Software Skinning on Dual Quaternion mode (built once per Pose, nullptr if a Bone is sheared so Matrices are blended).
+	const BoneDualQuaternion* GetSkinningDualQuaternions();
+
+	//! Upload Bones Transformations to Bones Texture (deferred while Animator workers animate Model, Animator uploads it after).
+	void UploadBonesTexture();
+
+	//! Copy World Matrices of Skeleton Bones to Skinned Meshes.
+	void UpdateMeshesWorld();
+
+	/**
+	 * Check if Model is outside of Camera Frustum (Models drawn by Custom Renderer are never culled)
+	 * @param camera Camera
+	 * @return True if Model isn't visible
+	 */
+	bool IsCulled( Camera* camera ) const;
+
 	/**
 	 * Set if Model will use Frustum Culling
 	 * @param value Boolean
@@ -140,12 +235,79 @@ public:
 	//! Render Model.
 	bool Render( IO::SMD::FrameInfo* frameInfo = nullptr, ModelGroup* modelGroup = nullptr );
 
+	/**
+	 * Read Model from SMD File, Materials and Meshes are decoded but no GPU resources are created (safe on worker threads)
+	 * @param filePath SMD File Path
+	 * @param skeleton_ Skeleton Model (if Skinned Model, must be already loaded)
+	 * @param temporaryTextures Load Textures on Temporary Cache
+	 * @return True if SMD File was read
+	 */
+	bool Read( const std::string& filePath, Model* skeleton_ = nullptr, bool temporaryTextures = false );
+
+	/**
+	 * Create GPU resources of Model read by Read (device thread)
+	 * @param meshesCount Max number of Meshes created by this call (0 to create all of them)
+	 * @return False if there is nothing read to create, check IsLoading to know if there are Meshes left
+	 */
+	bool Create( unsigned int meshesCount = 0 );
+
+	//! Check if Model was read and still has GPU resources to be created.
+	bool IsLoading() const { return loadData != nullptr; }
+
+	/**
+	 * Set if Mesh Buffers and Materials will be created on demand by CreateMeshBuffers (must be set before Read)
+	 * @param value Boolean
+	 */
+	void SetStreamMeshes( bool value ) { streamMeshes = value; }
+
+	//! Check if Model was loaded with streamed Meshes.
+	bool IsStreamed() const { return streamData != nullptr; }
+
+	/**
+	 * Touch mapped Vertices and Geometry of a streamed Mesh, so page faults happen on the calling thread (safe on worker threads)
+	 * @param meshIndex Index of Mesh
+	 */
+	void PrefetchMeshBuffers( size_t meshIndex ) const;
+
+	/**
+	 * Create Buffers, Vertices and Materials of a streamed Mesh (device thread)
+	 * @param meshIndex Index of Mesh
+	 * @return True if Mesh has Buffers
+	 */
+	bool CreateMeshBuffers( size_t meshIndex );
+
+	/**
+	 * Release Buffers and Vertices of a streamed Mesh, Materials and Textures not used anymore are released too
+	 * @param meshIndex Index of Mesh
+	 */
+	void ReleaseMeshBuffers( size_t meshIndex );
+
+	//! Get size in bytes of Buffers of a streamed Mesh.
+	size_t GetMeshBuffersSize( size_t meshIndex ) const;
+
 	//! Load Model.
 	bool Load( std::string filePath, Model* skeleton_ = nullptr, bool temporaryTextures = false );
+
+	/**
+	 * Load Model as an instance of a loaded Asset, Meshes share Geometry, Keyframes, Buffers and Materials with it
+	 * @param asset_ Asset Model (kept alive by this instance)
+	 * @param skeleton_ Skeleton Model (if Skinned Model, with same Bones of Asset Skeleton)
+	 * @return True if instance was created
+	 */
+	bool LoadInstance( std::shared_ptr<Model> asset_, Model* skeleton_ = nullptr );
+
+	//! Check if Model is an instance of a shared Asset.
+	bool IsInstance() const { return asset != nullptr; }
+private:
+	//! Set Skeleton and create Texture used to fetch Bones.
+	void SetSkeleton( Model* skeleton_ );
 public:
 	std::vector<Mesh*> meshes;	//!< Meshes List
 	std::vector<Mesh*> orderedMeshes;	//!< Ordered Meshes List
 
+	std::unordered_map<std::string, int> meshesIndex;	//!< Index of first Mesh by lowercase name
+	std::unordered_map<std::string, int> orderedMeshesIndex;	//!< Index of first Ordered Mesh by lowercase name (built by ReorderMeshes)
+
 	Model* skeleton;	//!< Skeleton Model (if exists, skinned model)
 	MaterialCollection* materialCollection;	//!< Materials used by Model
 
@@ -172,10 +334,78 @@ public:
 	std::shared_ptr<Texture> bonesTexture;	//!< Bones Texture Fetch
 	Math::Matrix4* bonesWorldMatrices;	//!< World Matrices from Bones
 	float* bonesTransformations;
+	bool deferBonesUpload;	//!< Bones Texture isn't uploaded by Animator workers (Animator uploads it on device thread)
+	bool bonesTextureDirty;	//!< Bones Transformations weren't uploaded yet
+
+	unsigned int animatorPhase;	//!< Animator Phase which animated Model (Render doesn't animate it again on same Pose)
+	unsigned int animatorPushPhase;	//!< Animator Phase when Model was last pushed by Render (pushed once per frame)
+	int animatorFrame;	//!< Frame of Pose evaluated by Animator for Model
+	Math::Vector3Int animatorRotation;	//!< Rotation of Pose evaluated by Animator for Model
+	IO::SMD::FrameInfo animatorFrameInfo;	//!< Frame Info of Pose evaluated by Animator for Model ({ -1, -1 } if none)
+	unsigned int animatorPoseVersion;	//!< Pose Version of Skeleton right after Animator evaluated it
+	IO::SMD::FrameInfo renderFrameInfo;	//!< Frame Info of last Render, Animator evaluates next frame with it ({ -1, -1 } if none)
+	unsigned int frameBlendPhase;	//!< Animator Phase following last SetFrameBlend (that Run leaves Model to SetFrameBlend)
+
+	unsigned int poseVersion;	//!< Incremented every time Bones are animated
+	std::vector<Math::Matrix4> skinningMatrices;	//!< Flipped World Matrices of Bones (Software Skinning)
+	unsigned int skinningMatricesVersion;	//!< Pose Version of Skinning Matrices
+	std::vector<BoneDualQuaternion> skinningDualQuaternions;	//!< Dual Quaternions of Bones (Software Skinning)
+	unsigned int skinningDualQuaternionsVersion;	//!< Pose Version of Skinning Dual Quaternions
+	bool skinningDualQuaternionsValid;	//!< Every Bone could be held by a Dual Quaternion on that Pose
 
 	ModelVersion version;	//!< Model Version
 
+	std::unique_ptr<ModelLoadData> loadData;	//!< Data read and not created yet
+	std::unique_ptr<ModelLoadData> streamData;	//!< Data kept to create Mesh Buffers on demand (streamed Model)
+	bool streamMeshes;	//!< Flag to determinate if Mesh Buffers are created on demand
+
+	std::shared_ptr<Model> asset;	//!< Asset Model shared by instances (nullptr if not an instance)
+	std::unique_ptr<SkeletonEvaluator> skeletonEvaluator;	//!< Evaluator of Ordered Meshes (built on first Animate)
+	bool useInstanceDiffuseColor;	//!< Flag to determinate if instance Diffuse Color is applied to shared Materials
+	bool useInstanceAddColor;	//!< Flag to determinate if instance Add Color is applied to shared Materials
+	Math::Color instanceDiffuseColor;	//!< Instance Diffuse Color
+	Math::Color instanceAddColor;	//!< Instance Add Color
+
 	static std::function<void( Mesh* )> customRenderer;	//!< Define a custom renderer for Model
 	static std::function<void( MaterialCollection* )> customMaterialCollection;	//!< Define a custom material collection for Model
+	static bool useMeshCache;	//!< Load and write Cooked Mesh Cache
+	static bool useSkeletonEvaluator;	//!< Animate Ordered Meshes with Skeleton Evaluator
+	static SkinningMode skinningMode;	//!< Blending of Bones influencing a Vertex
+};
+
+class ModelFactory
+{
+public:
+	//! Default Constructor for Model Factory.
+	ModelFactory( Graphics* graphics_ );
+
+	//! Deconstructor.
+	~ModelFactory();
+
+	/**
+	 * Get a shared Asset from cache, loading it on first use (device thread)
+	 * @param filePath SMD File Path
+	 * @param skeleton Skeleton Model (if Skinned Model)
+	 * @return Asset Model or nullptr if it couldn't be loaded
+	 */
+	std::shared_ptr<Model> GetAsset( const std::string& filePath, Model* skeleton = nullptr );
+
+	/**
+	 * Create a Model instance of a shared Asset (only Meshes transforms and animation state are allocated)
+	 * @param filePath SMD File Path
+	 * @param skeleton Skeleton Model (if Skinned Model)
+	 * @return Model instance or nullptr if Asset couldn't be loaded
+	 */
+	std::shared_ptr<Model> Create( const std::string& filePath, Model* skeleton = nullptr );
+
+	//! Release Assets not used by any instance.
+	void Clear();
+
+	//! Get number of cached Assets.
+	size_t GetAssetsCount() const { return cache.size(); }
+private:
+	std::unordered_map<std::string, std::shared_ptr<Model>> cache;	//!< Cache of Assets (by File Path and Skeleton Bones)
+
+	Graphics* graphics;	//!< Graphics Pointer
 };
 }
\ No newline at end of file
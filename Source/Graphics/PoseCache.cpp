@@ -0,0 +1,216 @@
+#include "PrecompiledHeader.h"
+#include "PoseCache.h"
+
+#include "Model.h"
+#include "Texture.h"
+
+namespace Delta3D::Graphics
+{
+size_t PoseKeyHash::operator()( const PoseKey& key ) const
+{
+	size_t hash = std::hash<const Model*>()( key.skeleton );
+
+	auto Combine = [&hash]( size_t value ) { hash ^= value + 0x9E3779B9 + (hash << 6) + (hash >> 2); };
+
+	Combine( std::hash<int>()( key.frame ) );
+	Combine( std::hash<int>()( key.rotation.x ) );
+	Combine( std::hash<int>()( key.rotation.y ) );
+	Combine( std::hash<int>()( key.rotation.z ) );
+	Combine( std::hash<float>()( key.scaling.x ) );
+	Combine( std::hash<float>()( key.scaling.y ) );
+	Combine( std::hash<float>()( key.scaling.z ) );
+
+	return hash;
+}
+
+const Pose* PoseCache::Find( const PoseKey& key )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	auto it = poses.find( key );
+
+	if( it == poses.end() )
+	{
+		misses++;
+		return nullptr;
+	}
+
+	hits++;
+	it->second->lastUsedFrame = frameCount;
+
+	return it->second.get();
+}
+
+const Pose* PoseCache::Store( const PoseKey& key, const Model* skeleton )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	//Cache is full, Poses used least recently are released (Poses used on this frame are kept)
+	if( poses.size() >= maxPoses && poses.find( key ) == poses.end() )
+	{
+		unsigned int oldestFrame = frameCount;
+
+		for( const auto& pose : poses )
+			if( frameCount - pose.second->lastUsedFrame > frameCount - oldestFrame )
+				oldestFrame = pose.second->lastUsedFrame;
+
+		if( oldestFrame == frameCount )
+		{
+			//Skeleton just uploaded a Pose not cached
+			uploadedTexture = skeleton->bonesTexture.get();
+			uploadedPose = nullptr;
+
+			return nullptr;
+		}
+
+		for( auto it = poses.begin(); it != poses.end(); )
+		{
+			if( it->second->lastUsedFrame == oldestFrame )
+			{
+				if( uploadedPose == it->second.get() )
+					uploadedPose = nullptr;
+
+				it = poses.erase( it );
+			}
+			else
+				++it;
+		}
+	}
+
+	auto& pose = poses[key];
+
+	if( pose == nullptr )
+		pose = std::make_unique<Pose>();
+
+	const auto& bones = skeleton->orderedMeshes;
+
+	pose->resultAnimations.resize( bones.size() );
+	pose->worlds.resize( bones.size() );
+	pose->locals.resize( bones.size() );
+
+	for( size_t i = 0; i < bones.size(); i++ )
+	{
+		pose->resultAnimations[i] = bones[i]->resultAnimation;
+		pose->worlds[i] = bones[i]->world;
+		pose->locals[i] = bones[i]->local;
+	}
+
+	if( skeleton->bonesTransformations )
+		pose->palette.assign( skeleton->bonesTransformations, skeleton->bonesTransformations + bones.size()* bonePaletteStride );
+	else
+		pose->palette.clear();
+
+	pose->lastUsedFrame = frameCount;
+
+	//Skeleton just uploaded this Pose
+	uploadedTexture = skeleton->bonesTexture.get();
+	uploadedPose = pose.get();
+
+	return pose.get();
+}
+
+bool PoseCache::Apply( const PoseKey& key, Model* skeleton )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	auto it = poses.find( key );
+
+	if( it == poses.end() )
+	{
+		misses++;
+		return false;
+	}
+
+	hits++;
+	it->second->lastUsedFrame = frameCount;
+
+	const Pose* pose = it->second.get();
+	auto& bones = skeleton->orderedMeshes;
+
+	if( pose->worlds.size() != bones.size() )
+		return false;
+
+	for( size_t i = 0; i < bones.size(); i++ )
+	{
+		bones[i]->resultAnimation = pose->resultAnimations[i];
+		bones[i]->world = pose->worlds[i];
+		bones[i]->local = pose->locals[i];
+	}
+
+	if( skeleton->bonesWorldMatrices )
+		memcpy( skeleton->bonesWorldMatrices, pose->worlds.data(), pose->worlds.size()* sizeof( Math::Matrix4 ) );
+
+	if( skeleton->bonesTransformations && pose->palette.size() == bones.size()* bonePaletteStride )
+	{
+		memcpy( skeleton->bonesTransformations, pose->palette.data(), pose->palette.size()* sizeof( float ) );
+
+		//Upload only if Bones Texture holds another Pose
+		if( skeleton->bonesTexture && (uploadedTexture != skeleton->bonesTexture.get() || uploadedPose != pose) )
+		{
+			skeleton->UploadBonesTexture();
+
+			uploadedTexture = skeleton->bonesTexture.get();
+			uploadedPose = pose;
+		}
+	}
+
+	return true;
+}
+
+void PoseCache::ResetUploadedPose( const Texture* texture )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	if( uploadedTexture == texture )
+	{
+		uploadedTexture = nullptr;
+		uploadedPose = nullptr;
+	}
+}
+
+void PoseCache::Remove( const Model* skeleton )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	for( auto it = poses.begin(); it != poses.end(); )
+	{
+		if( it->first.skeleton == skeleton )
+		{
+			if( uploadedPose == it->second.get() )
+				uploadedPose = nullptr;
+
+			it = poses.erase( it );
+		}
+		else
+			++it;
+	}
+}
+
+void PoseCache::Update()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	frameCount++;
+
+	for( auto it = poses.begin(); it != poses.end(); )
+	{
+		if( frameCount - it->second->lastUsedFrame > maxPoseAge )
+		{
+			if( uploadedPose == it->second.get() )
+				uploadedPose = nullptr;
+
+			it = poses.erase( it );
+		}
+		else
+			++it;
+	}
+}
+
+void PoseCache::Clear()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	poses.clear();
+	uploadedPose = nullptr;
+}
+}
\ No newline at end of file
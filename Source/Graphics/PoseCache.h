@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../Math/Vector3.h"
+#include "../Math/Matrix4.h"
+
+namespace Delta3D::Graphics
+{
+class Model;
+class Texture;
+
+const size_t maxPosesCacheDefault = 1024;
+const unsigned int maxPoseAgeDefault = 8;
+
+struct PoseKey
+{
+	const Model* skeleton;	//!< Skeleton Asset (shared by its instances)
+	int frame;	//!< Animation Frame
+	Math::Vector3Int rotation;	//!< Model Rotation
+	Math::Vector3 scaling;	//!< Model Scaling
+
+	bool operator==( const PoseKey& other ) const
+	{
+		return skeleton == other.skeleton && frame == other.frame && rotation == other.rotation && !(scaling != other.scaling);
+	}
+};
+
+struct PoseKeyHash
+{
+	size_t operator()( const PoseKey& key ) const;
+};
+
+struct Pose
+{
+	std::vector<Math::Matrix4> resultAnimations;	//!< Animation Matrix of each Bone
+	std::vector<Math::Matrix4> worlds;	//!< World Matrix of each Bone
+	std::vector<Math::Matrix4> locals;	//!< Local Matrix of each Bone
+	std::vector<float> palette;	//!< Bones Transformations packed as 3x4 (Bones Texture data)
+	unsigned int lastUsedFrame;	//!< Last Frame this Pose was used
+};
+
+class PoseCache
+{
+public:
+	//! Default Constructor for Pose Cache.
+	PoseCache() : frameCount( 0 ), hits( 0 ), misses( 0 ), maxPoses( maxPosesCacheDefault ), maxPoseAge( maxPoseAgeDefault ), uploadedTexture( nullptr ), uploadedPose( nullptr ) {}
+
+	//! Deconstructor.
+	~PoseCache() = default;
+
+	/**
+	 * Find an evaluated Pose
+	 * @param key Pose Key
+	 * @return Pointer to Pose or nullptr if it wasn't evaluated yet
+	 */
+	const Pose* Find( const PoseKey& key );
+
+	/**
+	 * Store Pose evaluated by a Skeleton (Poses used least recently are released if Cache is full)
+	 * @param key Pose Key
+	 * @param skeleton Skeleton Model just animated
+	 * @return Pointer to Pose stored (nullptr if every cached Pose was used on this frame)
+	 */
+	const Pose* Store( const PoseKey& key, const Model* skeleton );
+
+	/**
+	 * Find a Pose and apply it to a Skeleton, Bones Texture is uploaded only if it doesn't hold that Pose already
+	 * Pose can't be released by other threads while it's applied (Skeletons are animated by Animator workers)
+	 * @param key Pose Key
+	 * @param skeleton Skeleton Model instance
+	 * @return True if Pose was found and applied
+	 */
+	bool Apply( const PoseKey& key, Model* skeleton );
+
+	//! Forget Pose held by a Bones Texture (it was written with a Pose not cached).
+	void ResetUploadedPose( const Texture* texture );
+
+	//! Remove every Pose of a Skeleton Asset (Skeleton is being deleted).
+	void Remove( const Model* skeleton );
+
+	//! Advance Frame and release Poses not used recently (once per frame).
+	void Update();
+
+	//! Clear Cache.
+	void Clear();
+
+	//! Set max number of cached Poses.
+	void SetMaxPoses( size_t maxPoses_ ) { maxPoses = maxPoses_; }
+
+	//! Set number of frames a Pose is kept without being used.
+	void SetMaxPoseAge( unsigned int maxPoseAge_ ) { maxPoseAge = maxPoseAge_; }
+
+	//! Get number of cached Poses.
+	size_t GetPosesCount() const { return poses.size(); }
+
+	//! Get hits count.
+	unsigned long long GetHits() const { return hits; }
+
+	//! Get misses count.
+	unsigned long long GetMisses() const { return misses; }
+
+	//! Get hit rate (0 to 1).
+	float GetHitRate() const { return hits + misses ? (float)hits / (float)(hits + misses) : 0.0f; }
+
+	//! Reset hits and misses counters.
+	void ResetStatistics() { hits = 0; misses = 0; }
+private:
+	std::unordered_map<PoseKey, std::unique_ptr<Pose>, PoseKeyHash> poses;	//!< Evaluated Poses
+	std::mutex mutex;	//!< Mutex for Poses and counters
+
+	unsigned int frameCount;	//!< Frames Counter
+	unsigned long long hits;	//!< Poses found
+	unsigned long long misses;	//!< Poses not found
+	size_t maxPoses;	//!< Max number of cached Poses
+	unsigned int maxPoseAge;	//!< Frames a Pose is kept without being used
+
+	const Texture* uploadedTexture;	//!< Bones Texture last uploaded by Apply
+	const Pose* uploadedPose;	//!< Pose last uploaded to Bones Texture
+};
+}
\ No newline at end of file
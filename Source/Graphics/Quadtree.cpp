@@ -140,6 +140,10 @@ void Quadtree::Render( Node* node )
 		if( node->nodes[i] )
 			Render( node->nodes[i] );
 
+	//Node Meshes still streaming
+	if( !node->loaded )
+		return;
+
 	for( const auto& mesh : node->meshes )
 	{
 		//Post Render Meshes
@@ -11,10 +11,13 @@ class Mesh;
 
 struct Node
 {
+	Node() : parentNode( nullptr ), nodes{ nullptr }, loaded( true ) {}
+
 	Node* parentNode;
 	Math::BoundingBox boundingBox;
 	std::list<Mesh*> meshes;
 	std::array<Node*, 4> nodes;
+	bool loaded;	//!< Flag to determinate if Node Meshes can be rendered (streamed Terrain)
 };
 
 struct SortMeshJob
@@ -51,6 +54,12 @@ public:
 	void Render();
 
 	void Clean() { DeleteNodes( root ); delete root; root = nullptr; }
+
+	//! Get Root Node.
+	Node* GetRoot() const { return root; }
+
+	//! Get Translation Transform applied to Nodes Bounding Boxes.
+	const Math::Matrix4& GetTranslation() const { return translation; }
 private:
 	//! Render QuadTree Node.
 	void Render( Node* node );
@@ -3,6 +3,7 @@
 
 #include "MeshPart.h"
 #include "Mesh.h"
+#include "Animator.h"
 
 namespace Delta3D::Graphics
 {
@@ -141,6 +142,9 @@ void Renderer::Run()
 {
 	if( Begin() )
 	{
+		//Animate Models pushed to Animator before anything is rendered
+		graphics->GetAnimator()->Run( GetCamera(), graphics->useSoftwareSkinning );
+
 		//Render reflection Map?
 		if( renderReflectionMap )
 			RenderReflectionMap();
@@ -1,6 +1,9 @@
 #include "PrecompiledHeader.h"
 #include "Shader.h"
 
+#include "../IO/FileSystem.h"
+#include "../IO/Hash.h"
+
 namespace Delta3D::Graphics
 {
 
@@ -12,6 +15,44 @@ const std::map<std::string,int> DefinesValue = { {"SELFILLUMINATIONMAP", 1 << 0
 												 {"SHADOWS", 1 << 5 },
 											   };
 
+//Effects included by Effects are read through File System too
+class ShaderInclude : public ID3DXInclude
+{
+public:
+	//! Constructor with directory of including Effect.
+	ShaderInclude( const std::string& directory_ ) : directory( directory_ ) {}
+
+	STDMETHOD( Open )( D3DXINCLUDE_TYPE includeType, LPCSTR fileName, LPCVOID parentData, LPCVOID* data, UINT* bytes ) override
+	{
+		std::vector<char> buffer;
+
+		if( !IO::FileSystem::Get()->Read( directory + fileName, buffer ) && !IO::FileSystem::Get()->Read( fileName, buffer ) )
+			return E_FAIL;
+
+		char* includeData = new char[buffer.size()];
+		memcpy( includeData, buffer.data(), buffer.size() );
+
+		*data = includeData;
+		*bytes = (UINT)buffer.size();
+
+		return S_OK;
+	}
+
+	STDMETHOD( Close )( LPCVOID data ) override
+	{
+		delete[] (const char*)data;
+
+		return S_OK;
+	}
+private:
+	std::string directory;	//!< Directory of including Effect
+};
+
+size_t ShaderKeyHash::operator()( const ShaderKey& key ) const
+{
+	return (size_t)(key.pathHash ^ (key.definesHash* 31) ^ ((unsigned long long)key.definesMask << 32));
+}
+
 Shader::Shader( LPD3DXEFFECT effect_, const std::string& filePath_ ) : effect( effect_ ), filePath( filePath_ )
 {
 	if( effect )
@@ -140,6 +181,11 @@ void Shader::SetTexture( const std::string& variable, IDirect3DTexture9* texture
 		DELTA3D_LOGERROR( "Could not Get parameter from Effect (%s)", variable.c_str() );
 }
 
+bool Shader::HasParameter( const std::string& variable )
+{
+	return effect && effect->GetParameterByName( 0, variable.c_str() ) != nullptr;
+}
+
 bool Shader::BeginPass( unsigned int pass )
 {
 	HRESULT hr;
@@ -168,6 +214,32 @@ void Shader::End()
 	effect->End();
 }
 
+void Shader::SetDefines( const std::vector<ShaderDefine>& defines )
+{
+	effectDefines.clear();
+	definesStrings.clear();
+
+	//Reserved, so strings aren't moved while pointers are taken
+	definesStrings.reserve( defines.size()* 2 );
+
+	for( const auto& define : defines )
+	{
+		if( define.name == nullptr )
+		{
+			effectDefines.push_back( ShaderDefine{ nullptr, nullptr } );
+			continue;
+		}
+
+		definesStrings.push_back( define.name );
+		const char* name = definesStrings.back().c_str();
+
+		definesStrings.push_back( define.value ? define.value : "" );
+		const char* value = definesStrings.back().c_str();
+
+		effectDefines.push_back( ShaderDefine{ name, value } );
+	}
+}
+
 void Shader::Renew( ID3DXEffect* effect_ )
 {
 	if( effect )
@@ -185,13 +257,13 @@ ShaderFactory::ShaderFactory( Graphics* graphics_ ) : graphics( graphics_ )
 void ShaderFactory::OnLostDevice()
 {
 	for( const auto& effect : cache )
-		effect->OnLostDevice();
+		effect.second->OnLostDevice();
 }
 
 void ShaderFactory::OnResetDevice()
 {
 	for( const auto& effect : cache )
-		effect->OnResetDevice();
+		effect.second->OnResetDevice();
 }
 
 void ShaderFactory::Reload()
@@ -200,11 +272,14 @@ void ShaderFactory::Reload()
 	for( auto& effect : cache )
 	{
 		//Create Effect
-		ID3DXEffect* effectd3d = CreateShader( effect->FilePath(), effect->Defines() );
+		ID3DXEffect* effectd3d = CreateShader( effect.second->FilePath(), effect.second->Defines(), effect.first );
 
 		//Renew Effect
-		effect->Renew( effectd3d );
-		effectd3d->Release();
+		if( effectd3d )
+		{
+			effect.second->Renew( effectd3d );
+			effectd3d->Release();
+		}
 	}
 }
 
@@ -214,22 +289,24 @@ std::shared_ptr<Shader> ShaderFactory::Create( const std::string& filePath, std:
 	if( !defines.empty() )
 		defines.push_back( ShaderDefine{ nullptr, nullptr } );
 
+	ShaderKey key = GetKey( filePath, defines );
+
 	//Find effect on Cache
-	for( const auto& effect : cache )
-		if( _strcmpi( effect->FilePath().c_str(), filePath.c_str() ) == 0 && effect->Defines() == defines )
-			return effect;
+	auto it = cache.find( key );
+	if( it != cache.end() )
+		return (*it).second;
 
 	//Create Effect
-	ID3DXEffect* effectd3d = CreateShader( filePath, defines );
+	ID3DXEffect* effectd3d = CreateShader( filePath, defines, key );
 
 	if( effectd3d )
 	{
 		auto effect = std::make_shared<Shader>( effectd3d, filePath );
 
-		effect->effectDefines = defines;
+		effect->SetDefines( defines );
 
 		//Put it on Cache
-		cache.push_back( effect );
+		cache[key] = effect;
 
 		//Release our Reference
 		effectd3d->Release();
@@ -240,42 +317,237 @@ std::shared_ptr<Shader> ShaderFactory::Create( const std::string& filePath, std:
 	return nullptr;
 }
 
-ID3DXEffect* ShaderFactory::CreateShader( const std::string& filePath, std::vector<ShaderDefine> defines )
+bool ShaderFactory::Read( const std::string& filePath, std::vector<ShaderDefine> defines, std::vector<char>& compiled )
 {
+	//Defines List Tail
+	if( !defines.empty() )
+		defines.push_back( ShaderDefine{ nullptr, nullptr } );
+
+	return GetCompiledShader( filePath, defines, GetKey( filePath, defines ), compiled );
+}
+
+std::shared_ptr<Shader> ShaderFactory::Create( const std::string& filePath, std::vector<ShaderDefine> defines, const std::vector<char>& compiled )
+{
+	//Defines List Tail
+	if( !defines.empty() )
+		defines.push_back( ShaderDefine{ nullptr, nullptr } );
+
+	ShaderKey key = GetKey( filePath, defines );
+
+	//Permutation created since it was read
+	auto it = cache.find( key );
+	if( it != cache.end() )
+		return (*it).second;
+
+	if( compiled.empty() )
+		return nullptr;
+
 	DWORD flags = 0;
 
 #ifdef DEBUG
 	flags |= D3DXSHADER_DEBUG;
 #endif
 
-	ID3DXEffect* effectd3d;
-	ID3DXBuffer* errorBuffer;
+	ID3DXEffect* effectd3d = nullptr;
+	ID3DXBuffer* errorBuffer = nullptr;
 
-	//Compiled Effect?
-	if( filesystem::exists( filePath + "c" ) )
+	if( FAILED( D3DXCreateEffect( graphics->GetDevice(), compiled.data(), (UINT)compiled.size(), nullptr, nullptr, flags, nullptr, &effectd3d, &errorBuffer ) ) )
 	{
-		std::string compiledFilePath = filePath.substr( 0, filePath.find_last_of(".") );
+		DELTA3D_LOGERROR( "Could not create Compiled Effect (%s): %s", filePath.c_str(), errorBuffer ? errorBuffer->GetBufferPointer() : "Unknown Reason" );
+
+		if( errorBuffer )
+			errorBuffer->Release();
+
+		return nullptr;
+	}
+
+	if( errorBuffer )
+		errorBuffer->Release();
+
+	auto effect = std::make_shared<Shader>( effectd3d, filePath );
+
+	effect->SetDefines( defines );
+
+	//Put it on Cache
+	cache[key] = effect;
+
+	//Release our Reference
+	effectd3d->Release();
+
+	return effect;
+}
+
+bool ShaderFactory::LoadBundle( const std::string& filePath )
+{
+	bundleData.clear();
+	bundleEntries.clear();
+
+	//Whole Bundle is read at once
+	if( !IO::FileSystem::Get()->Read( filePath, bundleData ) )
+		return false;
 
-		unsigned int definesValue = 0;
+	const ShaderBundleHeader* header = (const ShaderBundleHeader*)bundleData.data();
 
-		for( const auto& define : defines )
+	if( bundleData.size() < sizeof( ShaderBundleHeader ) || memcmp( header->magic, ShaderBundleMagic, sizeof( ShaderBundleMagic ) ) != 0 || header->version != ShaderBundleVersion ||
+		header->entriesCount > (bundleData.size() - sizeof( ShaderBundleHeader )) / sizeof( ShaderBundleEntry ) )
+	{
+		DELTA3D_LOGERROR( "Invalid Shader Bundle Header on %s", filePath.c_str() );
+
+		bundleData.clear();
+		return false;
+	}
+
+	const ShaderBundleEntry* entries = (const ShaderBundleEntry*)(bundleData.data() + sizeof( ShaderBundleHeader ));
+
+	for( unsigned int i = 0; i < header->entriesCount; i++ )
+	{
+		const ShaderBundleEntry& entry = entries[i];
+
+		if( entry.offset > bundleData.size() || entry.size > bundleData.size() - entry.offset )
 		{
-			if( define.name )
-			{
-				auto it = DefinesValue.find( define.name );
+			DELTA3D_LOGERROR( "Invalid Shader Bundle Entry on %s", filePath.c_str() );
 
-				if( it != DefinesValue.end() )
-					definesValue |= ( *it ).second;
-			}
+			bundleData.clear();
+			bundleEntries.clear();
+			return false;
 		}
 
-		if( definesValue > 0 )
-			compiledFilePath += std::to_string( definesValue );
+		bundleEntries[ShaderKey{ entry.pathHash, entry.definesMask, 0 }] = std::make_pair( (size_t)entry.offset, (size_t)entry.size );
+	}
+
+	DELTA3D_LOGINFO( "Loaded Shader Bundle %s (%d effects)", filePath.c_str(), (int)bundleEntries.size() );
+
+	return true;
+}
+
+bool ShaderFactory::SaveBundle( const std::string& filePath )
+{
+	std::vector<ShaderBundleEntry> entries;
+	std::vector<std::vector<char>> compiledShaders;
 
-		compiledFilePath += ".fxc";
+	for( const auto& effect : cache )
+	{
+		//Only permutations named by DefinesValue bits can be found on Bundle
+		if( effect.first.definesHash != 0 )
+			continue;
+
+		std::vector<char> compiled;
+
+		if( !GetCompiledShader( effect.second->FilePath(), effect.second->Defines(), effect.first, compiled ) )
+			continue;
+
+		ShaderBundleEntry entry;
+		entry.pathHash = effect.first.pathHash;
+		entry.definesMask = effect.first.definesMask;
+		entry.size = (unsigned int)compiled.size();
+		entry.offset = 0;
+
+		entries.push_back( entry );
+		compiledShaders.push_back( std::move( compiled ) );
+	}
+
+	//Compiled Effects after Entries
+	unsigned long long offset = sizeof( ShaderBundleHeader ) + entries.size()* sizeof( ShaderBundleEntry );
+
+	for( auto& entry : entries )
+	{
+		entry.offset = offset;
+		offset += entry.size;
+	}
+
+	std::ofstream file( filePath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+
+	if( !file.is_open() )
+	{
+		DELTA3D_LOGERROR( "Could not create Shader Bundle %s", filePath.c_str() );
+		return false;
+	}
+
+	ShaderBundleHeader header;
+	memcpy( header.magic, ShaderBundleMagic, sizeof( ShaderBundleMagic ) );
+	header.version = ShaderBundleVersion;
+	header.entriesCount = (unsigned int)entries.size();
+	header.reserved = 0;
+
+	file.write( (const char*)&header, sizeof( ShaderBundleHeader ) );
+	file.write( (const char*)entries.data(), entries.size()* sizeof( ShaderBundleEntry ) );
+
+	for( const auto& compiled : compiledShaders )
+		file.write( compiled.data(), compiled.size() );
+
+	if( !file.good() )
+	{
+		DELTA3D_LOGERROR( "Could not write Shader Bundle %s", filePath.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+ShaderKey ShaderFactory::GetKey( const std::string& filePath, const std::vector<ShaderDefine>& defines )
+{
+	std::string normalizedPath = IO::FileSystem::NormalizePath( filePath );
+
+	ShaderKey key;
+	key.pathHash = IO::Hash64( normalizedPath.data(), normalizedPath.length() );
+	key.definesMask = 0;
+	key.definesHash = 0;
+
+	for( const auto& define : defines )
+	{
+		if( define.name == nullptr )
+			continue;
+
+		auto it = DefinesValue.find( define.name );
+
+		if( it != DefinesValue.end() )
+			key.definesMask |= (*it).second;
+		else
+		{
+			//Defines unknown by DefinesValue make a different permutation too
+			key.definesHash = IO::Hash64( define.name, strlen( define.name ), key.definesHash + 1 );
+
+			if( define.value )
+				key.definesHash = IO::Hash64( define.value, strlen( define.value ), key.definesHash );
+		}
+	}
+
+	return key;
+}
+
+ID3DXEffect* ShaderFactory::CreateShader( const std::string& filePath, const std::vector<ShaderDefine>& defines, const ShaderKey& key )
+{
+	DWORD flags = 0;
+
+#ifdef DEBUG
+	flags |= D3DXSHADER_DEBUG;
+#endif
+
+	ID3DXEffect* effectd3d = nullptr;
+	ID3DXBuffer* errorBuffer = nullptr;
+
+	auto bundleEntry = key.definesHash == 0 ? bundleEntries.find( key ) : bundleEntries.end();
+
+	//Compiled Effect on Bundle?
+	if( bundleEntry != bundleEntries.end() )
+	{
+		if( FAILED( D3DXCreateEffect( graphics->GetDevice(), bundleData.data() + (*bundleEntry).second.first, (UINT)(*bundleEntry).second.second, nullptr, nullptr, flags, nullptr, &effectd3d, &errorBuffer ) ) )
+		{
+			DELTA3D_LOGERROR( "Could not create Compiled Effect from Bundle (%s): %s", filePath.c_str(), errorBuffer ? errorBuffer->GetBufferPointer() : "Unknown Reason" );
+
+			if( errorBuffer )
+				errorBuffer->Release();
+
+			return nullptr;
+		}
+	}
+	//Compiled Effect?
+	else if( IO::FileSystem::Get()->Exists( filePath + "c" ) )
+	{
+		IO::FileView file;
 
 		//Create from Compiled Effect
-		if( FAILED( D3DXCreateEffectFromFile( graphics->GetDevice(), compiledFilePath.c_str(), nullptr, nullptr, flags, nullptr, &effectd3d, &errorBuffer ) ) )
+		if( !IO::FileSystem::Get()->Open( GetCompiledFilePath( filePath, key.definesMask ), file ) || FAILED( D3DXCreateEffect( graphics->GetDevice(), file.Data(), (UINT)file.Size(), nullptr, nullptr, flags, nullptr, &effectd3d, &errorBuffer ) ) )
 		{
 			DELTA3D_LOGERROR( "Could not create Compiled Effect from File (%s): %s", filePath.c_str(), errorBuffer ? errorBuffer->GetBufferPointer() : "Unknown Reason" );
 
@@ -287,8 +559,11 @@ ID3DXEffect* ShaderFactory::CreateShader( const std::string& filePath, std::vect
 	}
 	else
 	{
+		IO::FileView file;
+		ShaderInclude include( filePath.substr( 0, filePath.find_last_of( "\\/" ) + 1 ) );
+
 		//Create Normal Effect
-		if( FAILED( D3DXCreateEffectFromFile( graphics->GetDevice(), filePath.c_str(), defines.empty() ? nullptr : (D3DXMACRO*)defines.data(), nullptr, flags, nullptr, &effectd3d, &errorBuffer ) ) )
+		if( !IO::FileSystem::Get()->Open( filePath, file ) || FAILED( D3DXCreateEffect( graphics->GetDevice(), file.Data(), (UINT)file.Size(), defines.empty() ? nullptr : (D3DXMACRO*)defines.data(), &include, flags, nullptr, &effectd3d, &errorBuffer ) ) )
 		{
 			DELTA3D_LOGERROR( "Could not create Effect from File (%s): %s", filePath.c_str(), errorBuffer ? errorBuffer->GetBufferPointer() : "Unknown Reason" );
 
@@ -306,4 +581,72 @@ ID3DXEffect* ShaderFactory::CreateShader( const std::string& filePath, std::vect
 	return effectd3d;
 }
 
+bool ShaderFactory::GetCompiledShader( const std::string& filePath, const std::vector<ShaderDefine>& defines, const ShaderKey& key, std::vector<char>& compiled )
+{
+	//Already on Bundle
+	auto bundleEntry = bundleEntries.find( key );
+	if( bundleEntry != bundleEntries.end() )
+	{
+		const char* data = bundleData.data() + (*bundleEntry).second.first;
+		compiled.assign( data, data + (*bundleEntry).second.second );
+
+		return true;
+	}
+
+	//Compiled Effect
+	if( IO::FileSystem::Get()->Exists( filePath + "c" ) )
+		return IO::FileSystem::Get()->Read( GetCompiledFilePath( filePath, key.definesMask ), compiled );
+
+	DWORD flags = 0;
+
+#ifdef DEBUG
+	flags |= D3DXSHADER_DEBUG;
+#endif
+
+	IO::FileView file;
+	ShaderInclude include( filePath.substr( 0, filePath.find_last_of( "\\/" ) + 1 ) );
+
+	ID3DXEffectCompiler* compiler = nullptr;
+	ID3DXBuffer* compiledBuffer = nullptr;
+	ID3DXBuffer* errorBuffer = nullptr;
+
+	//Compile Effect Source
+	if( !IO::FileSystem::Get()->Open( filePath, file ) || FAILED( D3DXCreateEffectCompiler( (const char*)file.Data(), (UINT)file.Size(), defines.empty() ? nullptr : (D3DXMACRO*)defines.data(), &include, flags, &compiler, &errorBuffer ) ) ||
+		FAILED( compiler->CompileEffect( flags, &compiledBuffer, &errorBuffer ) ) )
+	{
+		DELTA3D_LOGERROR( "Could not compile Effect (%s): %s", filePath.c_str(), errorBuffer ? errorBuffer->GetBufferPointer() : "Unknown Reason" );
+
+		if( errorBuffer )
+			errorBuffer->Release();
+
+		if( compiler )
+			compiler->Release();
+
+		return false;
+	}
+
+	const char* data = (const char*)compiledBuffer->GetBufferPointer();
+	compiled.assign( data, data + compiledBuffer->GetBufferSize() );
+
+	compiledBuffer->Release();
+	compiler->Release();
+
+	if( errorBuffer )
+		errorBuffer->Release();
+
+	return true;
+}
+
+std::string ShaderFactory::GetCompiledFilePath( const std::string& filePath, unsigned int definesMask )
+{
+	std::string compiledFilePath = filePath.substr( 0, filePath.find_last_of(".") );
+
+	if( definesMask > 0 )
+		compiledFilePath += std::to_string( definesMask );
+
+	compiledFilePath += ".fxc";
+
+	return compiledFilePath;
+}
+
 }
\ No newline at end of file
@@ -24,6 +24,42 @@ struct ShaderDefine
 	}
 };
 
+struct ShaderKey
+{
+	unsigned long long pathHash;	//!< Hash of normalized File Path
+	unsigned int definesMask;	//!< Defines with a bit on DefinesValue
+	unsigned long long definesHash;	//!< Hash of Defines without a bit (0 if there isn't any)
+
+	bool operator==( const ShaderKey& other ) const
+	{
+		return pathHash == other.pathHash && definesMask == other.definesMask && definesHash == other.definesHash;
+	}
+};
+
+struct ShaderKeyHash
+{
+	size_t operator()( const ShaderKey& key ) const;
+};
+
+static constexpr char ShaderBundleMagic[4] = { 'D', '3', 'S', 'B' };
+static constexpr unsigned int ShaderBundleVersion = 1;
+
+struct ShaderBundleHeader
+{
+	char magic[4];	//!< Bundle Identifier (ShaderBundleMagic)
+	unsigned int version;	//!< Bundle Format Version
+	unsigned int entriesCount;	//!< Compiled Effects on Bundle
+	unsigned int reserved;
+};
+
+struct ShaderBundleEntry
+{
+	unsigned long long pathHash;	//!< Hash of normalized File Path
+	unsigned int definesMask;	//!< Defines with a bit on DefinesValue
+	unsigned int size;	//!< Size of Compiled Effect
+	unsigned long long offset;	//!< Offset of Compiled Effect from start of Bundle
+};
+
 class Shader : public std::enable_shared_from_this<Shader>
 {
 friend class ShaderFactory;
@@ -79,6 +115,9 @@ public:
 	//! Set Texture Sampler.
 	void SetTexture( const std::string& variable, IDirect3DTexture9* texture );
 
+	//! Check if Effect has a Parameter.
+	bool HasParameter( const std::string& variable );
+
 	//! Begin Effect Pass.
 	bool BeginPass( unsigned int pass );
 
@@ -104,13 +143,17 @@ public:
 	const std::string& FilePath() const { return filePath; }
 
 	//! Get Effect Defines.
-	std::vector<ShaderDefine> Defines() const { return effectDefines; }
+	const std::vector<ShaderDefine>& Defines() const { return effectDefines; }
+private:
+	//! Copy Defines (callers strings can be released after Effect creation).
+	void SetDefines( const std::vector<ShaderDefine>& defines );
 private:
 	ID3DXEffect* effect;	//!< Effect Object
 	std::string filePath;	//!< Effect File Path
 	unsigned int numPasses;	//!< Number of Passes on Effect
 
-	std::vector<ShaderDefine> effectDefines;	//!< Effect Defines
+	std::vector<ShaderDefine> effectDefines;	//!< Effect Defines (pointing to definesStrings)
+	std::vector<std::string> definesStrings;	//!< Names and Values of Defines
 };
 
 class ShaderFactory
@@ -130,10 +173,57 @@ public:
 
 	//! Create Effect.
 	std::shared_ptr<Shader> Create( const std::string& filePath, std::vector<ShaderDefine> defines = {} );
+
+	/**
+	 * Read Compiled Effect of a permutation (safe on worker threads, a Bundle must not be loaded meanwhile)
+	 * @param filePath Effect File Path
+	 * @param defines Effect Defines
+	 * @param compiled Receive Compiled Effect
+	 * @return True if Effect was read or compiled
+	 */
+	bool Read( const std::string& filePath, std::vector<ShaderDefine> defines, std::vector<char>& compiled );
+
+	/**
+	 * Create Effect from a Compiled Effect given by Read (device thread)
+	 * @param filePath Effect File Path
+	 * @param defines Effect Defines
+	 * @param compiled Compiled Effect
+	 * @return Pointer to Effect (cached one if permutation was already created) or nullptr if it failed
+	 */
+	std::shared_ptr<Shader> Create( const std::string& filePath, std::vector<ShaderDefine> defines, const std::vector<char>& compiled );
+
+	/**
+	 * Load a Bundle of Compiled Effects, it is read at once and used before .fxc and .fx files
+	 * @param filePath Path of Bundle
+	 * @return True if Bundle was loaded
+	 */
+	bool LoadBundle( const std::string& filePath );
+
+	/**
+	 * Compile every cached Effect permutation and write them to a Bundle
+	 * @param filePath Path of Bundle
+	 * @return True if Bundle was written
+	 */
+	bool SaveBundle( const std::string& filePath );
+
+	//! Get number of Compiled Effects on loaded Bundle.
+	size_t GetBundleEntriesCount() const { return bundleEntries.size(); }
+
+	//! Get Key of an Effect permutation (Defines List Tail is ignored).
+	static ShaderKey GetKey( const std::string& filePath, const std::vector<ShaderDefine>& defines );
 private:
-	ID3DXEffect* CreateShader( const std::string& filePath, std::vector<ShaderDefine> defines );
+	ID3DXEffect* CreateShader( const std::string& filePath, const std::vector<ShaderDefine>& defines, const ShaderKey& key );
+
+	//! Get Compiled Effect of permutation from Bundle, .fxc file or compiling source.
+	bool GetCompiledShader( const std::string& filePath, const std::vector<ShaderDefine>& defines, const ShaderKey& key, std::vector<char>& compiled );
+
+	//! Get Path of .fxc file of permutation.
+	static std::string GetCompiledFilePath( const std::string& filePath, unsigned int definesMask );
 private:
-	std::vector<std::shared_ptr<Shader>> cache;	//!< Cache of Effect's
+	std::unordered_map<ShaderKey, std::shared_ptr<Shader>, ShaderKeyHash> cache;	//!< Cache of Effect's by permutation
+
+	std::vector<char> bundleData;	//!< Loaded Bundle
+	std::unordered_map<ShaderKey, std::pair<size_t, size_t>, ShaderKeyHash> bundleEntries;	//!< Offset and Size of Compiled Effects on Bundle
 
 	Graphics* graphics;	//!< Graphics Pointer
 };
@@ -0,0 +1,352 @@
+#include "PrecompiledHeader.h"
+#include "SkeletonEvaluator.h"
+
+namespace Delta3D::Graphics
+{
+SkeletonEvaluatorStatistics skeletonEvaluatorStatistics;
+
+SkeletonEvaluator::SkeletonEvaluator() :
+	bonesCount( 0 ),
+	lanesCount( 0 ),
+	rotated( false )
+{
+}
+
+bool SkeletonEvaluator::Build( const std::vector<Mesh*>& orderedMeshes )
+{
+	bonesCount = 0;
+	lanesCount = 0;
+
+	int count = (int)orderedMeshes.size();
+	int lanes = (count + 3) & ~3;
+
+	parents.assign( count, -1 );
+	tracks.resize( count );
+	baseRotations.resize( count );
+	baseTransforms.resize( count );
+	cursors.assign( count, IO::SMD::KeyCursor() );
+
+	//Unused lanes hold an identity Rotation
+	for( auto v : { &previousX, &previousY, &previousZ, &keyX, &keyY, &keyZ, &keyW, &weightKey, &translationX, &translationY, &translationZ } )
+		v->assign( lanes, 0.0f );
+
+	for( auto v : { &previousW, &weightPrevious, &scalingX, &scalingY, &scalingZ } )
+		v->assign( lanes, 1.0f );
+
+	states.assign( lanes, BoneState::Base );
+	previousMatrices.assign( count, nullptr );
+	scaled.assign( lanes, 0 );
+
+	locals.assign( lanes, Math::Matrix4::Identity );
+	resultAnimations.assign( count, Math::Matrix4::Identity );
+	worlds.assign( count, Math::Matrix4::Identity );
+
+	for( int i = 0; i < count; i++ )
+	{
+		const Mesh* mesh = orderedMeshes[i];
+		const Mesh* source = mesh->GetSourceMesh();
+
+		//Parent Bone is the first one with the Parent Mesh (a Mesh may be listed twice)
+		if( mesh->parent )
+		{
+			auto it = std::find( orderedMeshes.begin(), orderedMeshes.begin() + i, mesh->parent );
+
+			if( it == orderedMeshes.begin() + i )
+			{
+				DELTA3D_LOGERROR( "Could not build Skeleton Evaluator, Mesh (%s) is listed before your Parent", mesh->name );
+				return false;
+			}
+
+			parents[i] = (int)(it - orderedMeshes.begin());
+		}
+
+		BoneTracks& bone = tracks[i];
+		bone.rotationTrack = &source->rotationTrack;
+		bone.positionTrack = &source->positionTrack;
+		bone.scalingTrack = &source->scalingTrack;
+		bone.rotationCount = mesh->frameRotationCount;
+		bone.positionCount = mesh->framePositionCount;
+		bone.scalingCount = mesh->frameScalingCount;
+		bone.ranges = source->animationRanges.data();
+		bone.rangesCount = (int)source->animationRanges.size();
+		bone.useRanges = mesh->framesInfoCount != 0;
+		bone.basePosition = Math::Vector3( float( mesh->basePosition.x ) / 256.0f, float( mesh->basePosition.y ) / 256.0f, float( mesh->basePosition.z ) / 256.0f );
+
+		baseRotations[i] = mesh->baseRotation;
+		baseTransforms[i] = mesh->GetBaseTransform();
+	}
+
+	bonesCount = count;
+	lanesCount = lanes;
+
+	return true;
+}
+
+void SkeletonEvaluator::Evaluate( int frame_, Math::Vector3Int rotation_, const Math::Vector3& scaling_ )
+{
+	auto start = std::chrono::steady_clock::now();
+
+	Sample( frame_ );
+	BuildLocals();
+	BuildWorlds( rotation_, scaling_ );
+
+	skeletonEvaluatorStatistics.evaluations.fetch_add( 1, std::memory_order_relaxed );
+	skeletonEvaluatorStatistics.bones.fetch_add( bonesCount, std::memory_order_relaxed );
+	skeletonEvaluatorStatistics.time.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count(), std::memory_order_relaxed );
+}
+
+void SkeletonEvaluator::Apply( const std::vector<Mesh*>& orderedMeshes ) const
+{
+	if( (int)orderedMeshes.size() != bonesCount )
+		return;
+
+	for( int i = 0; i < bonesCount; i++ )
+	{
+		orderedMeshes[i]->resultAnimation = resultAnimations[i];
+		orderedMeshes[i]->world = worlds[i];
+
+		if( rotated )
+			orderedMeshes[i]->local = rotationLocal;
+	}
+}
+
+void SkeletonEvaluator::Sample( int frame_ )
+{
+	for( int i = 0; i < bonesCount; i++ )
+	{
+		const BoneTracks& bone = tracks[i];
+		IO::SMD::KeyCursor& cursor = cursors[i];
+
+		int rotationIndex = 0, scalingIndex = 0, positionIndex = 0;
+
+		//Active Motion of each Track (same lookup of Mesh::FindAnimationRange)
+		if( bone.useRanges )
+		{
+			auto range = std::upper_bound( bone.ranges, bone.ranges + bone.rangesCount, frame_, []( int value, const AnimationRange& range ) { return value < range.startFrame; } );
+
+			if( range == bone.ranges )
+			{
+				rotationIndex = -1;
+				scalingIndex = -1;
+				positionIndex = -1;
+			}
+			else
+			{
+				rotationIndex = (range - 1)->rotationIndex;
+				scalingIndex = (range - 1)->scalingIndex;
+				positionIndex = (range - 1)->positionIndex;
+			}
+		}
+
+		//Animation was found? (same test of Mesh::SampleTransform)
+		if( (!bone.useRanges && (bone.rotationCount > 0 || bone.positionCount > 0 || bone.scalingCount > 0)) || (bone.useRanges && (rotationIndex >= 0 || positionIndex >= 0 || scalingIndex > 0)) )
+		{
+			bool hasRotationAnimation = bone.rotationCount > 0 && (bone.useRanges ? rotationIndex >= 0 : bone.rotationTrack->GetFrame( bone.rotationCount - 1 ) > frame_);
+			bool hasScalingAnimation = bone.scalingCount > 0 && (bone.useRanges ? scalingIndex >= 0 : bone.scalingTrack->GetFrame( bone.scalingCount - 1 ) > frame_);
+			bool hasPositionAnimation = bone.positionCount > 0 && (bone.useRanges ? positionIndex >= 0 : bone.positionTrack->GetFrame( bone.positionCount - 1 ) > frame_);
+
+			states[i] = hasRotationAnimation ? BoneState::Rotation : BoneState::BaseRotation;
+
+			//Identity Rotation if frame is out of Track
+			Math::Quaternion previous = Math::Quaternion::Identity;
+			Math::Quaternion key( 0.0f, 0.0f, 0.0f, 0.0f );
+			float t1 = 1.0f, t2 = 0.0f;
+
+			int k = hasRotationAnimation ? bone.rotationTrack->Find( rotationIndex, frame_, cursor.rotation ) : -1;
+			previousMatrices[i] = nullptr;
+
+			if( k >= 0 )
+			{
+				int previousFrame = bone.rotationTrack->GetFrame( k );
+				int currentFrame = bone.rotationTrack->GetFrame( k + 1 );
+
+				float alpha = (float)(frame_ - previousFrame) / (float)(currentFrame - previousFrame);
+
+				//Scaled or mirrored Accumulated Rotation is applied as Matrix by BuildLocals
+				if( bone.rotationTrack->HasPreviousMatrices() )
+					previousMatrices[i] = &bone.rotationTrack->GetPreviousMatrix( k );
+				else
+					previous = bone.rotationTrack->GetPreviousRotation( k );
+				key = bone.rotationTrack->GetRotation( k + 1 );
+
+				//Slerp Weights from identity (same of Quaternion::Slerp)
+				float cosAngle = Math::Quaternion::Identity.DotProduct( key );
+
+				if( cosAngle < 0.0f )
+				{
+					cosAngle = -cosAngle;
+					key = -key;
+				}
+
+				float angle = acosf( cosAngle );
+				float sinAngle = sinf( angle );
+
+				if( sinAngle > 0.001f )
+				{
+					float invSinAngle = 1.0f / sinAngle;
+					t1 = sinf( ( 1.0f - alpha )* angle )* invSinAngle;
+					t2 = sinf( alpha* angle )* invSinAngle;
+				}
+				else
+				{
+					t1 = 1.0f - alpha;
+					t2 = alpha;
+				}
+			}
+
+			previousX[i] = previous.x;
+			previousY[i] = previous.y;
+			previousZ[i] = previous.z;
+			previousW[i] = previous.w;
+			keyX[i] = key.x;
+			keyY[i] = key.y;
+			keyZ[i] = key.z;
+			keyW[i] = key.w;
+			weightPrevious[i] = t1;
+			weightKey[i] = t2;
+
+			//Scaling
+			Math::Vector3 scaling( 1.0f, 1.0f, 1.0f );
+			scaled[i] = hasScalingAnimation ? 1 : 0;
+
+			if( hasScalingAnimation )
+				Mesh::SampleScaling( *bone.scalingTrack, scalingIndex, frame_, cursor.scaling, scaling );
+
+			scalingX[i] = scaling.x;
+			scalingY[i] = scaling.y;
+			scalingZ[i] = scaling.z;
+
+			//Position
+			Math::Vector3 translation = bone.basePosition;
+
+			if( hasPositionAnimation )
+				Mesh::SampleTranslation( *bone.positionTrack, positionIndex, frame_, cursor.position, translation );
+
+			translationX[i] = translation.x;
+			translationY[i] = translation.y;
+			translationZ[i] = translation.z;
+		}
+		else
+			states[i] = BoneState::Base;
+	}
+}
+
+void SkeletonEvaluator::BuildLocals()
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 two = _mm_set1_ps( 2.0f );
+
+	for( int i = 0; i < lanesCount; i += 4 )
+	{
+		__m128 t1 = _mm_loadu_ps( &weightPrevious[i] );
+		__m128 t2 = _mm_loadu_ps( &weightKey[i] );
+
+		//Slerp from identity (identity* t1 + key* t2)
+		__m128 sx = _mm_add_ps( _mm_mul_ps( zero, t1 ), _mm_mul_ps( _mm_loadu_ps( &keyX[i] ), t2 ) );
+		__m128 sy = _mm_add_ps( _mm_mul_ps( zero, t1 ), _mm_mul_ps( _mm_loadu_ps( &keyY[i] ), t2 ) );
+		__m128 sz = _mm_add_ps( _mm_mul_ps( zero, t1 ), _mm_mul_ps( _mm_loadu_ps( &keyZ[i] ), t2 ) );
+		__m128 sw = _mm_add_ps( _mm_mul_ps( one, t1 ), _mm_mul_ps( _mm_loadu_ps( &keyW[i] ), t2 ) );
+
+		//Accumulated Rotation* Slerp (same operations order of Quaternion::operator*)
+		__m128 px = _mm_loadu_ps( &previousX[i] );
+		__m128 py = _mm_loadu_ps( &previousY[i] );
+		__m128 pz = _mm_loadu_ps( &previousZ[i] );
+		__m128 pw = _mm_loadu_ps( &previousW[i] );
+
+		__m128 x = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( pw, sx ), _mm_mul_ps( px, sw ) ), _mm_mul_ps( py, sz ) ), _mm_mul_ps( pz, sy ) );
+		__m128 y = _mm_add_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( pw, sy ), _mm_mul_ps( px, sz ) ), _mm_mul_ps( py, sw ) ), _mm_mul_ps( pz, sx ) );
+		__m128 z = _mm_add_ps( _mm_sub_ps( _mm_add_ps( _mm_mul_ps( pw, sz ), _mm_mul_ps( px, sy ) ), _mm_mul_ps( py, sx ) ), _mm_mul_ps( pz, sw ) );
+		__m128 w = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_mul_ps( pw, sw ), _mm_mul_ps( px, sx ) ), _mm_mul_ps( py, sy ) ), _mm_mul_ps( pz, sz ) );
+
+		//Rotation Matrices (same operations order of Quaternion::ToMatrix)
+		__m128 xx = _mm_mul_ps( x, x ), yy = _mm_mul_ps( y, y ), zz = _mm_mul_ps( z, z );
+		__m128 xy = _mm_mul_ps( x, y ), xz = _mm_mul_ps( x, z ), yz = _mm_mul_ps( y, z );
+		__m128 xw = _mm_mul_ps( x, w ), yw = _mm_mul_ps( y, w ), zw = _mm_mul_ps( z, w );
+
+		__m128 row0[4] = { _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( yy, zz ) ) ), _mm_mul_ps( two, _mm_sub_ps( xy, zw ) ), _mm_mul_ps( two, _mm_add_ps( xz, yw ) ), zero };
+		__m128 row1[4] = { _mm_mul_ps( two, _mm_add_ps( xy, zw ) ), _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( xx, zz ) ) ), _mm_mul_ps( two, _mm_sub_ps( yz, xw ) ), zero };
+		__m128 row2[4] = { _mm_mul_ps( two, _mm_sub_ps( xz, yw ) ), _mm_mul_ps( two, _mm_add_ps( yz, xw ) ), _mm_sub_ps( one, _mm_mul_ps( two, _mm_add_ps( xx, yy ) ) ), zero };
+
+		//SoA to one Matrix per Bone
+		_MM_TRANSPOSE4_PS( row0[0], row0[1], row0[2], row0[3] );
+		_MM_TRANSPOSE4_PS( row1[0], row1[1], row1[2], row1[3] );
+		_MM_TRANSPOSE4_PS( row2[0], row2[1], row2[2], row2[3] );
+
+		for( int j = 0; j < 4; j++ )
+		{
+			_mm_storeu_ps( &locals[i + j]._11, row0[j] );
+			_mm_storeu_ps( &locals[i + j]._21, row1[j] );
+			_mm_storeu_ps( &locals[i + j]._31, row2[j] );
+			_mm_storeu_ps( &locals[i + j]._41, _mm_set_ps( 1.0f, 0.0f, 0.0f, 0.0f ) );
+		}
+	}
+
+	//Bones not using the animated Rotation, Scaling and Translation
+	for( int i = 0; i < bonesCount; i++ )
+	{
+		Math::Matrix4& local = locals[i];
+
+		if( states[i] == BoneState::Base )
+		{
+			local = baseTransforms[i];
+			continue;
+		}
+
+		if( states[i] == BoneState::BaseRotation )
+			local = baseRotations[i];
+		else if( previousMatrices[i] )
+			local = *previousMatrices[i]* local;
+
+		if( scaled[i] )
+		{
+			Math::Matrix4 scaling = Math::Matrix4::Identity;
+			scaling.Scale( Math::Vector3( scalingX[i], scalingY[i], scalingZ[i] ) );
+
+			local = local* scaling;
+		}
+
+		local._41 = translationX[i];
+		local._42 = translationY[i];
+		local._43 = translationZ[i];
+	}
+}
+
+void SkeletonEvaluator::BuildWorlds( Math::Vector3Int rotation_, const Math::Vector3& scaling_ )
+{
+	auto PTDegreeToRadians = []( const int deg ) { return (float)deg* D3DX_PI / 2048.0f; };
+
+	//Model Rotation and Scaling are the same for every Bone
+	rotated = rotation_ != Math::Vector3Int::Null;
+
+	if( rotated )
+	{
+		Math::Matrix4 rotateX, rotateY, rotateZ;
+
+		rotateX.RotateX( PTDegreeToRadians( rotation_.x ) );
+		rotateY.RotateZ( PTDegreeToRadians( rotation_.y ) );
+		rotateZ.RotateY( PTDegreeToRadians( rotation_.z ) );
+
+		rotationLocal = rotateZ* rotateX* rotateY;
+	}
+
+	bool scaleModel = scaling_ != Math::Vector3( 1.0f, 1.0f, 1.0f );
+
+	Math::Matrix4 scaling;
+	scaling.Scale( scaling_ );
+
+	//Parents are always before your children
+	for( int i = 0; i < bonesCount; i++ )
+	{
+		if( parents[i] >= 0 )
+			resultAnimations[i] = locals[i]* resultAnimations[parents[i]];
+		else
+			resultAnimations[i] = locals[i];
+
+		worlds[i] = rotated ? resultAnimations[i]* rotationLocal : resultAnimations[i];
+
+		if( scaleModel )
+			worlds[i] = worlds[i]* scaling;
+	}
+}
+}
\ No newline at end of file
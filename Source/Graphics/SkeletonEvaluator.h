@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Mesh.h"
+
+namespace Delta3D::Graphics
+{
+struct SkeletonEvaluatorStatistics
+{
+	std::atomic<unsigned long long> evaluations;	//!< Skeletons evaluated
+	std::atomic<unsigned long long> bones;	//!< Bones evaluated
+	std::atomic<unsigned long long> time;	//!< Time spent evaluating in nanoseconds
+
+	//! Get Bones evaluated per second.
+	double GetBonesPerSecond() const { return time ? (double)bones / ((double)time / 1000000000.0) : 0.0; }
+
+	//! Reset counters.
+	void Reset() { evaluations = 0; bones = 0; time = 0; }
+};
+
+//! Counters of every Skeleton Evaluator.
+extern SkeletonEvaluatorStatistics skeletonEvaluatorStatistics;
+
+class SkeletonEvaluator
+{
+public:
+	//! Default Constructor for an empty Evaluator.
+	SkeletonEvaluator();
+
+	//! Deconstructor.
+	~SkeletonEvaluator() = default;
+
+	/**
+	 * Build Evaluator from Ordered Meshes of a Model (Keyframe Tracks stay on Asset Meshes, so they must outlive it)
+	 * @param orderedMeshes Meshes in topological order (parents first)
+	 * @return False if a Mesh parent isn't before it
+	 */
+	bool Build( const std::vector<Mesh*>& orderedMeshes );
+
+	/**
+	 * Evaluate every Bone on a frame (same result of Mesh::Animate on each Ordered Mesh, checked by Tools/SkeletonCheck)
+	 * Frame Info isn't taken, Mesh::Animate doesn't read it either
+	 * @param frame_ Animation Frame
+	 * @param rotation_ Rotation to Model
+	 * @param scaling_ Scaling to Model
+	 */
+	void Evaluate( int frame_, Math::Vector3Int rotation_, const Math::Vector3& scaling_ );
+
+	/**
+	 * Copy last evaluated Pose to Meshes (Animation, World and Local Matrices)
+	 * @param orderedMeshes Meshes used to build Evaluator
+	 */
+	void Apply( const std::vector<Mesh*>& orderedMeshes ) const;
+
+	//! Bones Count.
+	int GetBonesCount() const { return bonesCount; }
+
+	//! World Matrices of last Evaluate (one per Bone).
+	const Math::Matrix4* GetWorlds() const { return worlds.data(); }
+private:
+	//! Find Keyframe Segments of every Bone and gather Slerp inputs in SoA arrays.
+	void Sample( int frame_ );
+
+	//! Slerp and compose Rotations of 4 Bones at once, then build local Matrices.
+	void BuildLocals();
+
+	//! Multiply local Matrices by parents in one pass.
+	void BuildWorlds( Math::Vector3Int rotation_, const Math::Vector3& scaling_ );
+private:
+	enum class BoneState : unsigned char
+	{
+		Base,	//!< No Animation on frame (Base Transform)
+		BaseRotation,	//!< Animated without Rotation Track (Base Rotation)
+		Rotation,	//!< Animated Rotation
+	};
+
+	struct BoneTracks
+	{
+		const IO::SMD::KeyTrack* rotationTrack;	//!< Rotation Track of Asset Mesh
+		const IO::SMD::KeyTrack* positionTrack;	//!< Position Track of Asset Mesh
+		const IO::SMD::KeyTrack* scalingTrack;	//!< Scaling Track of Asset Mesh
+		int rotationCount;	//!< Frames Rotation Count
+		int positionCount;	//!< Frames Position Count
+		int scalingCount;	//!< Frames Scaling Count
+		const AnimationRange* ranges;	//!< Animation Ranges of Asset Mesh
+		int rangesCount;	//!< Animation Ranges Count
+		bool useRanges;	//!< Mesh has Frames Info (Motions are looked up on Ranges)
+		Math::Vector3 basePosition;	//!< Base Position (not fixed point)
+	};
+
+	int bonesCount;	//!< Bones Count
+	int lanesCount;	//!< Bones Count rounded up to SIMD width
+
+	//Hierarchy and Base Pose (per Bone)
+	std::vector<int> parents;	//!< Index of Parent Bone (-1 on roots)
+	std::vector<BoneTracks> tracks;	//!< Keyframe Tracks
+	std::vector<Math::Matrix4> baseRotations;	//!< Base Rotation Matrices
+	std::vector<Math::Matrix4> baseTransforms;	//!< Local Matrices without Animation
+	std::vector<IO::SMD::KeyCursor> cursors;	//!< Keyframe Segments sampled by last Evaluate
+
+	//Local Transforms (SoA, per lane)
+	std::vector<float> previousX, previousY, previousZ, previousW;	//!< Accumulated Rotation of Segment
+	std::vector<float> keyX, keyY, keyZ, keyW;	//!< Rotation of next Keyframe (on shortest path)
+	std::vector<float> weightPrevious, weightKey;	//!< Slerp Weights
+	std::vector<float> translationX, translationY, translationZ;	//!< Local Translation
+	std::vector<float> scalingX, scalingY, scalingZ;	//!< Local Scaling
+	std::vector<BoneState> states;	//!< Source of local Rotation
+	std::vector<const Math::Matrix4*> previousMatrices;	//!< Accumulated Rotation kept as Matrix (scaled or mirrored Bone, previous lanes hold identity then)
+	std::vector<unsigned char> scaled;	//!< Scaling was sampled
+
+	//Results (per Bone)
+	std::vector<Math::Matrix4> locals;	//!< Local Matrices
+	std::vector<Math::Matrix4> resultAnimations;	//!< Local Matrices multiplied by parents
+	std::vector<Math::Matrix4> worlds;	//!< World Matrices
+	Math::Matrix4 rotationLocal;	//!< Model Rotation Matrix of last Evaluate
+	bool rotated;	//!< Last Evaluate had a Model Rotation
+};
+}
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "PrecompiledHeader.h"
+#include "Skinning.h"
+
+#include "../Math/Quaternion.h"
+
+namespace Delta3D::Graphics
+{
+SkinningStatistics skinningStatistics;
+
+//Rows of Bone Matrix weighted by position (x* row0 + y* row1 + z* row2 + row3)
+static inline __m128 SkinVertex( const SkinnedVertex& vertex, const Math::Matrix4& bone )
+{
+	__m128 result = _mm_mul_ps( _mm_set1_ps( vertex.x ), _mm_loadu_ps( &bone._11 ) );
+	result = _mm_add_ps( result, _mm_mul_ps( _mm_set1_ps( vertex.y ), _mm_loadu_ps( &bone._21 ) ) );
+	result = _mm_add_ps( result, _mm_mul_ps( _mm_set1_ps( vertex.z ), _mm_loadu_ps( &bone._31 ) ) );
+
+	return _mm_add_ps( result, _mm_loadu_ps( &bone._41 ) );
+}
+
+static inline __m128 SkinVertex( const SkinnedVertex& vertex, const Math::Matrix4* bones )
+{
+	return SkinVertex( vertex, bones[vertex.bone] );
+}
+
+//Weights of Bone Influences from 0..255 to 0..1 (255 gives exactly 1)
+static inline __m128 InfluenceWeights( const BoneInfluences& influences )
+{
+	__m128i weights = _mm_set_epi32( influences.weights[3], influences.weights[2], influences.weights[1], influences.weights[0] );
+
+	return _mm_div_ps( _mm_cvtepi32_ps( weights ), _mm_set1_ps( 255.0f ) );
+}
+
+static inline __m128 CrossProduct( __m128 a, __m128 b )
+{
+	__m128 result = _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 0, 2, 1 ) ), _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 1, 0, 2 ) ) );
+
+	return _mm_sub_ps( result, _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 1, 0, 2 ) ), _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 0, 2, 1 ) ) ) );
+}
+
+static inline __m128 DotProduct( __m128 a, __m128 b )
+{
+	__m128 n = _mm_mul_ps( a, b );
+	n = _mm_add_ps( n, _mm_shuffle_ps( n, n, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+
+	return _mm_add_ps( n, _mm_shuffle_ps( n, n, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+}
+
+//Last Vertex is stored through a temporary, so nothing after out is written
+static inline void StorePosition( float* out, __m128 position, bool last )
+{
+	if( last == false )
+	{
+		_mm_storeu_ps( out, position );
+		return;
+	}
+
+	float result[4];
+	_mm_storeu_ps( result, position );
+
+	out[0] = result[0];
+	out[1] = result[1];
+	out[2] = result[2];
+}
+
+void SkinVertices( const SkinnedVertex* vertices, size_t count, const Math::Matrix4* bones, float* out )
+{
+	size_t i = 0;
+
+	//4 Vertices are packed in 3 stores, so Vertex Buffer is written sequentially
+	for( ; i + 4 <= count; i += 4, out += 12 )
+	{
+		__m128 p0 = SkinVertex( vertices[i], bones );
+		__m128 p1 = SkinVertex( vertices[i + 1], bones );
+		__m128 p2 = SkinVertex( vertices[i + 2], bones );
+		__m128 p3 = SkinVertex( vertices[i + 3], bones );
+
+		//x0 y0 z0 x1
+		__m128 t = _mm_shuffle_ps( p0, p1, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+		_mm_storeu_ps( out, _mm_shuffle_ps( p0, t, _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+
+		//y1 z1 x2 y2
+		_mm_storeu_ps( out + 4, _mm_shuffle_ps( p1, p2, _MM_SHUFFLE( 1, 0, 2, 1 ) ) );
+
+		//z2 x3 y3 z3
+		t = _mm_shuffle_ps( p2, p3, _MM_SHUFFLE( 0, 0, 2, 2 ) );
+		_mm_storeu_ps( out + 8, _mm_shuffle_ps( t, p3, _MM_SHUFFLE( 2, 1, 2, 0 ) ) );
+	}
+
+	for( ; i < count; i++, out += 3 )
+	{
+		float result[4];
+		_mm_storeu_ps( result, SkinVertex( vertices[i], bones ) );
+
+		out[0] = result[0];
+		out[1] = result[1];
+		out[2] = result[2];
+	}
+}
+
+void SkinVerticesLinear( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const Math::Matrix4* bones, float* out )
+{
+	for( size_t i = 0; i < count; i++, out += 3 )
+	{
+		const BoneInfluences& influence = influences[i];
+		__m128 weights = InfluenceWeights( influence );
+
+		//Heaviest Bone first, others are added while they have weight
+		__m128 result = _mm_mul_ps( SkinVertex( vertices[i], bones[influence.bones[0]] ), _mm_shuffle_ps( weights, weights, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+
+		if( influence.weights[1] )
+			result = _mm_add_ps( result, _mm_mul_ps( SkinVertex( vertices[i], bones[influence.bones[1]] ), _mm_shuffle_ps( weights, weights, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+
+		if( influence.weights[2] )
+			result = _mm_add_ps( result, _mm_mul_ps( SkinVertex( vertices[i], bones[influence.bones[2]] ), _mm_shuffle_ps( weights, weights, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+
+		if( influence.weights[3] )
+			result = _mm_add_ps( result, _mm_mul_ps( SkinVertex( vertices[i], bones[influence.bones[3]] ), _mm_shuffle_ps( weights, weights, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+
+		StorePosition( out, result, i + 1 == count );
+	}
+}
+
+void SkinVerticesDualQuaternion( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const BoneDualQuaternion* bones, float* out )
+{
+	const __m128 signMask = _mm_castsi128_ps( _mm_set1_epi32( (int)0x80000000UL ) );
+
+	for( size_t i = 0; i < count; i++, out += 3 )
+	{
+		const BoneInfluences& influence = influences[i];
+
+		__m128 firstReal = _mm_loadu_ps( bones[influence.bones[0]].real );
+
+		__m128 weight = _mm_set1_ps( influence.weights[0] / 255.0f );
+		__m128 real = _mm_mul_ps( firstReal, weight );
+		__m128 dual = _mm_mul_ps( _mm_loadu_ps( bones[influence.bones[0]].dual ), weight );
+		__m128 scale = _mm_mul_ps( _mm_loadu_ps( bones[influence.bones[0]].scale ), weight );
+
+		for( int j = 1; j < maxBoneInfluences && influence.weights[j]; j++ )
+		{
+			const BoneDualQuaternion& bone = bones[influence.bones[j]];
+			__m128 boneReal = _mm_loadu_ps( bone.real );
+
+			weight = _mm_set1_ps( influence.weights[j] / 255.0f );
+			scale = _mm_add_ps( scale, _mm_mul_ps( _mm_loadu_ps( bone.scale ), weight ) );
+
+			//q and -q are the same rotation, so every Bone is blended on the hemisphere of heaviest one
+			weight = _mm_xor_ps( weight, _mm_and_ps( DotProduct( boneReal, firstReal ), signMask ) );
+
+			real = _mm_add_ps( real, _mm_mul_ps( boneReal, weight ) );
+			dual = _mm_add_ps( dual, _mm_mul_ps( _mm_loadu_ps( bone.dual ), weight ) );
+		}
+
+		//Normalize blended Dual Quaternion
+		__m128 length = _mm_sqrt_ps( DotProduct( real, real ) );
+		real = _mm_div_ps( real, length );
+		dual = _mm_div_ps( dual, length );
+
+		__m128 realW = _mm_shuffle_ps( real, real, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		__m128 dualW = _mm_shuffle_ps( dual, dual, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		__m128 position = _mm_mul_ps( _mm_set_ps( 0.0f, vertices[i].z, vertices[i].y, vertices[i].x ), scale );
+
+		//Rotation (v + 2* cross( r, cross( r, v ) + w* v ))
+		__m128 t = _mm_add_ps( CrossProduct( real, position ), _mm_mul_ps( realW, position ) );
+		__m128 result = _mm_add_ps( position, _mm_mul_ps( _mm_set1_ps( 2.0f ), CrossProduct( real, t ) ) );
+
+		//Translation (2* (w* d - dw* r + cross( r, d )))
+		t = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( realW, dual ), _mm_mul_ps( dualW, real ) ), CrossProduct( real, dual ) );
+		result = _mm_add_ps( result, _mm_mul_ps( _mm_set1_ps( 2.0f ), t ) );
+
+		//Y and Z are flipped like Skinning Matrices (a flip isn't a rotation, so Dual Quaternions are built from World Matrices)
+		result = _mm_shuffle_ps( result, result, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+
+		StorePosition( out, result, i + 1 == count );
+	}
+}
+
+void SkinVertices( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const Math::Matrix4* bones, const BoneDualQuaternion* dualQuaternions, float* out )
+{
+	if( influences == nullptr )
+		SkinVertices( vertices, count, bones, out );
+	else if( dualQuaternions )
+		SkinVerticesDualQuaternion( vertices, influences, count, dualQuaternions, out );
+	else
+		SkinVerticesLinear( vertices, influences, count, bones, out );
+}
+
+BoneInfluences NormalizeBoneInfluences( const BoneInfluences& influences )
+{
+	int order[maxBoneInfluences] = { 0, 1, 2, 3 };
+	std::stable_sort( order, order + maxBoneInfluences, [&influences]( int a, int b ) { return influences.weights[a] > influences.weights[b]; } );
+
+	int sum = 0;
+	for( int i = 0; i < maxBoneInfluences; i++ )
+		sum += influences.weights[i];
+
+	BoneInfluences result = { { influences.bones[order[0]], 0, 0, 0 }, { 255, 0, 0, 0 } };
+
+	if( sum == 0 )
+		return result;
+
+	int total = 0;
+
+	for( int i = 0; i < maxBoneInfluences; i++ )
+	{
+		int weight = (influences.weights[order[i]]* 255 + sum / 2) / sum;
+
+		result.bones[i] = weight ? influences.bones[order[i]] : 0;
+		result.weights[i] = (unsigned char)weight;
+
+		total += weight;
+	}
+
+	//Rounding error goes to the heaviest Bone
+	result.weights[0] = (unsigned char)(result.weights[0] + 255 - total);
+
+	return result;
+}
+
+bool BuildDualQuaternions( const Math::Matrix4* bones, size_t count, BoneDualQuaternion* out )
+{
+	const float orthogonalEpsilon = 1e-3f;
+
+	for( size_t i = 0; i < count; i++ )
+	{
+		const Math::Matrix4& bone = bones[i];
+
+		//Bones transform row vectors, so length of each row is a scaling on Bone space (before rotation)
+		Math::Matrix4 rotation;
+		float scale[3];
+
+		for( int j = 0; j < 3; j++ )
+		{
+			scale[j] = sqrtf( bone.m[j][0]* bone.m[j][0] + bone.m[j][1]* bone.m[j][1] + bone.m[j][2]* bone.m[j][2] );
+
+			if( scale[j] <= 0.0f )
+				return false;
+
+			for( int k = 0; k < 3; k++ )
+				rotation.m[j][k] = bone.m[j][k] / scale[j];
+		}
+
+		//Rows must be a rotation once scaling is removed (non-uniform scaling after a rotation shears them)
+		for( int j = 0; j < 3; j++ )
+		{
+			const float* a = rotation.m[j];
+			const float* b = rotation.m[(j + 1) % 3];
+
+			if( fabsf( a[0]* b[0] + a[1]* b[1] + a[2]* b[2] ) > orthogonalEpsilon )
+				return false;
+		}
+
+		//A mirror isn't a rotation either (row 0 must follow cross of rows 1 and 2)
+		const float* x = rotation.m[0];
+		const float* y = rotation.m[1];
+		const float* z = rotation.m[2];
+
+		if( x[0]* (y[1]* z[2] - y[2]* z[1]) + x[1]* (y[2]* z[0] - y[0]* z[2]) + x[2]* (y[0]* z[1] - y[1]* z[0]) < 0.0f )
+			return false;
+
+		//Bones transform row vectors, so the Quaternion rotating columns is conjugated
+		Math::Quaternion q;
+		q.FromRotationMatrix( rotation );
+		q.Normalize();
+
+		const float r[4] = { -q.x, -q.y, -q.z, q.w };
+		const float t[3] = { bone._41, bone._42, bone._43 };
+
+		//Dual = 0.5* (t, 0)* r
+		out[i].real[0] = r[0];
+		out[i].real[1] = r[1];
+		out[i].real[2] = r[2];
+		out[i].real[3] = r[3];
+
+		out[i].dual[0] = 0.5f* (t[0]* r[3] + t[1]* r[2] - t[2]* r[1]);
+		out[i].dual[1] = 0.5f* (t[1]* r[3] + t[2]* r[0] - t[0]* r[2]);
+		out[i].dual[2] = 0.5f* (t[2]* r[3] + t[0]* r[1] - t[1]* r[0]);
+		out[i].dual[3] = -0.5f* (t[0]* r[0] + t[1]* r[1] + t[2]* r[2]);
+
+		out[i].scale[0] = scale[0];
+		out[i].scale[1] = scale[1];
+		out[i].scale[2] = scale[2];
+		out[i].scale[3] = 0.0f;
+	}
+
+	return true;
+}
+}
\ No newline at end of file
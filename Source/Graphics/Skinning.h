@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../Math/Matrix4.h"
+
+namespace Delta3D::Graphics
+{
+class Model;
+
+//! Max Bones influencing a Vertex.
+const int maxBoneInfluences = 4;
+
+//! Max Bones of a Skeleton Palette (Bones Texture holds 384 texels, 3 per Bone).
+const int maxPaletteBones = 128;
+
+//! Floats of each Bone on Bones Palette (3x4 Matrix, every Skinning Mode).
+const int bonePaletteStride = 12;
+
+enum class SkinningMode
+{
+	Linear,	//!< Bone Matrices blended by weight
+	DualQuaternion,	//!< Bone Dual Quaternions blended by weight (keeps volume on twisted joints, Software Skinning only)
+};
+
+struct SkinnedVertex
+{
+	float x;	//!< X Coordinate on Bind Pose
+	float y;	//!< Y Coordinate on Bind Pose
+	float z;	//!< Z Coordinate on Bind Pose
+	int bone;	//!< Index of Bone on Skeleton Ordered Meshes
+};
+
+struct BoneInfluences
+{
+	unsigned char bones[maxBoneInfluences];	//!< Index of each Bone on Skeleton Ordered Meshes
+	unsigned char weights[maxBoneInfluences];	//!< Weight of each Bone (sum is 255, heaviest first and unused ones are 0)
+};
+
+struct BoneDualQuaternion
+{
+	float real[4];	//!< Rotation (x, y, z, w)
+	float dual[4];	//!< Translation (half of translation multiplied by rotation)
+	float scale[4];	//!< Scaling on Bone space, applied before rotation (x, y, z, unused)
+};
+
+struct SkinnedPose
+{
+	const Model* skeleton;	//!< Skeleton which skinned Vertex Buffer
+	unsigned int poseVersion;	//!< Pose Version of Skeleton when Vertex Buffer was skinned
+
+	//! Default Constructor (no Pose skinned yet).
+	SkinnedPose() : skeleton( nullptr ), poseVersion( 0 ) {}
+};
+
+struct SkinningStatistics
+{
+	std::atomic<unsigned long long> performed;	//!< Meshes skinned
+	std::atomic<unsigned long long> skipped;	//!< Meshes not skinned again (Vertex Buffer already holds the Pose)
+
+	//! Reset counters.
+	void Reset() { performed = 0; skipped = 0; }
+};
+
+//! Counters of Software Skinning.
+extern SkinningStatistics skinningStatistics;
+
+/**
+ * Transform Skinned Vertices by your Bones with SSE (same result of Matrix4 * Vector3)
+ * @param vertices Source Vertices
+ * @param count Vertices Count
+ * @param bones Skinning Matrices of Skeleton (Model::GetSkinningMatrices)
+ * @param out Receive Positions, 3 floats per Vertex written in order (may be a locked Vertex Buffer)
+ */
+void SkinVertices( const SkinnedVertex* vertices, size_t count, const Math::Matrix4* bones, float* out );
+
+/**
+ * Transform Skinned Vertices by up to 4 weighted Bones with SSE (one Bone of weight 255 gives same result of SkinVertices)
+ * @param vertices Source Vertices (Bone is ignored)
+ * @param influences Bones and Weights of each Vertex
+ * @param count Vertices Count
+ * @param bones Skinning Matrices of Skeleton (Model::GetSkinningMatrices)
+ * @param out Receive Positions, 3 floats per Vertex
+ */
+void SkinVerticesLinear( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const Math::Matrix4* bones, float* out );
+
+/**
+ * Transform Skinned Vertices by up to 4 weighted Bones blending Dual Quaternions with SSE
+ * Bone scaling is blended linearly and applied before rotation
+ * Positions get Y and Z flipped, so one Bone of weight 255 gives same result of SkinVertices
+ * @param vertices Source Vertices (Bone is ignored)
+ * @param influences Bones and Weights of each Vertex
+ * @param count Vertices Count
+ * @param bones Dual Quaternions of Skeleton World Matrices (Model::GetSkinningDualQuaternions)
+ * @param out Receive Positions, 3 floats per Vertex
+ */
+void SkinVerticesDualQuaternion( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const BoneDualQuaternion* bones, float* out );
+
+/**
+ * Transform Skinned Vertices choosing the kernel from given data
+ * @param vertices Source Vertices
+ * @param influences Bones and Weights of each Vertex (nullptr if each Vertex follows your Bone)
+ * @param count Vertices Count
+ * @param bones Skinning Matrices of Skeleton
+ * @param dualQuaternions Dual Quaternions of Skeleton World Matrices (nullptr to blend Matrices, ignored without influences)
+ * @param out Receive Positions, 3 floats per Vertex
+ */
+void SkinVertices( const SkinnedVertex* vertices, const BoneInfluences* influences, size_t count, const Math::Matrix4* bones, const BoneDualQuaternion* dualQuaternions, float* out );
+
+/**
+ * Sort Bone Influences by weight (heaviest first) and scale weights to sum 255
+ * @param influences Bones and Weights in any order and scale
+ * @return Normalized Influences (first Bone with weight 255 if every weight is 0)
+ */
+BoneInfluences NormalizeBoneInfluences( const BoneInfluences& influences );
+
+/**
+ * Build Dual Quaternions from Bone Matrices (length of each row goes to Bone scaling)
+ * @param bones Bone Matrices
+ * @param count Bones Count
+ * @param out Receive Dual Quaternions
+ * @return False if a Bone is sheared or mirrored (non-uniform scaling after a rotation), it can't be held by a Dual Quaternion
+ */
+bool BuildDualQuaternions( const Math::Matrix4* bones, size_t count, BoneDualQuaternion* out );
+}
\ No newline at end of file
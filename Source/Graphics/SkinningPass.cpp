@@ -0,0 +1,92 @@
+#include "PrecompiledHeader.h"
+#include "SkinningPass.h"
+
+#include "VertexBuffer.h"
+
+#include "../Core/ThreadPool.h"
+
+namespace Delta3D::Graphics
+{
+SkinningPass::SkinningPass() :
+	skinTime( 0.0f ),
+	uploadTime( 0.0f )
+{
+}
+
+size_t SkinningPass::Push( const SkinnedVertex* vertices, size_t count, const Math::Matrix4* bones, std::shared_ptr<VertexBuffer> target, const BoneInfluences* influences, const BoneDualQuaternion* dualQuaternions )
+{
+	SkinningJob job;
+	job.vertices = vertices;
+	job.count = count;
+	job.bones = bones;
+	job.influences = influences;
+	job.dualQuaternions = dualQuaternions;
+	job.target = target;
+	job.offset = staging.size();
+	job.uploaded = false;
+
+	//Big Meshes are split, so they are spread across workers too
+	for( size_t first = 0; first < count; first += skinningRangeSize )
+		ranges.push_back( SkinningRange{ jobs.size(), first, std::min( skinningRangeSize, count - first ) } );
+
+	staging.resize( staging.size() + count* 3 );
+	jobs.push_back( job );
+
+	return jobs.size() - 1;
+}
+
+void SkinningPass::Skin()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	Core::ThreadPool::Get()->ParallelFor( ranges.size(), [this]( size_t i )
+	{
+		const SkinningRange& range = ranges[i];
+		const SkinningJob& job = jobs[range.job];
+
+		SkinVertices( job.vertices + range.first, job.influences ? job.influences + range.first : nullptr, range.count, job.bones, job.dualQuaternions, staging.data() + job.offset + range.first* 3 );
+	} );
+
+	skinTime = std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+size_t SkinningPass::Upload()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	size_t uploaded = 0;
+
+	for( auto& job : jobs )
+	{
+		if( job.target == nullptr || job.count == 0 )
+			continue;
+
+		if( job.target->ElementCount() < job.count )
+		{
+			DELTA3D_LOGERROR( "Vertex Buffer is smaller than Skinned Vertices (%zu < %zu)", (size_t)job.target->ElementCount(), job.count );
+			continue;
+		}
+
+		if( void* vertexPositionData = job.target->Lock() )
+		{
+			memcpy( vertexPositionData, staging.data() + job.offset, job.count* 3* sizeof( float ) );
+
+			job.target->Unlock();
+			job.uploaded = true;
+
+			uploaded++;
+		}
+	}
+
+	uploadTime = std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	return uploaded;
+}
+
+void SkinningPass::Clear()
+{
+	jobs.clear();
+	ranges.clear();
+	staging.clear();
+}
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Skinning.h"
+
+namespace Delta3D::Graphics
+{
+class VertexBuffer;
+
+//! Vertices skinned by each Range of a Job (multiple of 4, so Ranges keep the packed stores of SkinVertices).
+const size_t skinningRangeSize = 4096;
+
+class SkinningPass
+{
+public:
+	//! Default Constructor for an empty Pass.
+	SkinningPass();
+
+	//! Deconstructor.
+	~SkinningPass() = default;
+
+	/**
+	 * Push a Job to be skinned by next Skin (Vertices and Bones must be alive until then)
+	 * @param vertices Source Vertices
+	 * @param count Vertices Count
+	 * @param bones Skinning Matrices of Skeleton (Model::GetSkinningMatrices)
+	 * @param target Dynamic Vertex Buffer receiving Positions on Upload (nullptr to only skin into Staging Memory)
+	 * @param influences Bones and Weights of each Vertex (nullptr if each Vertex follows your Bone)
+	 * @param dualQuaternions Dual Quaternions of Skeleton to blend weighted Bones (nullptr to blend Matrices)
+	 * @return Job Index
+	 */
+	size_t Push( const SkinnedVertex* vertices, size_t count, const Math::Matrix4* bones, std::shared_ptr<VertexBuffer> target = nullptr, const BoneInfluences* influences = nullptr, const BoneDualQuaternion* dualQuaternions = nullptr );
+
+	/**
+	 * Skin every Job into Staging Memory across worker threads (doesn't use the device)
+	 * Each Range writes only your own Vertices, so result doesn't depend on workers count or order
+	 */
+	void Skin();
+
+	/**
+	 * Copy Staging Memory of each Job to your Vertex Buffer (device thread)
+	 * @return Number of Vertex Buffers uploaded
+	 */
+	size_t Upload();
+
+	//! Clear pushed Jobs (Staging Memory is kept to be reused).
+	void Clear();
+
+	//! Get Positions skinned for a Job (3 floats per Vertex).
+	const float* GetStaging( size_t job ) const { return staging.data() + jobs[job].offset; }
+
+	//! Check if a Job was uploaded by last Upload.
+	bool IsUploaded( size_t job ) const { return jobs[job].uploaded; }
+
+	//! Get number of Jobs pushed.
+	size_t GetJobsCount() const { return jobs.size(); }
+
+	//! Get number of Ranges skinned by last Skin.
+	size_t GetRangesCount() const { return ranges.size(); }
+
+	//! Get number of Vertices pushed.
+	size_t GetVerticesCount() const { return staging.size() / 3; }
+
+	//! Get time spent by last Skin in milliseconds.
+	float GetSkinTime() const { return skinTime; }
+
+	//! Get time spent by last Upload in milliseconds.
+	float GetUploadTime() const { return uploadTime; }
+private:
+	struct SkinningJob
+	{
+		const SkinnedVertex* vertices;	//!< Source Vertices
+		size_t count;	//!< Vertices Count
+		const Math::Matrix4* bones;	//!< Skinning Matrices
+		const BoneInfluences* influences;	//!< Bones and Weights of each Vertex
+		const BoneDualQuaternion* dualQuaternions;	//!< Dual Quaternions of Skeleton
+		std::shared_ptr<VertexBuffer> target;	//!< Vertex Buffer receiving Positions
+		size_t offset;	//!< Offset of Positions on Staging Memory (in floats)
+		bool uploaded;	//!< Positions were copied to Vertex Buffer
+	};
+
+	struct SkinningRange
+	{
+		size_t job;	//!< Index of Job
+		size_t first;	//!< First Vertex
+		size_t count;	//!< Vertices Count
+	};
+
+	std::vector<SkinningJob> jobs;	//!< Jobs pushed since last Clear
+	std::vector<SkinningRange> ranges;	//!< Jobs split in Ranges of skinningRangeSize Vertices
+	std::vector<float> staging;	//!< Skinned Positions of every Job
+
+	float skinTime;	//!< Time of last Skin in milliseconds
+	float uploadTime;	//!< Time of last Upload in milliseconds
+};
+}
\ No newline at end of file
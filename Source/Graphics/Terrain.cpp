@@ -1,14 +1,32 @@
 #include "PrecompiledHeader.h"
 #include "Terrain.h"
 
+#include "../IO/FileSystem.h"
+
 namespace Delta3D::Graphics
 {
-Terrain::Terrain() : GraphicsImpl(), quadTree( nullptr ), model( nullptr ), id( -1 )
+Terrain::Terrain() : GraphicsImpl(), quadTree( nullptr ), model( nullptr ), id( -1 ), pendingModels( 0 ), streamDistance( 0.0f ), streamHysteresis( streamHysteresisDefault ), streamMemoryBudget( streamMemoryBudgetDefault ), streamMemoryUsage( 0 )
 {
 }
 
 Terrain::~Terrain()
 {
+	//Models still loading can't be touched by Background Loader anymore
+	for( auto& loadHandle : loadHandles )
+		graphics->GetBackgroundLoader()->Cancel( loadHandle );
+
+	loadHandles.clear();
+
+	for( auto& cell : cells )
+		graphics->GetBackgroundLoader()->Cancel( cell.loadHandle );
+
+	cells.clear();
+
+	for( auto& loadingModel : loadingModels )
+		delete loadingModel;
+
+	loadingModels.clear();
+
 	if( model )
 	{
 		delete model;
@@ -35,8 +53,13 @@ Terrain::~Terrain()
 
 bool Terrain::Load( const std::string& filePath )
 {
+	IO::FileView file;
+
+	if( !IO::FileSystem::Get()->Open( filePath, file ) )
+		return false;
+
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file( filePath.c_str() );
+	pugi::xml_parse_result result = doc.load_buffer( file.Data(), file.Size() );
 
 	if( !result )
 		return false;
@@ -58,26 +81,53 @@ bool Terrain::Load( const std::string& filePath )
 			sscanf_s( attributeNode.attribute( "value" ).value(), "%f %f %f", &position.x, &position.y, &position.z );
 	}
 
-	//Create Model
+	auto backgroundLoader = graphics->GetBackgroundLoader();
+
+	//Temporary Textures Cache is cleared after every Model was loaded
+	auto OnModelLoaded = [this]()
+	{
+		if( --pendingModels == 0 )
+			graphics->GetTextureFactory()->Clear();
+	};
+
+	//Create Model (Mesh Buffers are streamed by Camera distance)
 	model = new Model();
+	model->SetStreamMeshes( true );
+	pendingModels = 1;
 
-	//Load Model
-	if( model->Load( strTerrainFilePath, nullptr, true ) )
+	//Load Model on Background
+	loadHandles.push_back( backgroundLoader->LoadModel( model, strTerrainFilePath, nullptr, true, [this, strTerrainFilePath, position, quadTreeMaxObjects, OnModelLoaded]( Resource::LoadState state )
 	{
-		//Reset Position and Frustum Culling
-		model->SetPositionRotation( &position, &Math::Vector3Int() );
-		model->SetUseFrustumCulling( false );
+		if( state == Resource::LoadState::Loaded )
+		{
+			//Reset Position and Frustum Culling
+			model->SetPositionRotation( &position, &Math::Vector3Int() );
+			model->SetUseFrustumCulling( false );
+
+			//Create Quadtree
+			quadTree = new Quadtree( model, quadTreeMaxObjects );
+			quadTree->Build();
+
+			BuildCells();
+		}
+		else
+			DELTA3D_LOGERROR( "Could not load Terrain Model %s", strTerrainFilePath.c_str() );
+
+		OnModelLoaded();
+	}, Resource::LoadPriority::High ) );
 
-		//Create Quadtree
-		quadTree = new Quadtree( model, quadTreeMaxObjects );
-		quadTree->Build();
+	//Read Animated Models from XML
+	for( pugi::xml_node animationNode : terrain.children("Animation") )
+	{
+		Model* animatedModel = new Model();
+		loadingModels.push_back( animatedModel );
+		pendingModels++;
 
-		//Read Animated Models from XML
-		for( pugi::xml_node animationNode : terrain.children("Animation") )
+		loadHandles.push_back( backgroundLoader->LoadModel( animatedModel, animationNode.attribute( "file" ).value(), nullptr, true, [this, animatedModel, OnModelLoaded]( Resource::LoadState state )
 		{
-			Model* animatedModel = new Model();
+			loadingModels.erase( std::remove( loadingModels.begin(), loadingModels.end(), animatedModel ), loadingModels.end() );
 
-			if( animatedModel->Load( animationNode.attribute( "file" ).value(), nullptr, true ) )
+			if( state == Resource::LoadState::Loaded )
 			{
 				animatedModel->materialCollection->materialType = 0;
 				animatedModel->SetPositionRotation( &Math::Vector3(), &Math::Vector3Int() );
@@ -86,15 +136,12 @@ bool Terrain::Load( const std::string& filePath )
 			}
 			else
 				delete animatedModel;
-		}
-
-		//After everything already loaded, we can clear temporary cache
-		graphics->GetTextureFactory()->Clear();
 
-		return true;
+			OnModelLoaded();
+		}, Resource::LoadPriority::Normal, loadHandles.front() ) );
 	}
 
-	return false;
+	return true;
 }
 
 void Terrain::Render()
@@ -106,8 +153,184 @@ void Terrain::Render()
 			animatedModel->Render();
 
 		if( quadTree )
+		{
+			UpdateStreaming();
+
 			quadTree->Render();
+		}
+	}
+}
+
+void Terrain::BuildCells()
+{
+	cells.clear();
+	streamMemoryUsage = 0;
+
+	//Index of each Mesh on Model
+	std::unordered_map<Mesh*, size_t> meshesIndex;
+
+	for( size_t i = 0; i < model->meshes.size(); i++ )
+		meshesIndex[model->meshes[i]] = i;
+
+	std::vector<Node*> nodes;
+
+	if( quadTree->GetRoot() )
+		nodes.push_back( quadTree->GetRoot() );
+
+	while( !nodes.empty() )
+	{
+		Node* node = nodes.back();
+		nodes.pop_back();
+
+		for( const auto& childNode : node->nodes )
+			if( childNode )
+				nodes.push_back( childNode );
+
+		if( node->meshes.empty() )
+			continue;
+
+		TerrainCell cell;
+		cell.node = node;
+		cell.boundingBox = node->boundingBox.Transformed( quadTree->GetTranslation() );
+
+		for( const auto& mesh : node->meshes )
+		{
+			auto it = meshesIndex.find( mesh );
+
+			if( it != meshesIndex.end() )
+			{
+				cell.meshesIndex.push_back( it->second );
+				cell.buffersSize += model->GetMeshBuffersSize( it->second );
+			}
+		}
+
+		//Node Meshes are rendered when Cell is loaded
+		node->loaded = false;
+
+		cells.push_back( cell );
+	}
+
+	//Vertices were only needed to build Quadtree, Cells copy them again when loaded
+	for( size_t i = 0; i < model->meshes.size(); i++ )
+		model->ReleaseMeshBuffers( i );
+}
+
+void Terrain::UpdateStreaming()
+{
+	if( cells.empty() )
+		return;
+
+	Math::Vector3 eye = renderer->GetCamera()->Eye();
+	float loadDistance = streamDistance > 0.0f ? streamDistance : renderer->GetCamera()->FarClip();
+	float unloadDistance = loadDistance* streamHysteresis;
+
+	std::vector<TerrainCell*> loadCells;
+
+	for( auto& cell : cells )
+	{
+		cell.distance = cell.boundingBox.Distance( eye );
+
+		if( cell.resident )
+		{
+			//Too far, release it
+			if( cell.distance > unloadDistance )
+				UnloadCell( cell );
+		}
+		else if( cell.distance <= loadDistance )
+			loadCells.push_back( &cell );
+	}
+
+	if( loadCells.empty() )
+		return;
+
+	//Nearest Cells first
+	std::sort( loadCells.begin(), loadCells.end(), []( const TerrainCell* lhs, const TerrainCell* rhs ) { return lhs->distance < rhs->distance; } );
+
+	std::vector<TerrainCell*> residentCells;
+
+	for( auto& cell : cells )
+		if( cell.resident )
+			residentCells.push_back( &cell );
+
+	//Farthest Cells are evicted first
+	std::sort( residentCells.begin(), residentCells.end(), []( const TerrainCell* lhs, const TerrainCell* rhs ) { return lhs->distance > rhs->distance; } );
+
+	size_t evictIndex = 0;
+
+	for( auto& cell : loadCells )
+	{
+		//Evict Cells farther than this one until it fits on budget
+		while( streamMemoryUsage + cell->buffersSize > streamMemoryBudget && evictIndex < residentCells.size() && residentCells[evictIndex]->distance > cell->distance )
+			UnloadCell( *residentCells[evictIndex++] );
+
+		if( streamMemoryUsage + cell->buffersSize > streamMemoryBudget )
+			break;
+
+		LoadCell( *cell );
 	}
 }
 
+void Terrain::LoadCell( TerrainCell& cell )
+{
+	Model* streamedModel = model;
+	TerrainCell* streamedCell = &cell;
+
+	//Page in Cooked Geometry on worker
+	auto Read = [streamedModel, streamedCell]()
+	{
+		for( const auto& meshIndex : streamedCell->meshesIndex )
+			streamedModel->PrefetchMeshBuffers( meshIndex );
+
+		return true;
+	};
+
+	auto Create = [streamedModel, streamedCell]()
+	{
+		//Meshes created per call, so Cells are spread across frames
+		const size_t meshesCount = 16;
+
+		size_t meshesEnd = std::min( streamedCell->meshesCreated + meshesCount, streamedCell->meshesIndex.size() );
+
+		for( size_t& i = streamedCell->meshesCreated; i < meshesEnd; i++ )
+			streamedModel->CreateMeshBuffers( streamedCell->meshesIndex[i] );
+
+		return streamedCell->meshesCreated < streamedCell->meshesIndex.size() ? Resource::LoadState::Creating : Resource::LoadState::Loaded;
+	};
+
+	auto Callback = [streamedCell]( Resource::LoadState state )
+	{
+		streamedCell->loadHandle = nullptr;
+
+		if( state == Resource::LoadState::Loaded )
+			streamedCell->node->loaded = true;
+	};
+
+	cell.resident = true;
+	cell.meshesCreated = 0;
+	streamMemoryUsage += cell.buffersSize;
+
+	cell.loadHandle = graphics->GetBackgroundLoader()->Load( Read, Create, Callback, Resource::LoadPriority::Normal );
+}
+
+void Terrain::UnloadCell( TerrainCell& cell )
+{
+	if( !cell.resident )
+		return;
+
+	//Cell still loading
+	if( cell.loadHandle )
+	{
+		graphics->GetBackgroundLoader()->Cancel( cell.loadHandle );
+		cell.loadHandle = nullptr;
+	}
+
+	for( const auto& meshIndex : cell.meshesIndex )
+		model->ReleaseMeshBuffers( meshIndex );
+
+	cell.node->loaded = false;
+	cell.resident = false;
+	cell.meshesCreated = 0;
+	streamMemoryUsage -= cell.buffersSize;
+}
+
 }
\ No newline at end of file
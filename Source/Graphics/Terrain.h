@@ -6,8 +6,27 @@
 #include "Quadtree.h"
 #include "Model.h"
 
+#include "../Resource/BackgroundLoader.h"
+
 namespace Delta3D::Graphics
 {
+const float streamHysteresisDefault = 1.25f;
+const size_t streamMemoryBudgetDefault = 256* 1024* 1024;
+
+struct TerrainCell
+{
+	TerrainCell() : node( nullptr ), buffersSize( 0 ), meshesCreated( 0 ), distance( 0.0f ), loadHandle( nullptr ), resident( false ) {}
+
+	Node* node;	//!< Quadtree Node owning the Meshes
+	Math::BoundingBox boundingBox;	//!< Node Bounding Box on World Space
+	std::vector<size_t> meshesIndex;	//!< Index of Node Meshes on Model
+	size_t buffersSize;	//!< Size in bytes of Meshes Buffers
+	size_t meshesCreated;	//!< Meshes with Buffers created by load request
+	float distance;	//!< Distance from Camera on last update
+	Resource::LoadHandle loadHandle;	//!< Background Loader Request (while loading)
+	bool resident;	//!< Flag to determinate if Cell is loading or loaded (counted on memory budget)
+};
+
 class Terrain : public GraphicsImpl
 {
 public:
@@ -17,11 +36,38 @@ public:
 	//! Deconstructor.
 	~Terrain();
 
-	//! Load Terrain File.
+	//! Load Terrain File (Models are loaded by Background Loader).
 	bool Load( const std::string& filePath );
 
+	//! Check if every Model from Terrain was loaded.
+	bool IsLoaded() const { return pendingModels == 0 && quadTree != nullptr; }
+
 	//! Render Terrain.
 	void Render();
+
+	//! Set distance from Camera where Cells are loaded (0 to use Camera Far Clip).
+	void SetStreamDistance( float streamDistance_ ) { streamDistance = streamDistance_; }
+
+	//! Set factor of stream distance where Cells are unloaded (avoids load/unload on the boundary).
+	void SetStreamHysteresis( float streamHysteresis_ ) { streamHysteresis = std::max( streamHysteresis_, 1.0f ); }
+
+	//! Set max size in bytes of resident Cells Buffers.
+	void SetStreamMemoryBudget( size_t streamMemoryBudget_ ) { streamMemoryBudget = streamMemoryBudget_; }
+
+	//! Get size in bytes of resident Cells Buffers.
+	size_t GetStreamMemoryUsage() const { return streamMemoryUsage; }
+private:
+	//! Create Cells from Quadtree Nodes.
+	void BuildCells();
+
+	//! Load and unload Cells by distance from Camera.
+	void UpdateStreaming();
+
+	//! Queue Cell Buffers to be created by Background Loader.
+	void LoadCell( TerrainCell& cell );
+
+	//! Cancel Cell request and release its Buffers.
+	void UnloadCell( TerrainCell& cell );
 private:
 	int id;	//!< Terrain ID
 
@@ -29,5 +75,15 @@ private:
 	Model* model;	//!< Main model from Terrain
 
 	std::vector<Model*> animatedModels;	//!< Animated Models from Terrain
+
+	std::vector<Resource::LoadHandle> loadHandles;	//!< Background Loader Requests
+	std::vector<Model*> loadingModels;	//!< Animated Models being loaded
+	int pendingModels;	//!< Models not loaded yet
+
+	std::vector<TerrainCell> cells;	//!< Streamed Cells (Quadtree Nodes with Meshes)
+	float streamDistance;	//!< Distance where Cells are loaded
+	float streamHysteresis;	//!< Factor of stream distance where Cells are unloaded
+	size_t streamMemoryBudget;	//!< Max size of resident Cells Buffers
+	size_t streamMemoryUsage;	//!< Size of resident Cells Buffers
 };
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "PrecompiledHeader.h"
 #include "Texture.h"
 
+#include "../IO/FileSystem.h"
+
 namespace Delta3D::Graphics
 {
 
@@ -8,7 +10,13 @@ std::shared_ptr<Texture> Texture::Default = nullptr;
 
 Texture::Texture( IDirect3DTexture9* texture_ ) : 
 	texture( texture_ ), 
-	isLocked( false )
+	isLocked( false ), 
+	sizeBytes( 0 ), 
+	lastUsedFrame( 0 ), 
+	mipLevels( 0 ), 
+	reduceQualityLevel( 0 ), 
+	pending( false ), 
+	loadHandle( nullptr )
 {
 	if( texture )
 	{
@@ -21,7 +29,13 @@ Texture::Texture( IDirect3DTexture9* texture_, std::string filePath_, bool color
 	texture( texture_ ), 
 	filePath( filePath_ ), 
 	colorKey( colorKey_ ), 
-	isLocked( false )
+	isLocked( false ), 
+	sizeBytes( 0 ), 
+	lastUsedFrame( 0 ), 
+	mipLevels( 0 ), 
+	reduceQualityLevel( 0 ), 
+	pending( false ), 
+	loadHandle( nullptr )
 {
 	if( texture )
 	{
@@ -109,10 +123,60 @@ void Texture::UpdateSurfaceDesc()
 			info.width = surfaceDesc.Width;
 			info.height = surfaceDesc.Height;
 		}
+
+		//Bits per Pixel of Format
+		auto BitsPerPixel = []( D3DFORMAT format )
+		{
+			switch( format )
+			{
+			case D3DFMT_DXT1:
+				return 4;
+			case D3DFMT_DXT2:
+			case D3DFMT_DXT3:
+			case D3DFMT_DXT4:
+			case D3DFMT_DXT5:
+			case D3DFMT_L8:
+			case D3DFMT_A8:
+			case D3DFMT_P8:
+				return 8;
+			case D3DFMT_R5G6B5:
+			case D3DFMT_X1R5G5B5:
+			case D3DFMT_A1R5G5B5:
+			case D3DFMT_A4R4G4B4:
+			case D3DFMT_X4R4G4B4:
+			case D3DFMT_A8L8:
+			case D3DFMT_L16:
+				return 16;
+			case D3DFMT_R8G8B8:
+				return 24;
+			case D3DFMT_A16B16G16R16:
+			case D3DFMT_A16B16G16R16F:
+				return 64;
+			case D3DFMT_A32B32G32R32F:
+				return 128;
+			default:
+				return 32;
+			}
+		};
+
+		//Estimate size of every level (DXT levels are made of 4x4 blocks)
+		bool compressed = info.format == D3DFMT_DXT1 || info.format == D3DFMT_DXT2 || info.format == D3DFMT_DXT3 || info.format == D3DFMT_DXT4 || info.format == D3DFMT_DXT5;
+		sizeBytes = 0;
+
+		for( DWORD i = 0; i < texture->GetLevelCount(); i++ )
+		{
+			if( SUCCEEDED( texture->GetLevelDesc( i, &surfaceDesc ) ) )
+			{
+				size_t width = compressed ? std::max<size_t>( surfaceDesc.Width, 4 ) : surfaceDesc.Width;
+				size_t height = compressed ? std::max<size_t>( surfaceDesc.Height, 4 ) : surfaceDesc.Height;
+
+				sizeBytes += width* height* BitsPerPixel( surfaceDesc.Format ) / 8;
+			}
+		}
 	}
 }
 
-TextureFactory::TextureFactory( Graphics* graphics_ ) : graphics( graphics_ )
+TextureFactory::TextureFactory( Graphics* graphics_ ) : graphics( graphics_ ), frameCount( 0 ), memoryBudget( 512* 1024* 1024 ), memoryUsage( 0 )
 {
 }
 
@@ -122,11 +186,15 @@ void TextureFactory::OnLostDevice()
 	{
 		texture->Release();
 	}
+
+	for( auto& ownedTexture : ownedDynamicTextures )
+		if( auto texture = ownedTexture.lock() )
+			texture->Release();
 }
 
 void TextureFactory::OnResetDevice()
 {
-	for( auto& texture : dynamicTextures )
+	auto RenewDynamicTexture = [this]( const std::shared_ptr<Texture>& texture )
 	{
 		//Create Texture
 		IDirect3DTexture9* d3dtexture = CreateDynamicTexture( texture->Width(), texture->Height(), texture->Format() );
@@ -137,7 +205,14 @@ void TextureFactory::OnResetDevice()
 		//Release our Reference
 		if( d3dtexture )
 			d3dtexture->Release();
-	}
+	};
+
+	for( auto& texture : dynamicTextures )
+		RenewDynamicTexture( texture );
+
+	for( auto& ownedTexture : ownedDynamicTextures )
+		if( auto texture = ownedTexture.lock() )
+			RenewDynamicTexture( texture );
 }
 
 void TextureFactory::Reload()
@@ -170,9 +245,14 @@ std::shared_ptr<Texture> TextureFactory::Create( const std::string& filePath, co
 	//Created Object successfully?
 	if( d3dtexture )
 	{
-		std::shared_ptr<Texture> texture = std::make_shared<Texture>( d3dtexture, filePath );
+		std::shared_ptr<Texture> texture = std::make_shared<Texture>( d3dtexture, filePath, useColorKey );
 		d3dtexture->Release();
 
+		//Used to reload it after eviction
+		texture->mipLevels = defaultMipLevels;
+		texture->reduceQualityLevel = reduceQualityLevel;
+		texture->lastUsedFrame = frameCount;
+
 		//Put it on Cache
 		if( !temporary && texture )
 			cache[filePath] = texture;
@@ -185,17 +265,286 @@ std::shared_ptr<Texture> TextureFactory::Create( const std::string& filePath, co
 	return nullptr;
 }
 
+std::shared_ptr<Texture> TextureFactory::CreateAsync( const std::string& filePath, const bool temporary, const bool useColorKey, int defaultMipLevels, bool useTemporaryCache, unsigned int reduceQualityLevel, Resource::LoadPriority priority )
+{
+	//Verify if texture is already on cache
+	if( !temporary && cache.find( filePath ) != cache.end() )
+		return cache[filePath];
+	else if( useTemporaryCache && temporaryCache.find( filePath ) != temporaryCache.end() )
+		return temporaryCache[filePath];
+
+	//Same result of Create when file doesn't exist
+	if( !IO::FileSystem::Get()->Exists( filePath ) )
+		return nullptr;
+
+	//Default Texture is used until it is decoded
+	std::shared_ptr<Texture> texture = std::make_shared<Texture>( Texture::Default ? Texture::Default->Get() : nullptr, filePath, useColorKey );
+	texture->mipLevels = defaultMipLevels;
+	texture->reduceQualityLevel = reduceQualityLevel;
+	texture->lastUsedFrame = frameCount;
+
+	//Put it on Cache
+	if( !temporary )
+		cache[filePath] = texture;
+	else if( useTemporaryCache )
+		temporaryCache[filePath] = texture;
+
+	QueueDecode( texture, useColorKey, priority );
+
+	return texture;
+}
+
+void TextureFactory::QueueDecode( const std::shared_ptr<Texture>& texture, bool useColorKey, Resource::LoadPriority priority )
+{
+	auto job = std::make_shared<TextureDecodeJob>();
+	job->texture = texture;
+	job->filePath = texture->filePath;
+	job->mipLevels = texture->mipLevels;
+	job->reduceQualityLevel = texture->reduceQualityLevel;
+	job->failed = false;
+
+	texture->pending = true;
+
+	auto Read = [job, useColorKey]()
+	{
+		//Texture was released before decode
+		if( !job->texture.expired() )
+			DecodeTexture( *job, useColorKey );
+
+		//Read failures are logged when Texture is filled, so it leaves pending state
+		return true;
+	};
+
+	auto Create = [this, job]()
+	{
+		return CreateDecodedTexture( *job );
+	};
+
+	//Finished requests aren't counted as pending
+	GetPendingCount();
+
+	texture->loadHandle = graphics->GetBackgroundLoader()->Load( Read, Create, nullptr, priority );
+	loadHandles.push_back( texture->loadHandle );
+}
+
+void TextureFactory::EvictTextures()
+{
+	std::vector<std::pair<std::unordered_map<std::string, std::shared_ptr<Texture>>*, std::string>> candidates;
+	memoryUsage = 0;
+
+	for( auto* textures : { &cache, &temporaryCache } )
+	{
+		for( const auto& texture : *textures )
+		{
+			if( texture.second->pending )
+				continue;
+
+			memoryUsage += texture.second->sizeBytes;
+
+			//Used on last frames, Default Texture or referenced by Materials (they stay resident)
+			if( texture.second->lastUsedFrame + 1 >= frameCount || texture.second == Texture::Default || texture.second.use_count() > 1 )
+				continue;
+
+			candidates.push_back( std::make_pair( textures, texture.first ) );
+		}
+	}
+
+	if( memoryBudget == 0 || memoryUsage <= memoryBudget )
+		return;
+
+	//Least recently used first
+	std::sort( candidates.begin(), candidates.end(), []( const auto& lhs, const auto& rhs ) { return (*lhs.first)[lhs.second]->lastUsedFrame < (*rhs.first)[rhs.second]->lastUsedFrame; } );
+
+	for( const auto& candidate : candidates )
+	{
+		if( memoryUsage <= memoryBudget )
+			break;
+
+		auto it = candidate.first->find( candidate.second );
+
+		//Not referenced by anything else, so it's released with the cache entry
+		memoryUsage -= it->second->sizeBytes;
+		candidate.first->erase( it );
+	}
+}
+
+void TextureFactory::Release( std::shared_ptr<Texture>& texture )
+{
+	if( texture == nullptr )
+		return;
+
+	std::string filePath = texture->filePath;
+	texture.reset();
+
+	for( auto* textures : { &cache, &temporaryCache } )
+	{
+		auto it = textures->find( filePath );
+
+		//Referenced only by cache entry
+		if( it != textures->end() && it->second.use_count() == 1 && it->second != Texture::Default )
+		{
+			if( !it->second->pending )
+				memoryUsage -= std::min( memoryUsage, it->second->sizeBytes );
+			else
+				graphics->GetBackgroundLoader()->Cancel( it->second->loadHandle );
+
+			textures->erase( it );
+		}
+	}
+}
+
+void TextureFactory::Update()
+{
+	frameCount++;
+
+	//Keep resident Textures under budget
+	EvictTextures();
+}
+
+Resource::LoadState TextureFactory::CreateDecodedTexture( TextureDecodeJob& job )
+{
+	auto texture = job.texture.lock();
+
+	//Released while decoding
+	if( texture == nullptr )
+		return Resource::LoadState::Canceled;
+
+	texture->pending = false;
+	texture->loadHandle = nullptr;
+
+	if( job.failed )
+	{
+		DELTA3D_LOGERROR( "Could not Read Texture File (%s)", job.filePath.c_str() );
+		return Resource::LoadState::Failed;
+	}
+
+	IDirect3DTexture9* d3dtexture = nullptr;
+
+	if( !job.image.Empty() )
+		d3dtexture = CreateTextureFromImage( job.image );
+	else
+	{
+		//Format not decoded by workers
+		HRESULT hr;
+		d3dtexture = CreateTextureFromFileInMemory( hr, job.fileBuffer.data(), (unsigned int)job.fileBuffer.size(), job.mipLevels == 0 ? D3DX_FROM_FILE : job.mipLevels, job.colorKey, job.reduceQualityLevel );
+
+		if( !d3dtexture || FAILED( hr ) )
+			DELTA3D_LOGERROR( "Could not Create Texture from File (%s) [%08X]", job.filePath.c_str(), hr );
+	}
+
+	if( d3dtexture == nullptr )
+		return Resource::LoadState::Failed;
+
+	//Renew Texture (adds Reference)
+	texture->Renew( d3dtexture );
+	d3dtexture->Release();
+
+	return Resource::LoadState::Loaded;
+}
+
+size_t TextureFactory::GetPendingCount()
+{
+	loadHandles.erase( std::remove_if( loadHandles.begin(), loadHandles.end(), []( const Resource::LoadHandle& handle ) { return handle->IsDone(); } ), loadHandles.end() );
+
+	return loadHandles.size();
+}
+
+void TextureFactory::DecodeTexture( TextureDecodeJob& job, bool useColorKey )
+{
+	Math::Color colorKey( 0.0f, 0.0f, 0.0f, 0.0f );
+
+	if( !ReadTextureFile( job.filePath, job.fileBuffer, colorKey, job.mipLevels, job.mipLevels ) )
+	{
+		job.failed = true;
+		return;
+	}
+
+	job.colorKey = useColorKey ? colorKey : Math::Color( 0.0f, 0.0f, 0.0f, 0.0f );
+
+	const std::string ext = filesystem::path( job.filePath ).extension().string();
+	const unsigned char* data = (const unsigned char*)job.fileBuffer.data();
+
+	if( _stricmp( ext.c_str(), ".bmp" ) == 0 )
+		job.image.DecodeBMP( data, job.fileBuffer.size() );
+	else if( _stricmp( ext.c_str(), ".tga" ) == 0 )
+		job.image.DecodeTGA( data, job.fileBuffer.size() );
+
+	if( job.image.Empty() )
+		return;
+
+	const IO::ImageLevel& base = job.image.GetLevels().front();
+
+	//Non Pow2 sizes are left to D3DX (device may not support them)
+	auto IsPow2 = []( unsigned int value ) { return value && (value & (value - 1)) == 0; };
+
+	if( !IsPow2( base.width ) || !IsPow2( base.height ) || (base.width >> job.reduceQualityLevel) == 0 || (base.height >> job.reduceQualityLevel) == 0 )
+	{
+		job.image.Clear();
+		return;
+	}
+
+	//Decoded, file isn't needed anymore
+	std::vector<char>().swap( job.fileBuffer );
+
+	job.image.ApplyColorKey( job.colorKey.ToUInt() );
+
+	//Same levels as D3DX (mip levels from file is a single level for BMP and TGA)
+	job.image.GenerateMipMaps( (job.mipLevels > 0 ? job.mipLevels : 1) + job.reduceQualityLevel );
+	job.image.DropLevels( job.reduceQualityLevel );
+}
+
+IDirect3DTexture9* TextureFactory::CreateTextureFromImage( const IO::Image& image )
+{
+	const auto& levels = image.GetLevels();
+
+	IDirect3DTexture9* d3dtexture = nullptr;
+
+	HRESULT hr = graphics->GetDevice()->CreateTexture( levels.front().width, levels.front().height, (UINT)levels.size(), 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &d3dtexture, NULL );
+
+	if( FAILED( hr ) || d3dtexture == nullptr )
+	{
+		DELTA3D_LOGERROR( "Could not Create Texture from Image [%08X]", hr );
+		return nullptr;
+	}
+
+	//Fill Levels
+	for( UINT i = 0; i < (UINT)levels.size(); i++ )
+	{
+		D3DLOCKED_RECT lockedRect;
+
+		if( FAILED( d3dtexture->LockRect( i, &lockedRect, nullptr, 0 ) ) )
+			continue;
+
+		const auto& level = levels[i];
+
+		for( unsigned int y = 0; y < level.height; y++ )
+			memcpy( (unsigned char*)lockedRect.pBits + y* lockedRect.Pitch, level.pixels.data() + (size_t)y* level.width, level.width* sizeof( unsigned int ) );
+
+		d3dtexture->UnlockRect( i );
+	}
+
+	return d3dtexture;
+}
+
 std::shared_ptr<Texture> TextureFactory::Create( IDirect3DTexture9* texture )
 {
 	return std::make_shared<Texture>( texture );
 }
 
-std::shared_ptr<Texture> TextureFactory::CreateDynamicTexture( int width, int height )
+std::shared_ptr<Texture> TextureFactory::CreateDynamicTexture( int width, int height, bool shared )
 {
 	//Look for dynamic texture on cache
-	for( auto& texture : dynamicTextures )
-		if( texture->Width() == width && texture->Height() == height )
-			return texture;
+	if( shared )
+	{
+		for( auto& texture : dynamicTextures )
+			if( texture->Width() == width && texture->Height() == height )
+				return texture;
+	}
+	else
+	{
+		//Forget Textures already released by your owners
+		ownedDynamicTextures.erase( std::remove_if( ownedDynamicTextures.begin(), ownedDynamicTextures.end(), []( const std::weak_ptr<Texture>& texture ) { return texture.expired(); } ), ownedDynamicTextures.end() );
+	}
 
 	//Create Texture Object
 	IDirect3DTexture9* d3dtexture = CreateDynamicTexture( width, height, D3DFMT_A32B32G32R32F );
@@ -206,7 +555,10 @@ std::shared_ptr<Texture> TextureFactory::CreateDynamicTexture( int width, int he
 		std::shared_ptr<Texture> texture = std::make_shared<Texture>( d3dtexture );
 		d3dtexture->Release();
 
-		dynamicTextures.push_back( texture );
+		if( shared )
+			dynamicTextures.push_back( texture );
+		else
+			ownedDynamicTextures.push_back( texture );
 
 		return texture;
 	}
@@ -220,76 +572,80 @@ std::shared_ptr<Texture> TextureFactory::CreateSolidColor()
 }
 
 IDirect3DTexture9* TextureFactory::CreateTextureFromFile( const std::string& filePath, const bool useColorKey, int defaultMipLevels, unsigned int reduceQualityLevel )
+{
+	std::vector<char> fileBuffer;
+	Math::Color colorKey( 0.0f, 0.0f, 0.0f, 0.0f );
+	int mipLevels = defaultMipLevels;
+
+	if( ReadTextureFile( filePath, fileBuffer, colorKey, mipLevels, defaultMipLevels ) )
+	{
+		HRESULT hr;
+		IDirect3DTexture9* texture = CreateTextureFromFileInMemory( hr, fileBuffer.data(), (unsigned int)fileBuffer.size(), mipLevels == 0 ? D3DX_FROM_FILE : mipLevels, useColorKey ? colorKey : Math::Color( 0.0f, 0.0f ,0.0f, 0.0f ), reduceQualityLevel );
+
+		//Error
+		if( !texture || FAILED( hr ) )
+			DELTA3D_LOGERROR( "Could not Create Texture from File (%s) [%08X]", filePath.c_str(), hr );
+
+		return texture;
+	}
+
+	return nullptr;
+}
+
+bool TextureFactory::ReadTextureFile( const std::string& filePath, std::vector<char>& buffer, Math::Color& colorKey, int& mipLevels, int defaultMipLevels )
 {
 	filesystem::path fs( filePath );
 
 	//Get File Extension
-	if( filesystem::exists( fs ) && filesystem::is_regular_file( fs ) && fs.has_extension() )
+	if( fs.has_extension() )
 	{
 		const std::string ext = fs.extension().string();
-		std::fstream file( filePath, std::fstream::in | std::fstream::binary );
+		IO::FileView file;
 
-		if( file.is_open() )
+		if( IO::FileSystem::Get()->Open( filePath, file ) )
 		{
-			file.seekg( 0, std::ios::end );
-			std::streamoff fileSize = file.tellg();
-			file.seekg( 0, std::ios::beg );
+			size_t fileSize = file.Size();
 
 			if( fileSize > 0 )
 			{
-				char* fileBuffer = new char[(unsigned int)fileSize];
-				file.read( fileBuffer, fileSize );
+				//Copied, Images are decrypted in place
+				buffer.assign( (const char*)file.Data(), (const char*)file.Data() + fileSize );
 
 				//Can Load texture
 				bool loadTexture = true;
 
 				//Color Key
-				Math::Color colorKey( 0.0f, 0.0f, 0.0f, 0.0f );
+				colorKey = Math::Color( 0.0f, 0.0f, 0.0f, 0.0f );
 
 				//Decrypt Images Firstly
 				if( _strnicmp( ext.c_str(), ".bmp", ext.length() ) == 0 )
 				{
-					loadTexture = DecryptBMP( fileBuffer, (unsigned int)fileSize );
+					loadTexture = DecryptBMP( buffer.data(), (unsigned int)fileSize );
 					colorKey = Math::Color( 0.0f, 0.0f, 0.0f, 1.0f );
 				}
 				else if( _strnicmp( ext.c_str(), ".tga", ext.length() ) == 0 )
-					loadTexture = DecryptTGA( fileBuffer, (unsigned int)fileSize );
+					loadTexture = DecryptTGA( buffer.data(), (unsigned int)fileSize );
 
-				//Create Texture
 				if( loadTexture )
 				{
-					int mipLevels = defaultMipLevels;
+					mipLevels = defaultMipLevels;
 
 					//Look for Mip Level of Texture
 					std::string mipMapFilePath = filePath.substr( 0, filePath.length() - 3 ) + "mip";
-					std::fstream mipMapFile( mipMapFilePath, std::fstream::in | std::fstream::binary );
-
-					if( mipMapFile.is_open() )
-					{
-						mipMapFile.read( (char*)&mipLevels, sizeof( int ) );
-						mipMapFile.close();
-					}
+					IO::FileView mipMapFile;
 
-					HRESULT hr;
-					IDirect3DTexture9* texture = CreateTextureFromFileInMemory( hr, fileBuffer, (unsigned int)fileSize, mipLevels == 0 ? D3DX_FROM_FILE : mipLevels, useColorKey ? colorKey : Math::Color( 0.0f, 0.0f ,0.0f, 0.0f ), reduceQualityLevel );
+					if( IO::FileSystem::Get()->Open( mipMapFilePath, mipMapFile ) && mipMapFile.Size() >= sizeof( int ) )
+						memcpy( &mipLevels, mipMapFile.Data(), sizeof( int ) );
 
-					//Error
-					if( !texture || FAILED( hr ) )
-						DELTA3D_LOGERROR( "Could not Create Texture from File (%s) [%08X]", filePath.c_str(), hr );
-
-					//Delete File Buffer
-					delete[] fileBuffer;
-
-					return texture;
+					return true;
 				}
-
-				//Delete File Buffer
-				delete[] fileBuffer;
 			}
 		}
 	}
 
-	return nullptr;
+	buffer.clear();
+
+	return false;
 }
 
 IDirect3DTexture9* TextureFactory::CreateTextureFromFileInMemory( HRESULT& hr, const char* buffer, unsigned int size, int mipLevels, Math::Color colorKey, unsigned int reduceQualityLevel )
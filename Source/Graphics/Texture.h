@@ -1,9 +1,12 @@
 #pragma once
 
 #include "../Math/Color.h"
+#include "../IO/Image.h"
 
 #include "Graphics.h"
 
+#include "../Resource/BackgroundLoader.h"
+
 namespace Delta3D::Graphics
 {
 class Texture : public std::enable_shared_from_this<Texture>
@@ -52,8 +55,17 @@ public:
 	//! Set Pixel Data.
 	void SetPixelData( void* data, unsigned int size, int offset = 0 );
 
+	//! Get Pitch of Locked Texture in bytes (0 if not locked).
+	int LockedPitch() const { return isLocked ? lockedRect.Pitch : 0; }
+
 	//! Get Image Surface Info.
 	const SurfaceInfo& Info() const { return info; }
+
+	//! Get estimated size in bytes of every level.
+	size_t SizeBytes() const { return sizeBytes; }
+
+	//! Get last frame Texture was used by a Material.
+	unsigned int LastUsedFrame() const { return lastUsedFrame; }
 public:
 	static std::shared_ptr<Texture> Default;	//!< Default Texture
 private:
@@ -66,6 +78,25 @@ private:
 	bool colorKey;	//!< Is Using Color Key
 	bool isLocked;	//!< Flag to determinate if texture is locked
 	D3DLOCKED_RECT lockedRect;	//!< Texture Locked Rectangle
+
+	size_t sizeBytes;	//!< Estimated size of every level
+	unsigned int lastUsedFrame;	//!< Last frame Texture was used
+	int mipLevels;	//!< Mip Levels used to load it (reload)
+	unsigned int reduceQualityLevel;	//!< Reduce Quality Level used to load it (reload)
+	bool pending;	//!< Flag to determinate if Texture is being decoded by workers
+	Resource::LoadHandle loadHandle;	//!< Background Loader request decoding Texture
+};
+
+struct TextureDecodeJob
+{
+	std::weak_ptr<Texture> texture;	//!< Texture to be filled (job is dropped if it was released)
+	std::string filePath;	//!< Texture File Path
+	IO::Image image;	//!< Image decoded by worker (empty if format must be decoded by D3DX)
+	std::vector<char> fileBuffer;	//!< Decrypted File (used by D3DX when image wasn't decoded)
+	int mipLevels;	//!< Mip Levels (0 to use levels from file)
+	Math::Color colorKey;	//!< Color Key
+	unsigned int reduceQualityLevel;	//!< Levels removed to reduce quality
+	bool failed;	//!< Flag to determinate if file couldn't be read
 };
 
 class TextureFactory
@@ -94,6 +125,39 @@ public:
 	 */
 	std::shared_ptr<Texture> Create( const std::string& filePath, const bool temporary = false, const bool useColorKey = true, int defaultMipLevels = 0, bool useTemporaryCache = false, unsigned int reduceQualityLevel = 0 );
 
+	/**
+	 * Create a specified Texture from File Path, file is read, decrypted and decoded by Background Loader workers
+	 * @param filePath File Path from Texture
+	 * @param temporary Boolean to determinate if texture will be temporary (is not added for cache)
+	 * @param priority Priority of Background Loader request
+	 * @return Pointer to Texture (uses Default Texture until Background Loader fills it) or nullptr if file doesn't exist
+	 */
+	std::shared_ptr<Texture> CreateAsync( const std::string& filePath, const bool temporary = false, const bool useColorKey = true, int defaultMipLevels = 0, bool useTemporaryCache = false, unsigned int reduceQualityLevel = 0, Resource::LoadPriority priority = Resource::LoadPriority::Normal );
+
+	//! Evict Textures over budget (device thread).
+	void Update();
+
+	/**
+	 * Mark Texture as used on current frame (called by Material::Apply)
+	 * @param texture Texture used
+	 */
+	void MarkUsed( const std::shared_ptr<Texture>& texture ) { texture->lastUsedFrame = frameCount; }
+
+	/**
+	 * Release a Texture, its cache entry is dropped if nothing else references it (streamed Materials)
+	 * @param texture Texture to be released (reset by this call)
+	 */
+	void Release( std::shared_ptr<Texture>& texture );
+
+	//! Set max size in bytes of cached Textures (0 to disable eviction).
+	void SetMemoryBudget( size_t memoryBudget_ ) { memoryBudget = memoryBudget_; }
+
+	//! Get size in bytes of resident cached Textures (updated by Update).
+	size_t GetMemoryUsage() const { return memoryUsage; }
+
+	//! Get number of Textures being decoded or waiting to be filled.
+	size_t GetPendingCount();
+
 	/**
 	 * Create a specified Texture from Texture Object
 	 * @param texture Texture Object
@@ -105,9 +169,10 @@ public:
 	 * Create Dynamic Texture
 	 * @param width Width of Texture
 	 * @param height Height of Texture
+	 * @param shared Reuse a cached Dynamic Texture of same size (false to create one owned by caller)
 	 * @return Pointer to Texture created
 	 */
-	std::shared_ptr<Texture> CreateDynamicTexture( int width, int height );
+	std::shared_ptr<Texture> CreateDynamicTexture( int width, int height, bool shared = true );
 
 	/**
 	 * Create a Blank Texture
@@ -122,6 +187,44 @@ public:
 	 */
 	IDirect3DTexture9* CreateTextureFromFile( const std::string& filePath, const bool useColorKey, int defaultMipLevels = 0, unsigned int reduceQualityLevel = 0 );
 private:
+	/**
+	 * Read and decrypt a Texture File and its Mip Levels (safe on worker threads)
+	 * @param filePath File Path from Texture
+	 * @param buffer Receive decrypted File
+	 * @param colorKey Receive Color Key used by File Format
+	 * @param mipLevels Receive Mip Levels (defaultMipLevels if there is no .mip File)
+	 * @param defaultMipLevels Default Mip Levels
+	 * @return True if File can be loaded
+	 */
+	static bool ReadTextureFile( const std::string& filePath, std::vector<char>& buffer, Math::Color& colorKey, int& mipLevels, int defaultMipLevels );
+
+	/**
+	 * Decode a Texture File on worker (Image is left empty when format must be decoded by D3DX)
+	 * @param job Decode Job
+	 * @param useColorKey Use Color Key
+	 */
+	static void DecodeTexture( TextureDecodeJob& job, bool useColorKey );
+
+	/**
+	 * Create Texture from an Image decoded by worker
+	 * @param image Decoded Image
+	 * @return Texture Object
+	 */
+	IDirect3DTexture9* CreateTextureFromImage( const IO::Image& image );
+
+	/**
+	 * Fill a Texture decoded by worker (device thread)
+	 * @param job Decode Job
+	 * @return Load State of request
+	 */
+	Resource::LoadState CreateDecodedTexture( TextureDecodeJob& job );
+
+	//! Queue a Texture to be decoded by Background Loader.
+	void QueueDecode( const std::shared_ptr<Texture>& texture, bool useColorKey, Resource::LoadPriority priority );
+
+	//! Evict least recently used Textures not referenced by anything else until cached Textures fit on budget.
+	void EvictTextures();
+
 	/**
 	 * Create Texture From File Buffer
 	 * @param hr Error Handling
@@ -144,14 +247,21 @@ private:
 	IDirect3DTexture9* CreateDynamicTexture( int width, int height, D3DFORMAT format );
 
 	//! Decrypt BMP Image.
-	bool DecryptBMP( char* buffer, unsigned int size );
+	static bool DecryptBMP( char* buffer, unsigned int size );
 
 	//! Decrypt TGA Image.
-	bool DecryptTGA( char* buffer, unsigned int size );
+	static bool DecryptTGA( char* buffer, unsigned int size );
 private:
 	std::unordered_map<std::string,std::shared_ptr<Texture>> cache;	//!< Cache of Texture's
 	std::unordered_map<std::string,std::shared_ptr<Texture>> temporaryCache;	//!< Cache for Temporary Texture's
 	std::vector<std::shared_ptr<Texture>> dynamicTextures;	//!< Dynamic Textures
+	std::vector<std::weak_ptr<Texture>> ownedDynamicTextures;	//!< Dynamic Textures owned by callers (not shared, kept to be reset)
+
+	std::vector<Resource::LoadHandle> loadHandles;	//!< Background Loader requests decoding Textures
+
+	unsigned int frameCount;	//!< Frames Counter (Textures last use)
+	size_t memoryBudget;	//!< Max size of resident cached Textures
+	size_t memoryUsage;	//!< Size of resident cached Textures
 
 	Graphics* graphics;	//!< Graphics Pointer
 };
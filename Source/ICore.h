@@ -1,4 +1,5 @@
 #pragma once
 
 #include "Core/EventsImpl.h"
-#include "Core/TimerImpl.h"
\ No newline at end of file
+#include "Core/TimerImpl.h"
+#include "Core/ThreadPool.h"
\ No newline at end of file
@@ -24,4 +24,5 @@
 #include "Graphics/Quadtree.h"
 #include "Graphics/Terrain.h"
 #include "Graphics/Particle.h"
-#include "Graphics/Graphics.h"
\ No newline at end of file
+#include "Graphics/Graphics.h"
+#include "Graphics/PoseCache.h"
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "IO/Log.h"
+#include "IO/Span.h"
+#include "IO/MappedFile.h"
+#include "IO/FileSystem.h"
+#include "IO/BinaryReader.h"
+#include "IO/Hash.h"
+#include "IO/Image.h"
 
 //SMD Format:
 #include "IO/SMD/Face.h"
@@ -11,4 +17,7 @@
 #include "IO/SMD/ObjectInfo.h"
 #include "IO/SMD/KeyPosition.h"
 #include "IO/SMD/KeyRotation.h"
-#include "IO/SMD/KeyScale.h"
\ No newline at end of file
+#include "IO/SMD/KeyScale.h"
+#include "IO/SMD/MeshLoader.h"
+#include "IO/SMD/MeshGeometry.h"
+#include "IO/SMD/MeshCache.h"
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "PrecompiledHeader.h"
+#include "BinaryReader.h"
+
+namespace Delta3D::IO
+{
+bool BinaryReader::Read( void* out, size_t length )
+{
+	if( !good || length > size - offset )
+	{
+		good = false;
+		return false;
+	}
+
+	memcpy( out, data + offset, length );
+	offset += length;
+
+	return true;
+}
+
+bool BinaryReader::Skip( size_t length )
+{
+	if( !good || length > size - offset )
+	{
+		good = false;
+		return false;
+	}
+
+	offset += length;
+
+	return true;
+}
+
+bool BinaryReader::Seek( size_t position )
+{
+	if( position > size )
+	{
+		good = false;
+		return false;
+	}
+
+	offset = position;
+
+	return true;
+}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Span.h"
+
+namespace Delta3D::IO
+{
+class BinaryReader
+{
+public:
+	//! Default Constructor for Binary Reader.
+	BinaryReader() : data( nullptr ), size( 0 ), offset( 0 ), good( true ) {}
+
+	//! Construct a Binary Reader over a memory range.
+	BinaryReader( const void* data_, size_t size_ ) : data( (const unsigned char*)data_ ), size( size_ ), offset( 0 ), good( true ) {}
+
+	/**
+	 * Copy bytes from current position
+	 * @param out Buffer to receive data
+	 * @param length Number of bytes to read
+	 * @return True if range was inside of data
+	 */
+	bool Read( void* out, size_t length );
+
+	//! Read a trivially copyable value.
+	template<typename T>
+	bool Read( T& out ) { return Read( &out, sizeof( T ) ); }
+
+	/**
+	 * Get a view of elements from current position without copy them
+	 * @param count Number of elements
+	 * @return Span over data or an empty Span if range is outside of data
+	 */
+	template<typename T>
+	Span<T> View( size_t count )
+	{
+		if( count == 0 )
+			return Span<T>();
+
+		if( !good || count > (size - offset) / sizeof( T ) )
+		{
+			good = false;
+			return Span<T>();
+		}
+
+		Span<T> span( (const T*)(data + offset), count );
+		offset += count* sizeof( T );
+
+		return span;
+	}
+
+	//! Get a pointer to a single element from current position without copy it.
+	template<typename T>
+	const T* View() { return View<T>( 1 ).Data(); }
+
+	//! Skip a number of bytes.
+	bool Skip( size_t length );
+
+	//! Set absolute position.
+	bool Seek( size_t position );
+
+	//! Get current position.
+	size_t Tell() const { return offset; }
+
+	//! Get data size.
+	size_t Size() const { return size; }
+
+	//! Get remaining bytes.
+	size_t Remaining() const { return size - offset; }
+
+	//! Check if every read was inside of data.
+	bool IsGood() const { return good; }
+private:
+	const unsigned char* data;	//!< Data Pointer
+	size_t size;	//!< Data Size
+	size_t offset;	//!< Current Position
+	bool good;	//!< Flag to determinate if no read failed
+};
+}
\ No newline at end of file
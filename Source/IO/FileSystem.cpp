@@ -0,0 +1,465 @@
+#include "PrecompiledHeader.h"
+#include "FileSystem.h"
+
+#include "Hash.h"
+
+namespace Delta3D::IO
+{
+//Views of zero sized Files point here
+static const unsigned char EmptyData = 0;
+
+FileView::FileView() :
+	file(),
+	view( nullptr ),
+	data( nullptr ),
+	size( 0 )
+{
+}
+
+FileView::~FileView()
+{
+	Close();
+}
+
+void FileView::Close()
+{
+	if( view )
+	{
+		UnmapViewOfFile( view );
+		view = nullptr;
+	}
+
+	file.Close();
+
+	data = nullptr;
+	size = 0;
+}
+
+PackFile::PackFile() :
+	filePath(),
+	file( INVALID_HANDLE_VALUE ),
+	mapping( nullptr ),
+	fileSize( 0 ),
+	entries(),
+	names()
+{
+}
+
+PackFile::~PackFile()
+{
+	Close();
+}
+
+bool PackFile::Open( const std::string& filePath_ )
+{
+	Close();
+
+	file = CreateFileA( filePath_.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr );
+
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER size;
+
+	if( !GetFileSizeEx( file, &size ) || size.QuadPart < (LONGLONG)sizeof( PackHeader ) )
+	{
+		Close();
+		return false;
+	}
+
+	fileSize = (unsigned long long)size.QuadPart;
+
+	auto ReadBlock = [this]( void* buffer, size_t bytes )
+	{
+		DWORD bytesRead = 0;
+		return bytes == 0 || (ReadFile( file, buffer, (DWORD)bytes, &bytesRead, nullptr ) && bytesRead == bytes);
+	};
+
+	//Header
+	PackHeader header;
+
+	if( !ReadBlock( &header, sizeof( PackHeader ) ) || memcmp( header.magic, PackMagic, sizeof( PackMagic ) ) != 0 || header.version != PackVersion )
+	{
+		DELTA3D_LOGERROR( "Invalid Pack Header on %s", filePath_.c_str() );
+
+		Close();
+		return false;
+	}
+
+	//Table of Contents must fit on file (a corrupt count would allocate anything)
+	unsigned long long tableSize = (unsigned long long)header.entriesCount* sizeof( PackEntry ) + header.namesSize;
+
+	if( tableSize > fileSize - sizeof( PackHeader ) )
+	{
+		DELTA3D_LOGERROR( "Invalid Pack Table of Contents on %s", filePath_.c_str() );
+
+		Close();
+		return false;
+	}
+
+	//Table of Contents is read once, Files are mapped on demand
+	entries.resize( header.entriesCount );
+	names.resize( header.namesSize );
+
+	if( !ReadBlock( entries.data(), entries.size()* sizeof( PackEntry ) ) || !ReadBlock( names.data(), names.size() ) )
+	{
+		DELTA3D_LOGERROR( "Invalid Pack Table of Contents on %s", filePath_.c_str() );
+
+		Close();
+		return false;
+	}
+
+	for( const auto& entry : entries )
+	{
+		if( entry.offset > fileSize || entry.size > fileSize - entry.offset || (unsigned long long)entry.nameOffset + entry.nameLength > names.size() )
+		{
+			DELTA3D_LOGERROR( "Invalid Pack Entry on %s", filePath_.c_str() );
+
+			Close();
+			return false;
+		}
+	}
+
+	mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+	if( mapping == nullptr )
+	{
+		DELTA3D_LOGERROR( "Could not create file mapping for %s", filePath_.c_str() );
+
+		Close();
+		return false;
+	}
+
+	filePath = filePath_;
+
+	return true;
+}
+
+void PackFile::Close()
+{
+	if( mapping )
+	{
+		CloseHandle( mapping );
+		mapping = nullptr;
+	}
+
+	if( file != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( file );
+		file = INVALID_HANDLE_VALUE;
+	}
+
+	filePath.clear();
+	fileSize = 0;
+	entries.clear();
+	names.clear();
+}
+
+const PackEntry* PackFile::Find( const std::string& normalizedPath, unsigned long long hash ) const
+{
+	auto it = std::lower_bound( entries.begin(), entries.end(), hash, []( const PackEntry& entry, unsigned long long value ) { return entry.hash < value; } );
+
+	//Same hash can be shared by different Paths
+	for( ; it != entries.end() && it->hash == hash; ++it )
+		if( it->nameLength == normalizedPath.length() && memcmp( names.data() + it->nameOffset, normalizedPath.data(), it->nameLength ) == 0 )
+			return &(*it);
+
+	return nullptr;
+}
+
+bool PackFile::Map( const PackEntry* entry, FileView& view ) const
+{
+	view.Close();
+
+	if( entry == nullptr || mapping == nullptr )
+		return false;
+
+	if( entry->size == 0 )
+	{
+		view.data = &EmptyData;
+		return true;
+	}
+
+	static DWORD allocationGranularity = []()
+	{
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo( &systemInfo );
+
+		return systemInfo.dwAllocationGranularity;
+	}();
+
+	//View must start on allocation granularity
+	unsigned long long viewOffset = entry->offset - (entry->offset % allocationGranularity);
+	size_t viewSize = (size_t)(entry->offset - viewOffset + entry->size);
+
+	view.view = MapViewOfFile( mapping, FILE_MAP_READ, (DWORD)(viewOffset >> 32), (DWORD)(viewOffset & 0xFFFFFFFF), viewSize );
+
+	if( view.view == nullptr )
+	{
+		DELTA3D_LOGERROR( "Could not map view of %s", filePath.c_str() );
+		return false;
+	}
+
+	view.data = (const unsigned char*)view.view + (entry->offset - viewOffset);
+	view.size = (size_t)entry->size;
+
+	return true;
+}
+
+void PackWriter::Add( const std::string& filePath, std::vector<char> data )
+{
+	files[FileSystem::NormalizePath( filePath )] = std::move( data );
+}
+
+bool PackWriter::AddFile( const std::string& filePath, const std::string& diskFilePath )
+{
+	std::ifstream file( diskFilePath, std::ifstream::in | std::ifstream::binary );
+
+	if( !file.is_open() )
+	{
+		DELTA3D_LOGERROR( "Could not open %s to Pack", diskFilePath.c_str() );
+		return false;
+	}
+
+	std::vector<char> data( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+	Add( filePath, std::move( data ) );
+
+	return true;
+}
+
+bool PackWriter::Save( const std::string& filePath )
+{
+	const unsigned long long dataAlignment = 16;
+
+	std::vector<PackEntry> entries;
+	std::vector<const std::vector<char>*> entriesData;
+	std::string names;
+
+	entries.reserve( files.size() );
+	entriesData.reserve( files.size() );
+
+	for( const auto& file : files )
+	{
+		PackEntry entry;
+		entry.hash = Hash64( file.first.data(), file.first.length() );
+		entry.offset = 0;
+		entry.size = file.second.size();
+		entry.nameOffset = (unsigned int)names.length();
+		entry.nameLength = (unsigned int)file.first.length();
+
+		names += file.first;
+		entries.push_back( entry );
+		entriesData.push_back( &file.second );
+	}
+
+	//Sorted by hash, so Files can be found by binary search
+	std::vector<size_t> order( entries.size() );
+	for( size_t i = 0; i < order.size(); i++ )
+		order[i] = i;
+
+	std::sort( order.begin(), order.end(), [&entries]( size_t lhs, size_t rhs ) { return entries[lhs].hash < entries[rhs].hash; } );
+
+	std::vector<PackEntry> sortedEntries;
+	std::vector<const std::vector<char>*> sortedData;
+	sortedEntries.reserve( entries.size() );
+	sortedData.reserve( entries.size() );
+
+	for( size_t index : order )
+	{
+		sortedEntries.push_back( entries[index] );
+		sortedData.push_back( entriesData[index] );
+	}
+
+	//Data starts after Table of Contents
+	unsigned long long offset = sizeof( PackHeader ) + sortedEntries.size()* sizeof( PackEntry ) + names.length();
+
+	for( auto& entry : sortedEntries )
+	{
+		offset = (offset + dataAlignment - 1) & ~(dataAlignment - 1);
+		entry.offset = offset;
+		offset += entry.size;
+	}
+
+	std::ofstream file( filePath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+
+	if( !file.is_open() )
+	{
+		DELTA3D_LOGERROR( "Could not create Pack %s", filePath.c_str() );
+		return false;
+	}
+
+	PackHeader header;
+	memcpy( header.magic, PackMagic, sizeof( PackMagic ) );
+	header.version = PackVersion;
+	header.entriesCount = (unsigned int)sortedEntries.size();
+	header.namesSize = (unsigned int)names.length();
+
+	file.write( (const char*)&header, sizeof( PackHeader ) );
+	file.write( (const char*)sortedEntries.data(), sortedEntries.size()* sizeof( PackEntry ) );
+	file.write( names.data(), names.length() );
+
+	const char padding[16] = { 0 };
+
+	for( size_t i = 0; i < sortedEntries.size(); i++ )
+	{
+		unsigned long long position = (unsigned long long)file.tellp();
+		file.write( padding, (std::streamsize)(sortedEntries[i].offset - position) );
+		file.write( sortedData[i]->data(), sortedData[i]->size() );
+	}
+
+	if( !file.good() )
+	{
+		DELTA3D_LOGERROR( "Could not write Pack %s", filePath.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+FileSystem::FileSystem() :
+	packs(),
+	mutex(),
+	useLooseFiles( true ),
+	packOpensCount( 0 ),
+	looseOpensCount( 0 )
+{
+}
+
+FileSystem::~FileSystem()
+{
+	UnmountAll();
+}
+
+bool FileSystem::Mount( const std::string& filePath )
+{
+	auto pack = std::make_unique<PackFile>();
+
+	if( !pack->Open( filePath ) )
+	{
+		DELTA3D_LOGERROR( "Could not mount Pack %s", filePath.c_str() );
+		return false;
+	}
+
+	DELTA3D_LOGINFO( "Mounted Pack %s (%d files)", filePath.c_str(), (int)pack->GetEntriesCount() );
+
+	std::lock_guard<std::mutex> lock( mutex );
+	packs.push_back( std::move( pack ) );
+
+	return true;
+}
+
+void FileSystem::UnmountAll()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	packs.clear();
+}
+
+bool FileSystem::Exists( const std::string& filePath )
+{
+	if( filePath.empty() )
+		return false;
+
+	std::string normalizedPath = NormalizePath( filePath );
+	unsigned long long hash = Hash64( normalizedPath.data(), normalizedPath.length() );
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		for( const auto& pack : packs )
+			if( pack->Find( normalizedPath, hash ) )
+				return true;
+	}
+
+	if( !useLooseFiles )
+		return false;
+
+	std::error_code error;
+	return filesystem::is_regular_file( filePath, error );
+}
+
+bool FileSystem::Open( const std::string& filePath, FileView& view )
+{
+	view.Close();
+
+	if( filePath.empty() )
+		return false;
+
+	std::string normalizedPath = NormalizePath( filePath );
+	unsigned long long hash = Hash64( normalizedPath.data(), normalizedPath.length() );
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		//Last mounted Pack first
+		for( auto it = packs.rbegin(); it != packs.rend(); ++it )
+		{
+			if( auto entry = (*it)->Find( normalizedPath, hash ) )
+			{
+				packOpensCount++;
+				return (*it)->Map( entry, view );
+			}
+		}
+	}
+
+	if( !useLooseFiles )
+		return false;
+
+	if( view.file.Open( filePath ) )
+	{
+		looseOpensCount++;
+
+		view.data = view.file.Data();
+		view.size = view.file.Size();
+
+		return true;
+	}
+
+	//Empty files can't be mapped, but they exist
+	std::error_code error;
+	if( filesystem::is_regular_file( filePath, error ) && filesystem::file_size( filePath, error ) == 0 )
+	{
+		looseOpensCount++;
+
+		view.data = &EmptyData;
+		return true;
+	}
+
+	return false;
+}
+
+bool FileSystem::Read( const std::string& filePath, std::vector<char>& buffer )
+{
+	FileView view;
+
+	if( !Open( filePath, view ) )
+	{
+		buffer.clear();
+		return false;
+	}
+
+	buffer.assign( (const char*)view.Data(), (const char*)view.Data() + view.Size() );
+
+	return true;
+}
+
+std::string FileSystem::NormalizePath( const std::string& filePath )
+{
+	std::string normalizedPath;
+	normalizedPath.reserve( filePath.length() );
+
+	for( char c : filePath )
+		normalizedPath.push_back( c == '/' ? '\\' : (char)tolower( (unsigned char)c ) );
+
+	while( normalizedPath.compare( 0, 2, ".\\" ) == 0 )
+		normalizedPath.erase( 0, 2 );
+
+	return normalizedPath;
+}
+
+FileSystem* FileSystem::Get()
+{
+	static FileSystem fileSystem;
+
+	return &fileSystem;
+}
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "MappedFile.h"
+
+namespace Delta3D::IO
+{
+static constexpr char PackMagic[4] = { 'D', '3', 'P', 'K' };
+static constexpr unsigned int PackVersion = 1;
+
+struct PackHeader
+{
+	char magic[4];	//!< Pack Identifier (PackMagic)
+	unsigned int version;	//!< Pack Format Version
+	unsigned int entriesCount;	//!< Entries on Table of Contents
+	unsigned int namesSize;	//!< Size in bytes of Names block (after Entries)
+};
+
+struct PackEntry
+{
+	unsigned long long hash;	//!< Hash of normalized File Path (entries are sorted by it)
+	unsigned long long offset;	//!< Offset of File Data from start of Pack
+	unsigned long long size;	//!< Size of File Data
+	unsigned int nameOffset;	//!< Offset of normalized File Path on Names block
+	unsigned int nameLength;	//!< Length of normalized File Path
+};
+
+class FileView
+{
+friend class PackFile;
+friend class FileSystem;
+public:
+	//! Default Constructor for File View.
+	FileView();
+
+	//! Deconstructor.
+	~FileView();
+
+	//! File Views can't be copied.
+	FileView( const FileView& ) = delete;
+	FileView& operator=( const FileView& ) = delete;
+
+	//! Unmap File.
+	void Close();
+
+	//! Check if File is mapped.
+	bool IsOpen() const { return data != nullptr; }
+
+	//! Data Getter.
+	const unsigned char* Data() const { return data; }
+
+	//! Size Getter.
+	size_t Size() const { return size; }
+private:
+	MappedFile file;	//!< Loose File
+	const void* view;	//!< Mapped View of Pack range (starts on allocation granularity)
+	const unsigned char* data;	//!< File Data
+	size_t size;	//!< Size of File Data
+};
+
+class PackFile
+{
+public:
+	//! Default Constructor for Pack File.
+	PackFile();
+
+	//! Deconstructor.
+	~PackFile();
+
+	//! Pack Files can't be copied.
+	PackFile( const PackFile& ) = delete;
+	PackFile& operator=( const PackFile& ) = delete;
+
+	/**
+	 * Open a Pack and read your Table of Contents
+	 * @param filePath Path of Pack
+	 * @return True if Pack is valid
+	 */
+	bool Open( const std::string& filePath );
+
+	//! Close Pack (File Views mapped from it must be closed before).
+	void Close();
+
+	/**
+	 * Find a File on Table of Contents
+	 * @param normalizedPath File Path normalized by FileSystem::NormalizePath
+	 * @param hash Hash of normalized File Path
+	 * @return Entry of File or nullptr if not found
+	 */
+	const PackEntry* Find( const std::string& normalizedPath, unsigned long long hash ) const;
+
+	/**
+	 * Map the range of a File
+	 * @param entry Entry of File
+	 * @param view View where range will be mapped
+	 * @return True if range was mapped successfully
+	 */
+	bool Map( const PackEntry* entry, FileView& view ) const;
+
+	//! File Path Getter.
+	const std::string& GetFilePath() const { return filePath; }
+
+	//! Get number of Files on Pack.
+	size_t GetEntriesCount() const { return entries.size(); }
+private:
+	std::string filePath;	//!< Path of Pack
+	HANDLE file;	//!< File Handle
+	HANDLE mapping;	//!< File Mapping Handle
+	unsigned long long fileSize;	//!< Size of Pack
+
+	std::vector<PackEntry> entries;	//!< Table of Contents (sorted by hash)
+	std::vector<char> names;	//!< Names block
+};
+
+class PackWriter
+{
+public:
+	/**
+	 * Add a File from memory
+	 * @param filePath Path used to find File on Pack
+	 * @param data File Data
+	 */
+	void Add( const std::string& filePath, std::vector<char> data );
+
+	/**
+	 * Add a File from disk
+	 * @param filePath Path used to find File on Pack
+	 * @param diskFilePath Path of File on disk
+	 * @return True if File was read
+	 */
+	bool AddFile( const std::string& filePath, const std::string& diskFilePath );
+
+	/**
+	 * Write Pack to disk
+	 * @param filePath Path of Pack
+	 * @return True if Pack was written successfully
+	 */
+	bool Save( const std::string& filePath );
+
+	//! Get number of Files added.
+	size_t GetFilesCount() const { return files.size(); }
+private:
+	std::map<std::string, std::vector<char>> files;	//!< Files by normalized Path (same Path replaces File)
+};
+
+class FileSystem
+{
+public:
+	//! Default Constructor for File System.
+	FileSystem();
+
+	//! Deconstructor.
+	~FileSystem();
+
+	/**
+	 * Mount a Pack, Files on it override loose Files and previously mounted Packs
+	 * @param filePath Path of Pack
+	 * @return True if Pack was mounted
+	 */
+	bool Mount( const std::string& filePath );
+
+	//! Unmount all Packs (File Views mapped from them must be closed before).
+	void UnmountAll();
+
+	//! Set if Files not found on Packs are read from disk.
+	void SetUseLooseFiles( bool useLooseFiles_ ) { useLooseFiles = useLooseFiles_; }
+
+	//! Check if a File exists on Packs or disk.
+	bool Exists( const std::string& filePath );
+
+	/**
+	 * Map a File from Packs or disk
+	 * @param filePath Path of File
+	 * @param view View where File will be mapped
+	 * @return True if File was found and mapped
+	 */
+	bool Open( const std::string& filePath, FileView& view );
+
+	/**
+	 * Read a File from Packs or disk to a buffer
+	 * @param filePath Path of File
+	 * @param buffer Buffer where File will be copied
+	 * @return True if File was found and read
+	 */
+	bool Read( const std::string& filePath, std::vector<char>& buffer );
+
+	//! Get number of Files opened from Packs.
+	size_t GetPackOpensCount() const { return packOpensCount; }
+
+	//! Get number of Files opened from disk.
+	size_t GetLooseOpensCount() const { return looseOpensCount; }
+
+	//! Lower case Path with backslashes and without leading ".\".
+	static std::string NormalizePath( const std::string& filePath );
+
+	//! Get shared File System.
+	static FileSystem* Get();
+private:
+	std::vector<std::unique_ptr<PackFile>> packs;	//!< Mounted Packs (last mounted has priority)
+	std::mutex mutex;	//!< Mutex for Packs
+
+	bool useLooseFiles;	//!< Flag to determinate if disk is used when File isn't on Packs
+	std::atomic<size_t> packOpensCount;	//!< Files opened from Packs
+	std::atomic<size_t> looseOpensCount;	//!< Files opened from disk
+};
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "PrecompiledHeader.h"
+#include "Hash.h"
+
+namespace Delta3D::IO
+{
+unsigned long long Hash64( const void* data, size_t size, unsigned long long seed )
+{
+	const unsigned char* p = (const unsigned char*)data;
+	unsigned long long hash = 0xCBF29CE484222325ULL ^ seed;
+
+	//Hash 8 bytes per step
+	while( size >= sizeof( unsigned long long ) )
+	{
+		unsigned long long word;
+		memcpy( &word, p, sizeof( unsigned long long ) );
+
+		hash = (hash ^ word)* 0x9E3779B97F4A7C15ULL;
+		hash ^= hash >> 32;
+
+		p += sizeof( unsigned long long );
+		size -= sizeof( unsigned long long );
+	}
+
+	//Remaining bytes
+	while( size-- )
+		hash = (hash ^ *(p++))* 0x100000001B3ULL;
+
+	//Final Mix
+	hash ^= hash >> 29;
+	hash *= 0xBF58476D1CE4E5B9ULL;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+}
\ No newline at end of file
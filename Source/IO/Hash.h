@@ -0,0 +1,13 @@
+#pragma once
+
+namespace Delta3D::IO
+{
+/**
+ * Compute a 64-bit Hash of a memory range (fast, not cryptographic)
+ * @param data Pointer to data
+ * @param size Size of data in bytes
+ * @param seed Initial value (used to chain hashes)
+ * @return Hash value
+ */
+unsigned long long Hash64( const void* data, size_t size, unsigned long long seed = 0 );
+}
\ No newline at end of file
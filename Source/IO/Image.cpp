@@ -0,0 +1,297 @@
+#include "PrecompiledHeader.h"
+#include "Image.h"
+
+namespace Delta3D::IO
+{
+template<typename T>
+static bool ReadValue( const unsigned char* data, size_t size, size_t offset, T& out )
+{
+	if( offset + sizeof( T ) > size )
+		return false;
+
+	memcpy( &out, data + offset, sizeof( T ) );
+
+	return true;
+}
+
+static unsigned int PackARGB( unsigned int a, unsigned int r, unsigned int g, unsigned int b )
+{
+	return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+bool Image::DecodeBMP( const unsigned char* data, size_t size )
+{
+	levels.clear();
+
+	unsigned int pixelsOffset = 0;
+	unsigned int headerSize = 0;
+	int width = 0, height = 0;
+	unsigned short bitCount = 0;
+	unsigned int compression = 0;
+	unsigned int paletteCount = 0;
+
+	if( !ReadValue( data, size, 10, pixelsOffset ) || !ReadValue( data, size, 14, headerSize ) || headerSize < 40 )
+		return false;
+
+	ReadValue( data, size, 18, width );
+	ReadValue( data, size, 22, height );
+	ReadValue( data, size, 28, bitCount );
+	ReadValue( data, size, 30, compression );
+	ReadValue( data, size, 46, paletteCount );
+
+	//Only uncompressed Images (BI_RGB or BI_BITFIELDS with 32 bits)
+	if( width <= 0 || height == 0 || !(compression == 0 || (compression == 3 && bitCount == 32)) )
+		return false;
+
+	if( bitCount != 8 && bitCount != 24 && bitCount != 32 )
+		return false;
+
+	bool topDown = height < 0;
+	unsigned int w = (unsigned int)width;
+	unsigned int h = (unsigned int)(topDown ? -height : height);
+	size_t pitch = ((w* bitCount + 31) / 32)* 4;
+
+	if( pixelsOffset + pitch* h > size )
+		return false;
+
+	//Palette (8 bits)
+	const unsigned char* palette = data + 14 + headerSize;
+
+	if( bitCount == 8 )
+	{
+		if( paletteCount == 0 || paletteCount > 256 )
+			paletteCount = 256;
+
+		if( 14 + headerSize + paletteCount* 4 > size )
+			return false;
+	}
+
+	ImageLevel level;
+	level.width = w;
+	level.height = h;
+	level.pixels.resize( (size_t)w* h );
+
+	for( unsigned int y = 0; y < h; y++ )
+	{
+		const unsigned char* row = data + pixelsOffset + pitch* (topDown ? y : h - 1 - y);
+		unsigned int* out = level.pixels.data() + (size_t)y* w;
+
+		for( unsigned int x = 0; x < w; x++ )
+		{
+			if( bitCount == 8 )
+			{
+				unsigned int index = row[x] < paletteCount ? row[x] : 0;
+				const unsigned char* color = palette + index* 4;
+
+				out[x] = PackARGB( 0xFF, color[2], color[1], color[0] );
+			}
+			else
+			{
+				const unsigned char* color = row + x* (bitCount / 8);
+
+				//Alpha of 32 bits BMP is ignored (X8R8G8B8)
+				out[x] = PackARGB( 0xFF, color[2], color[1], color[0] );
+			}
+		}
+	}
+
+	levels.push_back( std::move( level ) );
+
+	return true;
+}
+
+bool Image::DecodeTGA( const unsigned char* data, size_t size )
+{
+	levels.clear();
+
+	if( size < 18 )
+		return false;
+
+	unsigned char idLength = data[0];
+	unsigned char colorMapType = data[1];
+	unsigned char imageType = data[2];
+	unsigned short width = 0, height = 0;
+	unsigned char bitCount = data[16];
+	unsigned char descriptor = data[17];
+
+	ReadValue( data, size, 12, width );
+	ReadValue( data, size, 14, height );
+
+	//Color Mapped Images are left to D3DX
+	if( colorMapType != 0 || width == 0 || height == 0 )
+		return false;
+
+	bool rle = imageType == 10 || imageType == 11;
+	bool grayscale = imageType == 3 || imageType == 11;
+
+	if( !(imageType == 2 || imageType == 3 || rle) )
+		return false;
+
+	if( grayscale ? bitCount != 8 : (bitCount != 24 && bitCount != 32) )
+		return false;
+
+	unsigned int bytesPerPixel = bitCount / 8;
+	size_t pixelsCount = (size_t)width* height;
+	size_t offset = 18 + idLength;
+
+	auto ReadPixel = [&]( const unsigned char* p )
+	{
+		if( grayscale )
+			return PackARGB( 0xFF, p[0], p[0], p[0] );
+
+		return PackARGB( bytesPerPixel == 4 ? p[3] : 0xFF, p[2], p[1], p[0] );
+	};
+
+	std::vector<unsigned int> pixels( pixelsCount );
+
+	if( rle )
+	{
+		size_t i = 0;
+
+		while( i < pixelsCount )
+		{
+			if( offset >= size )
+				return false;
+
+			unsigned char packet = data[offset++];
+			size_t count = std::min<size_t>( (packet & 0x7F) + 1, pixelsCount - i );
+
+			//Run-length Packet
+			if( packet & 0x80 )
+			{
+				if( offset + bytesPerPixel > size )
+					return false;
+
+				unsigned int pixel = ReadPixel( data + offset );
+				offset += bytesPerPixel;
+
+				for( size_t j = 0; j < count; j++ )
+					pixels[i++] = pixel;
+			}
+			//Raw Packet
+			else
+			{
+				if( offset + count* bytesPerPixel > size )
+					return false;
+
+				for( size_t j = 0; j < count; j++, offset += bytesPerPixel )
+					pixels[i++] = ReadPixel( data + offset );
+			}
+		}
+	}
+	else
+	{
+		if( offset + pixelsCount* bytesPerPixel > size )
+			return false;
+
+		for( size_t i = 0; i < pixelsCount; i++, offset += bytesPerPixel )
+			pixels[i] = ReadPixel( data + offset );
+	}
+
+	ImageLevel level;
+	level.width = width;
+	level.height = height;
+
+	//Bottom-up unless descriptor says top-left origin
+	if( descriptor & 0x20 )
+		level.pixels = std::move( pixels );
+	else
+	{
+		level.pixels.resize( pixelsCount );
+
+		for( unsigned int y = 0; y < height; y++ )
+			memcpy( level.pixels.data() + (size_t)y* width, pixels.data() + (size_t)(height - 1 - y)* width, width* sizeof( unsigned int ) );
+	}
+
+	levels.push_back( std::move( level ) );
+
+	return true;
+}
+
+void Image::ApplyColorKey( unsigned int colorKey )
+{
+	if( colorKey == 0 )
+		return;
+
+	for( auto& level : levels )
+		for( auto& pixel : level.pixels )
+			if( pixel == colorKey )
+				pixel = 0;
+}
+
+void Image::GenerateMipMaps( unsigned int levelsCount )
+{
+	if( levels.empty() )
+		return;
+
+	//Keep only base level
+	levels.resize( 1 );
+
+	while( levels.size() < levelsCount )
+	{
+		const ImageLevel& source = levels.back();
+
+		if( source.width == 1 && source.height == 1 )
+			break;
+
+		ImageLevel level;
+		level.width = std::max( source.width >> 1, 1u );
+		level.height = std::max( source.height >> 1, 1u );
+		level.pixels.resize( (size_t)level.width* level.height );
+
+		for( unsigned int y = 0; y < level.height; y++ )
+		{
+			unsigned int y0 = std::min( y* 2, source.height - 1 );
+			unsigned int y1 = std::min( y* 2 + 1, source.height - 1 );
+
+			for( unsigned int x = 0; x < level.width; x++ )
+			{
+				unsigned int x0 = std::min( x* 2, source.width - 1 );
+				unsigned int x1 = std::min( x* 2 + 1, source.width - 1 );
+
+				unsigned int samples[4] =
+				{
+					source.pixels[(size_t)y0* source.width + x0],
+					source.pixels[(size_t)y0* source.width + x1],
+					source.pixels[(size_t)y1* source.width + x0],
+					source.pixels[(size_t)y1* source.width + x1],
+				};
+
+				//Box Filter per channel
+				unsigned int result = 0;
+
+				for( unsigned int shift = 0; shift < 32; shift += 8 )
+				{
+					unsigned int sum = 0;
+
+					for( const auto& sample : samples )
+						sum += (sample >> shift) & 0xFF;
+
+					result |= ((sum + 2) / 4) << shift;
+				}
+
+				level.pixels[(size_t)y* level.width + x] = result;
+			}
+		}
+
+		levels.push_back( std::move( level ) );
+	}
+}
+
+void Image::DropLevels( unsigned int count )
+{
+	count = std::min<unsigned int>( count, levels.empty() ? 0 : (unsigned int)levels.size() - 1 );
+
+	levels.erase( levels.begin(), levels.begin() + count );
+}
+
+size_t Image::SizeBytes() const
+{
+	size_t size = 0;
+
+	for( const auto& level : levels )
+		size += level.pixels.size()* sizeof( unsigned int );
+
+	return size;
+}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+namespace Delta3D::IO
+{
+struct ImageLevel
+{
+	unsigned int width;	//!< Level Width
+	unsigned int height;	//!< Level Height
+	std::vector<unsigned int> pixels;	//!< Pixels (A8R8G8B8, top-down)
+};
+
+class Image
+{
+public:
+	//! Default Constructor for Image.
+	Image() = default;
+
+	//! Deconstructor.
+	~Image() = default;
+
+	/**
+	 * Decode an uncompressed BMP (8, 24 or 32 bits) from memory (safe on worker threads)
+	 * @param data BMP File data (already decrypted)
+	 * @param size Size of data
+	 * @return True if Image was decoded
+	 */
+	bool DecodeBMP( const unsigned char* data, size_t size );
+
+	/**
+	 * Decode a TGA (8 bits grayscale, 24 or 32 bits, raw or RLE) from memory (safe on worker threads)
+	 * @param data TGA File data (already decrypted)
+	 * @param size Size of data
+	 * @return True if Image was decoded
+	 */
+	bool DecodeTGA( const unsigned char* data, size_t size );
+
+	/**
+	 * Replace pixels matching Color Key by transparent black (same as D3DX Color Key)
+	 * @param colorKey Color Key (A8R8G8B8, 0 to disable)
+	 */
+	void ApplyColorKey( unsigned int colorKey );
+
+	/**
+	 * Generate Mip Maps with a box filter
+	 * @param levelsCount Levels Count including base level (capped by full chain)
+	 */
+	void GenerateMipMaps( unsigned int levelsCount );
+
+	/**
+	 * Remove first levels, used to reduce Image quality
+	 * @param count Levels to be removed (at least one level is kept)
+	 */
+	void DropLevels( unsigned int count );
+
+	//! Clear Image.
+	void Clear() { levels.clear(); }
+
+	//! Check if Image has no pixels.
+	bool Empty() const { return levels.empty(); }
+
+	//! Get Levels.
+	const std::vector<ImageLevel>& GetLevels() const { return levels; }
+
+	//! Get Size in bytes of every Level.
+	size_t SizeBytes() const;
+private:
+	std::vector<ImageLevel> levels;	//!< Base Level and Mip Maps
+};
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "PrecompiledHeader.h"
+#include "MappedFile.h"
+
+namespace Delta3D::IO
+{
+MappedFile::MappedFile() :
+	file( INVALID_HANDLE_VALUE ),
+	mapping( nullptr ),
+	data( nullptr ),
+	size( 0 )
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open( const std::string& filePath )
+{
+	Close();
+
+	file = CreateFileA( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	//Empty files can't be mapped
+	if( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart <= 0 )
+	{
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+	if( mapping == nullptr )
+	{
+		DELTA3D_LOGERROR( "Could not create file mapping for %s", filePath.c_str() );
+
+		Close();
+		return false;
+	}
+
+	data = (const unsigned char*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+	if( data == nullptr )
+	{
+		DELTA3D_LOGERROR( "Could not map view of file %s", filePath.c_str() );
+
+		Close();
+		return false;
+	}
+
+	size = (size_t)fileSize.QuadPart;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if( data )
+	{
+		UnmapViewOfFile( data );
+		data = nullptr;
+	}
+
+	if( mapping )
+	{
+		CloseHandle( mapping );
+		mapping = nullptr;
+	}
+
+	if( file != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( file );
+		file = INVALID_HANDLE_VALUE;
+	}
+
+	size = 0;
+}
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+namespace Delta3D::IO
+{
+class MappedFile
+{
+public:
+	//! Default Constructor for Mapped File.
+	MappedFile();
+
+	//! Deconstructor.
+	~MappedFile();
+
+	//! Mapped files can't be copied.
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	/**
+	 * Open a File and map it read-only on memory
+	 * @param filePath Path of File
+	 * @return True if file was mapped successfully
+	 */
+	bool Open( const std::string& filePath );
+
+	//! Unmap and Close File.
+	void Close();
+
+	//! Check if File is mapped.
+	bool IsOpen() const { return data != nullptr; }
+
+	//! Mapped Data Getter.
+	const unsigned char* Data() const { return data; }
+
+	//! Mapped Size Getter.
+	size_t Size() const { return size; }
+private:
+	HANDLE file;	//!< File Handle
+	HANDLE mapping;	//!< File Mapping Handle
+	const unsigned char* data;	//!< Mapped View
+	size_t size;	//!< Size of Mapped View
+};
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "PrecompiledHeader.h"
+#include "KeyCursor.h"
+
+namespace Delta3D::IO::SMD
+{
+KeyLookupStatistics keyLookupStatistics;
+thread_local KeyLookupCounters keyLookupCounters = {};
+
+void FlushKeyLookupStatistics()
+{
+	if( keyLookupCounters.lookups == 0 )
+		return;
+
+	keyLookupStatistics.lookups.fetch_add( keyLookupCounters.lookups, std::memory_order_relaxed );
+	keyLookupStatistics.cursorHits.fetch_add( keyLookupCounters.cursorHits, std::memory_order_relaxed );
+	keyLookupStatistics.searches.fetch_add( keyLookupCounters.searches, std::memory_order_relaxed );
+
+	keyLookupCounters = {};
+}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+namespace Delta3D::IO::SMD
+{
+//! Keyframes scanned forward from the cursor before falling back to a binary search.
+const int keyCursorMaxSteps = 4;
+
+struct KeyCursor
+{
+	int rotation;	//!< Segment of Rotation Track found by last lookup
+	int position;	//!< Segment of Position Track found by last lookup
+	int scaling;	//!< Segment of Scaling Track found by last lookup
+
+	//! Default Constructor (first lookup searches).
+	KeyCursor() : rotation( -1 ), position( -1 ), scaling( -1 ) {}
+};
+
+//! Lookups counted by a thread since its last FlushKeyLookupStatistics.
+struct KeyLookupCounters
+{
+	unsigned long long lookups;	//!< Keyframe lookups
+	unsigned long long cursorHits;	//!< Lookups solved by the cursor segment or the ones right after it
+	unsigned long long searches;	//!< Lookups solved by binary search
+};
+
+struct KeyLookupStatistics
+{
+	std::atomic<unsigned long long> lookups;	//!< Keyframe lookups
+	std::atomic<unsigned long long> cursorHits;	//!< Lookups solved by the cursor segment or the ones right after it
+	std::atomic<unsigned long long> searches;	//!< Lookups solved by binary search (seeks, loops and first lookup)
+
+	//! Reset counters.
+	void Reset() { lookups = 0; cursorHits = 0; searches = 0; }
+};
+
+//! Lookup counters of every Keyframe Track (updated by FlushKeyLookupStatistics).
+extern KeyLookupStatistics keyLookupStatistics;
+
+//! Lookup counters of calling thread (KeyTrack::Find doesn't touch counters shared by Animator workers).
+extern thread_local KeyLookupCounters keyLookupCounters;
+
+//! Add Lookups counted by calling thread to keyLookupStatistics (once per Pose, not once per Lookup).
+void FlushKeyLookupStatistics();
+}
\ No newline at end of file
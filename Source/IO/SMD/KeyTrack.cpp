@@ -0,0 +1,300 @@
+#include "PrecompiledHeader.h"
+#include "KeyTrack.h"
+
+namespace Delta3D::IO::SMD
+{
+//Components other than the largest one of a unit quaternion are inside of [-1/sqrt(2), 1/sqrt(2)]
+static const float quaternionLimit = 0.70710678f;
+static const float quaternionStep = (2.0f* quaternionLimit) / 32767.0f;
+
+KeyTrack::KeyTrack() :
+	keysCount( 0 )
+{
+	memset( minimum, 0, sizeof( minimum ) );
+	memset( scale, 0, sizeof( scale ) );
+}
+
+bool KeyTrack::Build( const Span<KeyRotation>& keys, const Span<Math::Matrix4>& previousRotations )
+{
+	Clear();
+
+	std::vector<int> frames;
+	frames.reserve( keys.Size() );
+
+	for( const auto& key : keys )
+		frames.push_back( key.frame );
+
+	BuildFrames( frames );
+
+	bool pureRotations = true;
+	values.resize( keys.Size()* 6 );
+
+	for( size_t i = 0; i < keys.Size(); i++ )
+	{
+		EncodeQuaternion( Math::Quaternion( keys[i].x, keys[i].y, keys[i].z, keys[i].w ), &values[i* 6] );
+
+		//Previous Rotation is only used as a rotation, so it's stored as a quaternion too
+		Math::Matrix4 previousRotation = i < previousRotations.Size() ? previousRotations[i] : Math::Matrix4();
+		Math::Quaternion q;
+		q.FromRotationMatrix( previousRotation );
+
+		EncodeQuaternion( q, &values[i* 6 + 3] );
+
+		Math::Matrix4 decoded = DecodeQuaternion( &values[i* 6 + 3] ).ToMatrix();
+
+		for( int j = 0; j < 3; j++ )
+			for( int k = 0; k < 3; k++ )
+				if( fabsf( decoded.m[j][k] - previousRotation.m[j][k] ) > 0.01f )
+					pureRotations = false;
+	}
+
+	//Scaled or mirrored Bone, a quaternion would change how it animates
+	if( !pureRotations )
+	{
+		previousMatrices.resize( keys.Size() );
+
+		for( size_t i = 0; i < keys.Size(); i++ )
+			previousMatrices[i] = i < previousRotations.Size() ? previousRotations[i] : Math::Matrix4();
+	}
+
+	return pureRotations;
+}
+
+void KeyTrack::Build( const Span<KeyPosition>& keys )
+{
+	Clear();
+
+	std::vector<int> frames;
+	std::vector<Math::Vector3> vectors;
+	frames.reserve( keys.Size() );
+	vectors.reserve( keys.Size() );
+
+	for( const auto& key : keys )
+	{
+		frames.push_back( key.frame );
+		vectors.push_back( Math::Vector3( key.x, key.y, key.z ) );
+	}
+
+	BuildFrames( frames );
+	BuildVectors( vectors );
+}
+
+void KeyTrack::Build( const Span<KeyScale>& keys )
+{
+	Clear();
+
+	std::vector<int> frames;
+	std::vector<Math::Vector3> vectors;
+	frames.reserve( keys.Size() );
+	vectors.reserve( keys.Size() );
+
+	for( const auto& key : keys )
+	{
+		frames.push_back( key.frame );
+		vectors.push_back( Math::Vector3( (float)key.x, (float)key.y, (float)key.z ) );
+	}
+
+	BuildFrames( frames );
+	BuildVectors( vectors );
+}
+
+void KeyTrack::Clear()
+{
+	keysCount = 0;
+
+	blockFrames.clear();
+	frameOffsets.clear();
+	wideFrames.clear();
+	values.clear();
+	previousMatrices.clear();
+
+	memset( minimum, 0, sizeof( minimum ) );
+	memset( scale, 0, sizeof( scale ) );
+}
+
+size_t KeyTrack::SizeBytes() const
+{
+	return blockFrames.size()* sizeof( int ) + frameOffsets.size()* sizeof( unsigned short ) + wideFrames.size()* sizeof( int ) + values.size()* sizeof( unsigned short ) + previousMatrices.size()* sizeof( Math::Matrix4 ) + sizeof( KeyTrack );
+}
+
+int KeyTrack::Find( int firstKey, int frame, int& cursor ) const
+{
+	keyLookupCounters.lookups++;
+
+	if( firstKey < 0 || keysCount - firstKey < 2 || frame < GetFrame( firstKey ) || frame >= GetFrame( keysCount - 1 ) )
+		return -1;
+
+	//Forward playback stays on the same Segment or moves to the next ones
+	if( cursor >= firstKey && cursor < keysCount - 1 && GetFrame( cursor ) <= frame )
+	{
+		for( int i = cursor, steps = 0; i < keysCount - 1 && steps < keyCursorMaxSteps; i++, steps++ )
+		{
+			if( GetFrame( i + 1 ) > frame )
+			{
+				keyLookupCounters.cursorHits++;
+
+				cursor = i;
+				return i;
+			}
+		}
+	}
+
+	//Seek, last Keyframe is known to be after frame
+	keyLookupCounters.searches++;
+
+	int first = firstKey;
+	int count = keysCount - firstKey;
+
+	while( count > 0 )
+	{
+		int step = count / 2;
+
+		if( GetFrame( first + step ) <= frame )
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+
+	cursor = first - 1;
+	return cursor;
+}
+
+Math::Vector3 KeyTrack::GetVector( int key ) const
+{
+	const unsigned short* v = &values[key* 3];
+
+	__m128 result = _mm_cvtepi32_ps( _mm_set_epi32( 0, v[2], v[1], v[0] ) );
+	result = _mm_add_ps( _mm_mul_ps( result, _mm_loadu_ps( scale ) ), _mm_loadu_ps( minimum ) );
+
+	float out[4];
+	_mm_storeu_ps( out, result );
+
+	return Math::Vector3( out[0], out[1], out[2] );
+}
+
+void KeyTrack::BuildFrames( const std::vector<int>& frames )
+{
+	keysCount = (int)frames.size();
+
+	blockFrames.resize( (frames.size() + keyBlockSize - 1) / keyBlockSize );
+	frameOffsets.resize( frames.size() );
+
+	for( size_t i = 0; i < frames.size(); i++ )
+	{
+		int blockFrame = frames[i - (i % keyBlockSize)];
+		long long offset = (long long)frames[i] - blockFrame;
+
+		//Sparse Keyframes, keep full frames
+		if( offset < 0 || offset > 0xFFFF )
+		{
+			blockFrames.clear();
+			frameOffsets.clear();
+			wideFrames = frames;
+			return;
+		}
+
+		blockFrames[i / keyBlockSize] = blockFrame;
+		frameOffsets[i] = (unsigned short)offset;
+	}
+}
+
+void KeyTrack::BuildVectors( const std::vector<Math::Vector3>& vectors )
+{
+	float maximum[3] = { 0.0f, 0.0f, 0.0f };
+
+	for( size_t i = 0; i < vectors.size(); i++ )
+	{
+		const float v[3] = { vectors[i].x, vectors[i].y, vectors[i].z };
+
+		for( int j = 0; j < 3; j++ )
+		{
+			if( i == 0 || v[j] < minimum[j] )
+				minimum[j] = v[j];
+
+			if( i == 0 || v[j] > maximum[j] )
+				maximum[j] = v[j];
+		}
+	}
+
+	//Track range is split in 65535 steps
+	for( int j = 0; j < 3; j++ )
+		scale[j] = (maximum[j] - minimum[j]) / 65535.0f;
+
+	values.resize( vectors.size()* 3 );
+
+	for( size_t i = 0; i < vectors.size(); i++ )
+	{
+		const float v[3] = { vectors[i].x, vectors[i].y, vectors[i].z };
+
+		for( int j = 0; j < 3; j++ )
+			values[i* 3 + j] = scale[j] > 0.0f ? (unsigned short)std::clamp( (int)lroundf( (v[j] - minimum[j]) / scale[j] ), 0, 0xFFFF ) : 0;
+	}
+}
+
+void KeyTrack::EncodeQuaternion( Math::Quaternion q, unsigned short* out )
+{
+	float length = sqrtf( q.DotProduct( q ) );
+
+	if( length > 0.0f )
+		q = q* (1.0f / length);
+	else
+		q = Math::Quaternion::Identity;
+
+	float c[4] = { q.x, q.y, q.z, q.w };
+
+	int largest = 0;
+	for( int i = 1; i < 4; i++ )
+		if( fabsf( c[i] ) > fabsf( c[largest] ) )
+			largest = i;
+
+	//q and -q are the same rotation, so the largest component is kept positive
+	float signal = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+	for( int i = 0, j = 0; i < 4; i++ )
+	{
+		if( i == largest )
+			continue;
+
+		out[j++] = (unsigned short)std::clamp( (int)lroundf( (c[i]* signal + quaternionLimit) / quaternionStep ), 0, 0x7FFF );
+	}
+
+	//Index of largest component is stored on high bits
+	out[0] |= (unsigned short)((largest >> 1) << 15);
+	out[1] |= (unsigned short)((largest & 1) << 15);
+}
+
+Math::Quaternion KeyTrack::DecodeQuaternion( const unsigned short* in )
+{
+	int largest = ((in[0] >> 15) << 1) | (in[1] >> 15);
+
+	__m128 q = _mm_cvtepi32_ps( _mm_set_epi32( 0, in[2], in[1] & 0x7FFF, in[0] & 0x7FFF ) );
+	q = _mm_add_ps( _mm_mul_ps( q, _mm_set_ps( 0.0f, quaternionStep, quaternionStep, quaternionStep ) ), _mm_set_ps( 0.0f, -quaternionLimit, -quaternionLimit, -quaternionLimit ) );
+
+	//Largest component is rebuilt from unit length
+	__m128 n = _mm_mul_ps( q, q );
+	n = _mm_add_ps( n, _mm_shuffle_ps( n, n, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	n = _mm_add_ps( n, _mm_shuffle_ps( n, n, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+	n = _mm_sqrt_ss( _mm_max_ss( _mm_sub_ss( _mm_set_ss( 1.0f ), n ), _mm_setzero_ps() ) );
+
+	q = _mm_add_ps( q, _mm_set_ps( _mm_cvtss_f32( n ), 0.0f, 0.0f, 0.0f ) );
+
+	//Move components back to your place (decoded as kept components followed by the largest one)
+	switch( largest )
+	{
+	case 0:
+		q = _mm_shuffle_ps( q, q, _MM_SHUFFLE( 2, 1, 0, 3 ) );
+		break;
+	case 1:
+		q = _mm_shuffle_ps( q, q, _MM_SHUFFLE( 2, 1, 3, 0 ) );
+		break;
+	case 2:
+		q = _mm_shuffle_ps( q, q, _MM_SHUFFLE( 2, 3, 1, 0 ) );
+		break;
+	}
+
+	return Math::Quaternion( q );
+}
+}
\ No newline at end of file
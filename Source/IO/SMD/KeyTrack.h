@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../../Math/Vector3.h"
+#include "../../Math/Matrix4.h"
+#include "../../Math/Quaternion.h"
+
+#include "../Span.h"
+#include "KeyRotation.h"
+#include "KeyPosition.h"
+#include "KeyScale.h"
+#include "KeyCursor.h"
+
+namespace Delta3D::IO::SMD
+{
+//! Keyframes sharing the same base frame (frames are stored as 16-bit offsets from it).
+const int keyBlockSize = 16;
+
+class KeyTrack
+{
+public:
+	//! Default Constructor for an empty Track.
+	KeyTrack();
+
+	//! Deconstructor.
+	~KeyTrack() = default;
+
+	/**
+	 * Build a compressed Rotation Track
+	 * @param keys Rotation Keyframes
+	 * @param previousRotations Accumulated Rotation Matrix of each Keyframe
+	 * @return False if a Previous Rotation isn't a pure rotation (Matrices are kept, see GetPreviousMatrix)
+	 */
+	bool Build( const Span<KeyRotation>& keys, const Span<Math::Matrix4>& previousRotations );
+
+	//! Build a compressed Position Track.
+	void Build( const Span<KeyPosition>& keys );
+
+	//! Build a compressed Scaling Track (values are kept on SMD fixed point scale, 256 = 1.0).
+	void Build( const Span<KeyScale>& keys );
+
+	//! Clear Track.
+	void Clear();
+
+	//! Keyframes Count.
+	int Size() const { return keysCount; }
+
+	//! Memory used by Track in bytes.
+	size_t SizeBytes() const;
+
+	//! Get Frame of a Keyframe.
+	int GetFrame( int key ) const { return wideFrames.empty() ? blockFrames[key / keyBlockSize] + frameOffsets[key] : wideFrames[key]; }
+
+	/**
+	 * Find the Keyframe Segment containing a frame (GetFrame( i ) <= frame < GetFrame( i + 1 ))
+	 * @param firstKey First Keyframe of active Motion
+	 * @param frame Frame to be sampled
+	 * @param cursor Segment found by last lookup on this Track (updated with the new one)
+	 * @return Index of first Keyframe of Segment, or -1 if frame is out of Track
+	 */
+	int Find( int firstKey, int frame, int& cursor ) const;
+
+	//! Get Rotation of a Keyframe (Rotation Track).
+	Math::Quaternion GetRotation( int key ) const { return DecodeQuaternion( &values[key* 6] ); }
+
+	//! Get Accumulated Rotation of a Keyframe (Rotation Track).
+	Math::Quaternion GetPreviousRotation( int key ) const { return DecodeQuaternion( &values[key* 6 + 3] ); }
+
+	//! Check if Accumulated Rotations are kept as Matrices (scaled or mirrored Bone).
+	bool HasPreviousMatrices() const { return !previousMatrices.empty(); }
+
+	//! Get Accumulated Rotation Matrix of a Keyframe (only if HasPreviousMatrices).
+	const Math::Matrix4& GetPreviousMatrix( int key ) const { return previousMatrices[key]; }
+
+	//! Get Value of a Keyframe (Position and Scaling Tracks).
+	Math::Vector3 GetVector( int key ) const;
+private:
+	//! Store frames as 16-bit offsets of block base frames (or 32-bit if an offset doesn't fit).
+	void BuildFrames( const std::vector<int>& frames );
+
+	//! Quantize vectors with Track range.
+	void BuildVectors( const std::vector<Math::Vector3>& vectors );
+
+	//! Quantize a unit quaternion to three 15-bit components (the largest one is dropped and rebuilt).
+	static void EncodeQuaternion( Math::Quaternion q, unsigned short* out );
+
+	//! Decode a quaternion written by EncodeQuaternion.
+	static Math::Quaternion DecodeQuaternion( const unsigned short* in );
+private:
+	int keysCount;	//!< Keyframes Count
+
+	std::vector<int> blockFrames;	//!< Base Frame of each block of Keyframes
+	std::vector<unsigned short> frameOffsets;	//!< Frame of each Keyframe relative to your block
+	std::vector<int> wideFrames;	//!< Frames of Track with sparse Keyframes (offsets would overflow)
+
+	std::vector<unsigned short> values;	//!< Quantized Keyframes (3 per Keyframe, 6 on Rotation Track)
+	std::vector<Math::Matrix4> previousMatrices;	//!< Accumulated Rotations that aren't pure rotations, kept as read (Rotation Track)
+	float minimum[4];	//!< Min value of Track (Position and Scaling Tracks)
+	float scale[4];	//!< Quantization step of Track (Position and Scaling Tracks)
+};
+}
\ No newline at end of file
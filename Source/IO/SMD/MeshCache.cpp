@@ -0,0 +1,168 @@
+#include "PrecompiledHeader.h"
+#include "MeshCache.h"
+
+namespace Delta3D::IO::SMD
+{
+//Every array on Cooked File starts aligned to 4 bytes
+static size_t AlignedSize( size_t size ) { return (size + 3) & ~3; }
+
+bool MeshCache::Open( const std::string& filePath, unsigned long long sourceHash, unsigned long long skeletonHash )
+{
+	Close();
+
+	if( !FileSystem::Get()->Open( filePath, file ) )
+		return false;
+
+	BinaryReader reader( file.Data(), file.Size() );
+
+	auto header = reader.View<MeshCacheHeader>();
+
+	if( header == nullptr || memcmp( header->magic, "D3MC", 4 ) != 0 || header->version != Version || header->sourceHash != sourceHash || header->skeletonHash != skeletonHash )
+	{
+		Close();
+		return false;
+	}
+
+	//Views must be aligned, so arrays are read with padding
+	auto ReadArray = [&reader]( auto& out, size_t count )
+	{
+		using Type = std::remove_reference_t<decltype( *out.Data() )>;
+
+		out = reader.View<std::remove_const_t<Type>>( count );
+		reader.Skip( AlignedSize( out.SizeBytes() ) - out.SizeBytes() );
+	};
+
+	//Each Mesh has at least your Entry on file (a corrupt count would allocate anything)
+	if( header->meshCount > (file.Size() - sizeof( MeshCacheHeader )) / sizeof( MeshCacheEntry ) )
+	{
+		Close();
+		return false;
+	}
+
+	bool valid = true;
+	meshes.resize( header->meshCount );
+
+	for( auto& mesh : meshes )
+	{
+		auto entry = reader.View<MeshCacheEntry>();
+
+		if( entry == nullptr || entry->textureCoordsCount > _countof( mesh.textureCoords ) )
+		{
+			valid = false;
+			break;
+		}
+
+		ReadArray( mesh.positions, entry->verticesCount );
+		ReadArray( mesh.normals, entry->verticesCount );
+		ReadArray( mesh.colors, entry->verticesCount );
+
+		for( unsigned int i = 0; i < entry->textureCoordsCount; i++ )
+			ReadArray( mesh.textureCoords[i], entry->verticesCount );
+
+		mesh.textureCoordsCount = entry->textureCoordsCount;
+
+		ReadArray( mesh.blendIndices, entry->blendIndicesCount );
+		ReadArray( mesh.indices, entry->indicesCount );
+		ReadArray( mesh.parts, entry->partsCount );
+		ReadArray( mesh.skinnedVerticesIndex, entry->skinnedVerticesCount );
+
+		//Mesh Parts must be inside of Indices and Indices inside of Vertices
+		for( const auto& part : mesh.parts )
+			if( part.indexStart > mesh.indices.Size() || part.indexCount > mesh.indices.Size() - part.indexStart )
+				valid = false;
+
+		for( const auto& index : mesh.indices )
+			if( index >= entry->verticesCount )
+				valid = false;
+	}
+
+	if( !reader.IsGood() || !valid )
+	{
+		DELTA3D_LOGERROR( "Invalid Cooked Mesh File %s", filePath.c_str() );
+
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshCache::Close()
+{
+	meshes.clear();
+	file.Close();
+}
+
+bool MeshCache::Write( const std::string& filePath, unsigned long long sourceHash, unsigned long long skeletonHash, const std::vector<MeshGeometryView>& geometries )
+{
+	//Write on a temporary file first, so a partial file is never used
+	std::string temporaryFilePath = filePath + ".tmp";
+
+	FILE* file = nullptr;
+	fopen_s( &file, temporaryFilePath.c_str(), "wb" );
+
+	if( file == nullptr )
+		return false;
+
+	bool success = true;
+
+	auto WriteArray = [&]( const auto& span )
+	{
+		static const char padding[4] = { 0 };
+
+		if( span.SizeBytes() && fwrite( span.Data(), span.SizeBytes(), 1, file ) != 1 )
+			success = false;
+
+		if( size_t paddingSize = AlignedSize( span.SizeBytes() ) - span.SizeBytes(); paddingSize && fwrite( padding, paddingSize, 1, file ) != 1 )
+			success = false;
+	};
+
+	MeshCacheHeader header = {};
+	memcpy( header.magic, "D3MC", 4 );
+	header.version = Version;
+	header.sourceHash = sourceHash;
+	header.skeletonHash = skeletonHash;
+	header.meshCount = geometries.size();
+
+	WriteArray( Span<MeshCacheHeader>( &header, 1 ) );
+
+	for( const auto& geometry : geometries )
+	{
+		MeshCacheEntry entry = {};
+		entry.verticesCount = geometry.positions.Size();
+		entry.textureCoordsCount = geometry.textureCoordsCount;
+		entry.blendIndicesCount = geometry.blendIndices.Size();
+		entry.indicesCount = geometry.indices.Size();
+		entry.partsCount = geometry.parts.Size();
+		entry.skinnedVerticesCount = geometry.skinnedVerticesIndex.Size();
+
+		WriteArray( Span<MeshCacheEntry>( &entry, 1 ) );
+		WriteArray( geometry.positions );
+		WriteArray( geometry.normals );
+		WriteArray( geometry.colors );
+
+		for( unsigned int i = 0; i < geometry.textureCoordsCount; i++ )
+			WriteArray( geometry.textureCoords[i] );
+
+		WriteArray( geometry.blendIndices );
+		WriteArray( geometry.indices );
+		WriteArray( geometry.parts );
+		WriteArray( geometry.skinnedVerticesIndex );
+	}
+
+	fclose( file );
+
+	std::error_code error;
+
+	if( success )
+		filesystem::rename( temporaryFilePath, filePath, error );
+
+	if( !success || error )
+	{
+		filesystem::remove( temporaryFilePath, error );
+		return false;
+	}
+
+	return true;
+}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "MeshGeometry.h"
+
+namespace Delta3D::IO::SMD
+{
+struct MeshCacheHeader
+{
+	char magic[4];	//!< File Identifier ("D3MC")
+	unsigned int version;	//!< Format Version
+	unsigned long long sourceHash;	//!< Hash of SMD File used to cook
+	unsigned long long skeletonHash;	//!< Hash of Skeleton Bones used to resolve Bone Indices
+	unsigned int meshCount;	//!< Cooked Meshes Count
+	unsigned int reserved;
+};
+
+struct MeshCacheEntry
+{
+	unsigned int verticesCount;	//!< Vertices Count of Streams
+	unsigned int textureCoordsCount;	//!< Textures Coordinates Channels Count
+	unsigned int blendIndicesCount;	//!< Blend Indices Count (0 or verticesCount)
+	unsigned int indicesCount;	//!< Indices Count
+	unsigned int partsCount;	//!< Mesh Parts Count
+	unsigned int skinnedVerticesCount;	//!< Bone Index per SMD Vertex Count
+};
+
+class MeshCache
+{
+public:
+	//! Cooked Format Version (increase it when layout or welding changes).
+	static const unsigned int Version = 1;
+
+	//! Default Constructor for Mesh Cache.
+	MeshCache() {}
+
+	//! Deconstructor.
+	~MeshCache() { Close(); }
+
+	/**
+	 * Map a Cooked Mesh File and validate it against your source
+	 * @param filePath Path of Cooked File
+	 * @param sourceHash Hash of current SMD File
+	 * @param skeletonHash Hash of current Skeleton Bones (0 if not Skinned Model)
+	 * @return True if Cooked File is valid and up to date
+	 */
+	bool Open( const std::string& filePath, unsigned long long sourceHash, unsigned long long skeletonHash );
+
+	//! Close Cooked File.
+	void Close();
+
+	//! Cooked Meshes Count.
+	size_t GetMeshCount() const { return meshes.size(); }
+
+	//! Get Cooked Mesh Geometry (views over mapped file).
+	const MeshGeometryView* GetMesh( size_t index ) const { return index < meshes.size() ? &meshes[index] : nullptr; }
+
+	/**
+	 * Write a Cooked Mesh File
+	 * @param filePath Path of Cooked File
+	 * @param sourceHash Hash of SMD File
+	 * @param skeletonHash Hash of Skeleton Bones (0 if not Skinned Model)
+	 * @param geometries Geometry of each SMD Object
+	 * @return True if file was written successfully
+	 */
+	static bool Write( const std::string& filePath, unsigned long long sourceHash, unsigned long long skeletonHash, const std::vector<MeshGeometryView>& geometries );
+private:
+	FileView file;	//!< Mapped Cooked File (from Packs or disk)
+	std::vector<MeshGeometryView> meshes;	//!< Cooked Meshes
+};
+}
\ No newline at end of file
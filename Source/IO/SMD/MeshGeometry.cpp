@@ -0,0 +1,179 @@
+#include "PrecompiledHeader.h"
+#include "MeshGeometry.h"
+
+#include "../../Math/Color.h"
+
+namespace Delta3D::IO::SMD
+{
+bool MeshGeometry::Build( const MeshData& data, const std::vector<int>& skinnedVerticesIndex_, int materialsCount )
+{
+	Clear();
+
+	skinnedVerticesIndex = skinnedVerticesIndex_;
+
+	if( data.header == nullptr )
+		return false;
+
+	//Do not build Mesh if it's a Skeleton Mesh
+	if( data.faces.Empty() || _strnicmp( data.header->name, "Bip01", 5 ) == 0 )
+		return false;
+
+	const bool skinnedMesh = !skinnedVerticesIndex.empty();
+	const size_t verticesCount = data.vertices.Size();
+
+	//Textures Coordinates Channels are defined by first Face with Textures Coordinates
+	for( const auto& face : data.faces )
+	{
+		auto texCoord = data.GetTextureLink( face.textureLink );
+
+		if( texCoord == nullptr )
+			continue;
+
+		while( texCoord && textureCoordsCount < _countof( textureCoords ) )
+		{
+			textureCoordsCount++;
+			texCoord = data.GetTextureLink( texCoord->next );
+		}
+
+		break;
+	}
+
+	std::map<PackedVertex, unsigned int> verticesIndex;
+	std::vector<std::vector<unsigned short>> partsIndices;
+
+	//Loop through Mesh Faces
+	for( const auto& face : data.faces )
+	{
+		auto textureLink = data.GetTextureLink( face.textureLink );
+
+		//Material not found, face without textures coordinates or invalid vertices? Do nothing!
+		if( face.v[3] >= materialsCount || !textureLink || face.v[0] >= verticesCount || face.v[1] >= verticesCount || face.v[2] >= verticesCount )
+			continue;
+
+		//Find Mesh Part by current face Material
+		size_t partIndex = 0;
+		for( ; partIndex < parts.size(); partIndex++ )
+			if( parts[partIndex].materialID == face.v[3] )
+				break;
+
+		//Not Found? So create it
+		if( partIndex == parts.size() )
+		{
+			MeshPartGeometry part = {};
+			part.materialID = face.v[3];
+			part.min = Math::Vector3( INFINITY, INFINITY, INFINITY );
+			part.max = Math::Vector3( -INFINITY, -INFINITY, -INFINITY );
+
+			parts.push_back( part );
+			partsIndices.emplace_back();
+		}
+
+		MeshPartGeometry& part = parts[partIndex];
+
+		//Loop through Face Vertices (A,B,C)
+		for( int j = 0; j < 3; j++ )
+		{
+			const Vertex& vertex = data.vertices[face.v[j]];
+			int boneIndex = skinnedMesh && face.v[j] < skinnedVerticesIndex.size() ? skinnedVerticesIndex[face.v[j]] : -1;
+
+			//Temporary Variables used to find Vertex
+			IO::SMD::PackedVertex packedVertex = {};
+			packedVertex.position = Math::Vector3( vertex.x / 256.0f, vertex.y / 256.0f, vertex.z / 256.0f );
+			packedVertex.color = data.vertexColors.Empty() ? -1 : Math::Color( data.vertexColors[face.v[j]].r, data.vertexColors[face.v[j]].g, data.vertexColors[face.v[j]].b ).ToUInt();
+			packedVertex.boneIndex = skinnedMesh ? boneIndex : -1;
+
+			auto texCoord = textureLink;
+			for( unsigned int k = 0; k < textureCoordsCount && texCoord; k++ )
+			{
+				packedVertex.uv[k].u = texCoord->u[j];
+				packedVertex.uv[k].v = texCoord->v[j];
+
+				texCoord = data.GetTextureLink( texCoord->next );
+			}
+
+			//Find Similar Vertex, or push a new one
+			auto it = verticesIndex.find( packedVertex );
+
+			if( it != verticesIndex.end() )
+				partsIndices[partIndex].push_back( it->second );
+			else
+			{
+				unsigned int index = positions.size();
+				verticesIndex[packedVertex] = index;
+
+				positions.push_back( packedVertex.position );
+				normals.push_back( Math::Vector3( vertex.nx / 256.0f, vertex.ny / 256.0f, vertex.nz / 256.0f ) );
+				colors.push_back( packedVertex.color );
+
+				for( unsigned int k = 0; k < textureCoordsCount; k++ )
+					textureCoords[k].push_back( packedVertex.uv[k] );
+
+				if( skinnedMesh )
+					blendIndices.push_back( (float)boneIndex );
+
+				partsIndices[partIndex].push_back( index );
+			}
+
+			//Update Mesh Part Bounding Box
+			part.min = Math::Vector3( std::min( part.min.x, packedVertex.position.x ), std::min( part.min.y, packedVertex.position.y ), std::min( part.min.z, packedVertex.position.z ) );
+			part.max = Math::Vector3( std::max( part.max.x, packedVertex.position.x ), std::max( part.max.y, packedVertex.position.y ), std::max( part.max.z, packedVertex.position.z ) );
+		}
+	}
+
+	//Put Indices of Mesh Parts together
+	for( size_t i = 0; i < parts.size(); i++ )
+	{
+		parts[i].indexStart = indices.size();
+		parts[i].indexCount = partsIndices[i].size();
+
+		indices.insert( indices.end(), partsIndices[i].begin(), partsIndices[i].end() );
+	}
+
+	return !positions.empty();
+}
+
+void MeshGeometry::Clear()
+{
+	positions.clear();
+	normals.clear();
+	colors.clear();
+
+	for( auto& textureCoord : textureCoords )
+		textureCoord.clear();
+
+	textureCoordsCount = 0;
+	blendIndices.clear();
+	indices.clear();
+	parts.clear();
+	skinnedVerticesIndex.clear();
+}
+
+size_t MeshGeometryView::BuffersSize() const
+{
+	size_t size = positions.SizeBytes() + normals.SizeBytes() + colors.SizeBytes() + blendIndices.SizeBytes() + indices.SizeBytes();
+
+	for( unsigned int i = 0; i < textureCoordsCount; i++ )
+		size += textureCoords[i].SizeBytes();
+
+	return size;
+}
+
+MeshGeometryView MeshGeometry::View() const
+{
+	MeshGeometryView view;
+	view.positions = Span<Math::Vector3>( positions.data(), positions.size() );
+	view.normals = Span<Math::Vector3>( normals.data(), normals.size() );
+	view.colors = Span<unsigned int>( colors.data(), colors.size() );
+
+	for( unsigned int i = 0; i < textureCoordsCount; i++ )
+		view.textureCoords[i] = Span<Math::Vector2>( textureCoords[i].data(), textureCoords[i].size() );
+
+	view.textureCoordsCount = textureCoordsCount;
+	view.blendIndices = Span<float>( blendIndices.data(), blendIndices.size() );
+	view.indices = Span<unsigned short>( indices.data(), indices.size() );
+	view.parts = Span<MeshPartGeometry>( parts.data(), parts.size() );
+	view.skinnedVerticesIndex = Span<int>( skinnedVerticesIndex.data(), skinnedVerticesIndex.size() );
+
+	return view;
+}
+}
\ No newline at end of file
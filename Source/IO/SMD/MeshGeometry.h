@@ -0,0 +1,67 @@
+#pragma once
+
+#include "MeshLoader.h"
+
+namespace Delta3D::IO::SMD
+{
+struct MeshPartGeometry
+{
+	int materialID;	//!< Material Index on Material Collection
+	unsigned int indexStart;	//!< First Index of Mesh Part
+	unsigned int indexCount;	//!< Indices Count of Mesh Part
+
+	Math::Vector3 min;	//!< Bounding Box Min
+	Math::Vector3 max;	//!< Bounding Box Max
+};
+
+struct MeshGeometryView
+{
+	Span<Math::Vector3> positions;	//!< Vertex Positions
+	Span<Math::Vector3> normals;	//!< Vertex Normals
+	Span<unsigned int> colors;	//!< Vertex Colors (ARGB)
+	Span<Math::Vector2> textureCoords[8];	//!< Textures Coordinates per channel
+	unsigned int textureCoordsCount;	//!< Textures Coordinates Channels Count
+	Span<float> blendIndices;	//!< Bone Index per Vertex (if Skinned Mesh)
+	Span<unsigned short> indices;	//!< Indices of all Mesh Parts
+	Span<MeshPartGeometry> parts;	//!< Mesh Parts (by material)
+	Span<int> skinnedVerticesIndex;	//!< Bone Index per SMD Vertex (if Skinned Mesh)
+
+	//! Get size in bytes of Vertex and Index Buffers created from Geometry.
+	size_t BuffersSize() const;
+};
+
+class MeshGeometry
+{
+public:
+	//! Default Constructor for Mesh Geometry.
+	MeshGeometry() : textureCoordsCount( 0 ) {}
+
+	//! Deconstructor.
+	~MeshGeometry() = default;
+
+	/**
+	 * Weld SMD Faces into Vertex Streams and split them by Material
+	 * @param data Mesh Data views over the mapped SMD file
+	 * @param skinnedVerticesIndex_ Bone Index per SMD Vertex (empty if not Skinned Mesh)
+	 * @param materialsCount Materials Count on Material Collection
+	 * @return True if Mesh has any geometry to render
+	 */
+	bool Build( const MeshData& data, const std::vector<int>& skinnedVerticesIndex_, int materialsCount );
+
+	//! Clear Geometry.
+	void Clear();
+
+	//! Get Views over Geometry.
+	MeshGeometryView View() const;
+public:
+	std::vector<Math::Vector3> positions;	//!< Vertex Positions
+	std::vector<Math::Vector3> normals;	//!< Vertex Normals
+	std::vector<unsigned int> colors;	//!< Vertex Colors (ARGB)
+	std::vector<Math::Vector2> textureCoords[8];	//!< Textures Coordinates per channel
+	unsigned int textureCoordsCount;	//!< Textures Coordinates Channels Count
+	std::vector<float> blendIndices;	//!< Bone Index per Vertex (if Skinned Mesh)
+	std::vector<unsigned short> indices;	//!< Indices of all Mesh Parts
+	std::vector<MeshPartGeometry> parts;	//!< Mesh Parts (by material)
+	std::vector<int> skinnedVerticesIndex;	//!< Bone Index per SMD Vertex (if Skinned Mesh)
+};
+}
\ No newline at end of file
@@ -3,4 +3,115 @@
 
 namespace Delta3D::IO::SMD
 {
+const FileTextureLink* MeshData::GetTextureLink( unsigned int filePointer ) const
+{
+	if( filePointer == 0 || filePointer < header->textureLinksPointer )
+		return nullptr;
+
+	unsigned int offset = filePointer - header->textureLinksPointer;
+
+	if( offset % sizeof( FileTextureLink ) != 0 )
+		return nullptr;
+
+	return textureLinks.Get( offset / sizeof( FileTextureLink ) );
+}
+
+MeshLoader::MeshLoader() :
+	file(),
+	reader(),
+	header( nullptr ),
+	objects()
+{
+}
+
+MeshLoader::~MeshLoader()
+{
+	Close();
+}
+
+bool MeshLoader::Open( const std::string& filePath )
+{
+	Close();
+
+	if( !FileSystem::Get()->Open( filePath, file ) )
+		return false;
+
+	reader = BinaryReader( file.Data(), file.Size() );
+
+	//Read Header and Objects Info
+	header = reader.View<Header>();
+
+	if( header == nullptr || header->objectCount < 0 || header->frameCount < 0 || header->frameCount > (int)_countof( header->frames ) )
+	{
+		DELTA3D_LOGERROR( "Invalid SMD Header on %s", filePath.c_str() );
+
+		Close();
+		return false;
+	}
+
+	objects = reader.View<ObjectInfo>( header->objectCount );
+
+	if( !reader.IsGood() )
+	{
+		DELTA3D_LOGERROR( "Invalid SMD Objects Info on %s", filePath.c_str() );
+
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshLoader::Close()
+{
+	objects = Span<ObjectInfo>();
+	header = nullptr;
+	reader = BinaryReader();
+	file.Close();
+}
+
+bool MeshLoader::SeekObject( size_t objectIndex )
+{
+	auto objectInfo = objects.Get( objectIndex );
+
+	if( objectInfo == nullptr || objectInfo->filePointerToObject < 0 )
+		return false;
+
+	return reader.Seek( objectInfo->filePointerToObject );
+}
+
+bool MeshLoader::ReadMesh( MeshData& out, bool skinned, bool readVertexColor )
+{
+	out = MeshData();
+	out.header = reader.View<ObjectHeader>();
+
+	if( out.header == nullptr )
+		return false;
+
+	auto Count = []( int count ) { return count > 0 ? (size_t)count : 0; };
+
+	out.vertices = reader.View<Vertex>( Count( out.header->verticesCount ) );
+	out.faces = reader.View<FileFace>( Count( out.header->facesCount ) );
+	out.textureLinks = reader.View<FileTextureLink>( Count( out.header->textureLinksCount ) );
+	out.keyRotations = reader.View<KeyRotation>( Count( out.header->frameRotationCount ) );
+	out.keyPositions = reader.View<KeyPosition>( Count( out.header->framePositionCount ) );
+	out.keyScales = reader.View<KeyScale>( Count( out.header->frameScalingCount ) );
+	out.previousRotations = reader.View<Math::Matrix4>( Count( out.header->frameRotationCount ) );
+
+	//Skinned Mesh has a Bone Name for each Vertex
+	if( skinned )
+		out.boneNames = reader.View<BoneName>( Count( out.header->verticesCount ) );
+
+	//Vertices Colors
+	if( readVertexColor )
+	{
+		bool hasVertexColor = false;
+		reader.Read( hasVertexColor );
+
+		if( hasVertexColor )
+			out.vertexColors = reader.View<VertexColor>( Count( out.header->verticesCount ) );
+	}
+
+	return reader.IsGood();
+}
 }
\ No newline at end of file
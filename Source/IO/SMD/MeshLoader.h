@@ -1,5 +1,174 @@
 #pragma once
 
+#include "../../Math/Vector2.h"
+#include "../../Math/Vector3.h"
+#include "../../Math/Matrix4.h"
+
+#include "Header.h"
+#include "ObjectInfo.h"
+#include "Vertex.h"
+#include "KeyRotation.h"
+#include "KeyPosition.h"
+#include "KeyScale.h"
+
+#include "../FileSystem.h"
+#include "../BinaryReader.h"
+
 namespace Delta3D::IO::SMD
 {
+//Pointers on SMD files are 32-bit values written by the original exporter, so they are stored as integers here
+struct ObjectHeader
+{
+	DWORD header;
+	unsigned int verticesPointer;
+	unsigned int facesPointer;
+	unsigned int textureLinksPointer;
+	char unknown0[28];
+
+	int maxZ;
+	int minZ;
+	int maxY;
+	int minY;
+	int maxX;
+	int minX;
+	char unknown1[16];
+
+	int verticesCount;
+	int facesCount;
+	int textureLinksCount;
+	char unknown2[8];
+
+	float position[3];
+	char unknown3[12];
+
+	int rotation[3];
+	char unknown4[32];
+
+	char name[32];
+	char parentName[32];
+	char unknown5[4];
+
+	int baseFrame[4][4];
+	int baseFrameInverse[4][4];
+	float resultAnimation[4][4];
+	int baseRotation[4][4];
+	int world[4][4];
+	int local[4][4];
+
+	int lastFrame;
+	char unknown6[28];
+
+	int basePosition[3];
+	unsigned int frameRotationPointer;
+	unsigned int framePositionPointer;
+	unsigned int frameScalingPointer;
+	unsigned int previousRotationPointer;
+
+	int frameRotationCount;
+	int framePositionCount;
+	int frameScalingCount;
+
+	Frame framesInfoRotation[32];
+	Frame framesInfoPosition[32];
+	Frame framesInfoScaling[32];
+	int framesInfoCount;
+};
+
+struct FileTextureLink
+{
+	float u[3];
+	float v[3];
+
+	unsigned int texHandle;
+	unsigned int next;
+};
+
+struct FileFace
+{
+	unsigned short v[4];
+
+	float padding[3][2];
+	unsigned int textureLink;
+};
+
+struct BoneName
+{
+	char name[32];
+};
+
+static_assert( sizeof( ObjectHeader ) == 2236, "SMD Object Header size mismatch" );
+static_assert( sizeof( FileTextureLink ) == 32, "SMD Texture Link size mismatch" );
+static_assert( sizeof( FileFace ) == 36, "SMD Face size mismatch" );
+static_assert( sizeof( Math::Matrix4 ) == 64, "SMD Previous Rotation size mismatch" );
+
+struct MeshData
+{
+	const ObjectHeader* header;	//!< Object Header
+
+	Span<Vertex> vertices;	//!< Vertices List
+	Span<FileFace> faces;	//!< Faces List
+	Span<FileTextureLink> textureLinks;	//!< Textures Coordinate List
+	Span<KeyRotation> keyRotations;	//!< Animation Frame Rotation
+	Span<KeyPosition> keyPositions;	//!< Animation Frame Position
+	Span<KeyScale> keyScales;	//!< Animation Frame Scaling
+	Span<Math::Matrix4> previousRotations;	//!< Previous Animation Rotation Matrix
+	Span<BoneName> boneNames;	//!< Bone Name per Vertex (if Skinned Mesh)
+	Span<VertexColor> vertexColors;	//!< Vertices Colors (unaligned, right after a bool flag on file)
+
+	/**
+	 * Resolve a Texture Link Pointer stored on file
+	 * @param filePointer Pointer saved by exporter
+	 * @return Texture Link or nullptr if pointer is null or invalid
+	 */
+	const FileTextureLink* GetTextureLink( unsigned int filePointer ) const;
+};
+
+class MeshLoader
+{
+public:
+	//! Default Constructor for Mesh Loader.
+	MeshLoader();
+
+	//! Deconstructor.
+	~MeshLoader();
+
+	/**
+	 * Map a SMD File (from Packs or disk) and read your Header and Objects Info
+	 * @param filePath Path of SMD File
+	 * @return True if file was mapped and Header is valid
+	 */
+	bool Open( const std::string& filePath );
+
+	//! Close SMD File.
+	void Close();
+
+	//! Mapped File Getter.
+	const FileView& GetFile() const { return file; }
+
+	//! Header Getter.
+	const Header* GetHeader() const { return header; }
+
+	//! Objects Info Getter.
+	const Span<ObjectInfo>& GetObjects() const { return objects; }
+
+	//! Reader positioned after Objects Info (Material Collection starts there).
+	BinaryReader& GetReader() { return reader; }
+
+	//! Set Reader to Object position on File.
+	bool SeekObject( size_t objectIndex );
+
+	/**
+	 * Read Mesh from current Reader position
+	 * @param out Mesh Data views over the mapped file
+	 * @param skinned Mesh has Bone Names per Vertex
+	 * @param readVertexColor Mesh has Vertices Colors
+	 * @return True if whole Mesh is inside of file
+	 */
+	bool ReadMesh( MeshData& out, bool skinned, bool readVertexColor );
+private:
+	FileView file;	//!< Mapped SMD File
+	BinaryReader reader;	//!< Reader over mapped File
+	const Header* header;	//!< SMD Header
+	Span<ObjectInfo> objects;	//!< Objects Info
+};
 }
\ No newline at end of file
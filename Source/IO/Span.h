@@ -0,0 +1,44 @@
+#pragma once
+
+namespace Delta3D::IO
+{
+template<typename T>
+class Span
+{
+public:
+	//! Default Constructor for an empty Span.
+	Span() : data( nullptr ), count( 0 ) {}
+
+	//! Construct a Span over a specified range.
+	Span( const T* data_, size_t count_ ) : data( data_ ), count( count_ ) {}
+
+	//! Pointer to first element.
+	const T* Data() const { return data; }
+
+	//! Elements Count.
+	size_t Size() const { return count; }
+
+	//! Size in bytes of the whole range.
+	size_t SizeBytes() const { return count* sizeof( T ); }
+
+	//! Check if Span is empty.
+	bool Empty() const { return count == 0; }
+
+	/**
+	 * Get a element from Span with bounds checking
+	 * @param index Element index
+	 * @return Pointer to element or nullptr if out of range
+	 */
+	const T* Get( size_t index ) const { return index < count ? data + index : nullptr; }
+
+	//! Index operator (unchecked, use Get for bounds checking).
+	const T& operator[]( size_t index ) const { return data[index]; }
+
+	//! Iterators.
+	const T* begin() const { return data; }
+	const T* end() const { return data + count; }
+private:
+	const T* data;	//!< First Element
+	size_t count;	//!< Elements Count
+};
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
 #pragma once
 
-#include "Resource/AttributeAnimation.h"
\ No newline at end of file
+#include "Resource/AttributeAnimation.h"
+#include "Resource/BackgroundLoader.h"
\ No newline at end of file
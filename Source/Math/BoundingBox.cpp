@@ -91,6 +91,13 @@ Intersection BoundingBox::IsInside( const Vector3& vector ) const
 		return Intersection::Inside;
 }
 
+float BoundingBox::Distance( const Vector3& point ) const
+{
+	Vector3 delta( std::max( { min.x - point.x, 0.0f, point.x - max.x } ), std::max( { min.y - point.y, 0.0f, point.y - max.y } ), std::max( { min.z - point.z, 0.0f, point.z - max.z } ) );
+
+	return delta.Length();
+}
+
 Intersection BoundingBox::IsInside( const BoundingBox& other ) const
 {
 	if( other.max.x < min.x || other.min.x > max.x || other.max.x < min.x || other.min.x > max.x || other.max.z < min.z || other.min.z > max.z )
@@ -75,6 +75,13 @@ public:
 	 */
 	Intersection IsInsideFast( const BoundingBox& other ) const;
 
+	/**
+	 * Return Distance from a Point to this Bounding Box.
+	 * @param point Point.
+	 * @return Distance (zero if point is inside).
+	 */
+	float Distance( const Vector3& point ) const;
+
 	/**
 	 * Return Bounding Box Center.
 	 */
@@ -6,6 +6,15 @@ namespace Delta3D::Math
 
 const Quaternion Quaternion::Identity( 0.0f, 0.0f, 0.0f, 1.0f );
 
+Quaternion Quaternion::operator*( const Quaternion& other ) const
+{
+	return Quaternion(
+		w* other.x + x* other.w + y* other.z - z* other.y,
+		w* other.y - x* other.z + y* other.w + z* other.x,
+		w* other.z + x* other.y - y* other.x + z* other.w,
+		w* other.w - x* other.x - y* other.y - z* other.z );
+}
+
 Matrix4 Quaternion::ToMatrix() const
 {
 	Matrix4 result;
@@ -116,4 +125,50 @@ Quaternion& Quaternion::FromEulerAngles( float x_, float y_, float z_ )
 	return *this;
 }
 
+Quaternion& Quaternion::FromRotationMatrix( const Matrix4& matrix )
+{
+	const auto& m = matrix.m;
+	float trace = m[0][0] + m[1][1] + m[2][2];
+
+	//Largest component is computed first, so the division is stable
+	if( trace > 0.0f )
+	{
+		float s = 0.5f / sqrtf( trace + 1.0f );
+
+		w = 0.25f / s;
+		x = ( m[2][1] - m[1][2] )* s;
+		y = ( m[0][2] - m[2][0] )* s;
+		z = ( m[1][0] - m[0][1] )* s;
+	}
+	else if( m[0][0] > m[1][1] && m[0][0] > m[2][2] )
+	{
+		float s = 2.0f* sqrtf( 1.0f + m[0][0] - m[1][1] - m[2][2] );
+
+		w = ( m[2][1] - m[1][2] ) / s;
+		x = 0.25f* s;
+		y = ( m[0][1] + m[1][0] ) / s;
+		z = ( m[0][2] + m[2][0] ) / s;
+	}
+	else if( m[1][1] > m[2][2] )
+	{
+		float s = 2.0f* sqrtf( 1.0f + m[1][1] - m[0][0] - m[2][2] );
+
+		w = ( m[0][2] - m[2][0] ) / s;
+		x = ( m[0][1] + m[1][0] ) / s;
+		y = 0.25f* s;
+		z = ( m[1][2] + m[2][1] ) / s;
+	}
+	else
+	{
+		float s = 2.0f* sqrtf( 1.0f + m[2][2] - m[0][0] - m[1][1] );
+
+		w = ( m[1][0] - m[0][1] ) / s;
+		x = ( m[0][2] + m[2][0] ) / s;
+		y = ( m[1][2] + m[2][1] ) / s;
+		z = 0.25f* s;
+	}
+
+	return *this;
+}
+
 }
\ No newline at end of file
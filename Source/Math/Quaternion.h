@@ -41,6 +41,9 @@ public:
 		return Quaternion( _mm_xor_ps( _mm_loadu_ps( &x ), _mm_castsi128_ps( _mm_set1_epi32( (int)0x80000000UL ) ) ) );
 	}
 
+	//! Multiply operator with a Quaternion (rotation of other followed by this, as ToMatrix of both multiplied).
+	Quaternion operator *( const Quaternion& other ) const;
+
 	//! Multiply a Vector3.
 	Vector3 operator *( const Vector3& other ) const
 	{
@@ -124,6 +127,13 @@ public:
 	 */
 	Quaternion& FromEulerAngles( float x_, float y_, float z_ );
 
+	/**
+	 * Get quaternion from the rotation part of a Matrix (inverse of ToMatrix)
+	 * @param matrix Rotation Matrix (orthonormal)
+	 * @return this reference
+	 */
+	Quaternion& FromRotationMatrix( const Matrix4& matrix );
+
 	float x;	//!< X Coordinate
 	float y;	//!< Y Coordinate
 	float z;	//!< Z Coordinate
@@ -1,6 +1,8 @@
 #include "PrecompiledHeader.h"
 #include "AttributeAnimation.h"
 
+#include "../IO/FileSystem.h"
+
 namespace Delta3D::Resource
 {
 
@@ -23,9 +25,19 @@ void AttributeAnimation::Update( float elapsedTime )
 
 void AttributeAnimationFactory::Reload()
 {
+	filesData.clear();
+
 	for( const auto& p : cache )
+	{
 		if( p.second )
-			CreateFromXML( p.second, p.second->GetFilePath(), p.second->GetAnimationIndex() );
+		{
+			const auto& animations = GetFileData( p.second->GetFilePath() );
+			int index = p.second->GetAnimationIndex();
+
+			if( index >= 0 && index < (int)animations.size() )
+				CreateFromData( p.second, animations[index] );
+		}
+	}
 }
 
 std::shared_ptr<AttributeAnimation> AttributeAnimationFactory::Create( const std::string& filePath, int index )
@@ -37,12 +49,16 @@ std::shared_ptr<AttributeAnimation> AttributeAnimationFactory::Create( const std
 	if( it != cache.end() )
 		return (*it).second;
 
+	//Animation index wasn't found
+	const auto& animations = GetFileData( filePath );
+	if( index < 0 || index >= (int)animations.size() )
+		return nullptr;
+
 	//Create Attribute Animation
 	auto attributeAnimation = std::make_shared<AttributeAnimation>( filePath, index );
 	if( attributeAnimation )
 	{
-		if( !CreateFromXML( attributeAnimation, filePath, index ) )
-			return nullptr;
+		CreateFromData( attributeAnimation, animations[index] );
 
 		//Put it on cache
 		cache[filePathKey] = attributeAnimation;
@@ -53,92 +69,132 @@ std::shared_ptr<AttributeAnimation> AttributeAnimationFactory::Create( const std
 	return nullptr;
 }
 
-bool AttributeAnimationFactory::CreateFromXML( std::shared_ptr<AttributeAnimation> attributeAnimation, const std::string& filePath, int index )
+std::vector<std::shared_ptr<AttributeAnimation>> AttributeAnimationFactory::CreateAll( const std::string& filePath )
 {
+	std::vector<std::shared_ptr<AttributeAnimation>> result;
+
+	size_t animationsCount = GetFileData( filePath ).size();
+	result.reserve( animationsCount );
+
+	for( size_t i = 0; i < animationsCount; i++ )
+		if( auto attributeAnimation = Create( filePath, (int)i ) )
+			result.push_back( attributeAnimation );
+
+	return result;
+}
+
+std::vector<std::shared_ptr<AttributeAnimation>> AttributeAnimationFactory::CreateAll( const std::string& filePath, std::vector<AttributeAnimationData>&& animations )
+{
+	//File parsed by worker, unless it was already parsed on this thread
+	if( filesData.find( filePath ) == filesData.end() )
+		filesData[filePath] = std::move( animations );
+
+	return CreateAll( filePath );
+}
+
+const std::vector<AttributeAnimationData>& AttributeAnimationFactory::GetFileData( const std::string& filePath )
+{
+	auto it = filesData.find( filePath );
+	if( it != filesData.end() )
+		return (*it).second;
+
+	//Invalid files are kept too, so they aren't read again
+	auto& animations = filesData[filePath];
+	ReadXML( filePath, animations );
+
+	return animations;
+}
+
+bool AttributeAnimationFactory::ReadXML( const std::string& filePath, std::vector<AttributeAnimationData>& animations )
+{
+	IO::FileView file;
+
+	if( !IO::FileSystem::Get()->Open( filePath, file ) )
+		return false;
+
 	pugi::xml_document doc;
-	pugi::xml_parse_result result = doc.load_file( filePath.c_str() );
+	pugi::xml_parse_result result = doc.load_buffer( file.Data(), file.Size() );
 
 	if( !result )
 		return false;
 
 	pugi::xml_node node = doc.child( "AttributeAnimation" );
-	pugi::xml_node animation;
-
-	bool found = false;
-	int i = 0;
 
 	for( pugi::xml_node animationNode : node.children( "Animation" ) )
 	{
-		if( i == index )
+		AttributeAnimationData animation;
+		animation.animationType = AttributeAnimationType::Undefined;
+
+		std::string type = animationNode.attribute( "type" ).value();
+
+		//Type of Value Animation
+		if( type.compare( "Color" ) == 0 )
+			animation.animationType = AttributeAnimationType::Color;
+		else if( type.compare( "BlinkingColor" ) == 0 )
+			animation.animationType = AttributeAnimationType::BlinkingColor;
+		else if( type.compare( "Scrolling" ) == 0 )
+			animation.animationType = AttributeAnimationType::ScrollUV;
+
+		//Iterate Key Frames
+		for( pugi::xml_node keyFrameNode : animationNode.children( "KeyFrame" ) )
 		{
-			animation = animationNode;
-			found = true;
-			break;
+			AttributeAnimationKeyFrame keyFrame = {};
+
+			//Color components not written keep Color defaults
+			if( animation.animationType == AttributeAnimationType::Color )
+				keyFrame.value[0] = keyFrame.value[1] = keyFrame.value[2] = keyFrame.value[3] = 1.0f;
+
+			keyFrame.time = (float)atof( keyFrameNode.attribute( "time" ).value() );
+			keyFrame.easing = Math::GetEasingFromString( keyFrameNode.attribute( "easing" ).value() );
+
+			sscanf_s( keyFrameNode.attribute( "value" ).value(), "%f %f %f %f", &keyFrame.value[0], &keyFrame.value[1], &keyFrame.value[2], &keyFrame.value[3] );
+
+			animation.keyFrames.push_back( keyFrame );
 		}
-		i++;
-	}
 
-	//Animation index wasn't found
-	if( !found )
-		return false;
+		animations.push_back( std::move( animation ) );
+	}
 
-	std::string type = animation.attribute( "type" ).value();
+	return true;
+}
 
-	//Create Value Animation based on type
-	if( type.compare( "Color" ) == 0 )
+void AttributeAnimationFactory::CreateFromData( std::shared_ptr<AttributeAnimation> attributeAnimation, const AttributeAnimationData& data )
+{
+	//Reloaded Animation
+	if( attributeAnimation->p )
 	{
-		attributeAnimation->animationType = AttributeAnimationType::Color;
-		attributeAnimation->colorAnimation = new Math::ValueAnimation<Math::Color>();
+		if( attributeAnimation->animationType == AttributeAnimationType::ScrollUV )
+			delete attributeAnimation->vector2Animation;
+		else
+			delete attributeAnimation->colorAnimation;
+
+		attributeAnimation->p = nullptr;
 	}
-	else if( type.compare( "BlinkingColor" ) == 0 )
-	{
-		attributeAnimation->animationType = AttributeAnimationType::BlinkingColor;
+
+	attributeAnimation->loaded = false;
+	attributeAnimation->animationType = data.animationType;
+
+	//Create Value Animation based on type
+	if( data.animationType == AttributeAnimationType::Color || data.animationType == AttributeAnimationType::BlinkingColor )
 		attributeAnimation->colorAnimation = new Math::ValueAnimation<Math::Color>();
-	}
-	else if( type.compare( "Scrolling" ) == 0 )
-	{
-		attributeAnimation->animationType = AttributeAnimationType::ScrollUV;
+	else if( data.animationType == AttributeAnimationType::ScrollUV )
 		attributeAnimation->vector2Animation = new Math::ValueAnimation<Math::Vector2>();
-	}
 
-	//Iterate Key Frames and put it on Animation
-	for( pugi::xml_node keyFrameNode : animation.children( "KeyFrame" ) )
+	//Put Key Frames on Animation
+	for( const auto& keyFrame : data.keyFrames )
 	{
-		float time = (float)atof( keyFrameNode.attribute( "time" ).value() );
-		Math::EasingAnimation easing = Math::GetEasingFromString( keyFrameNode.attribute( "easing" ).value() );
-
 		//Color Animation
-		if( attributeAnimation->animationType == AttributeAnimationType::Color )
-		{
-			Math::Color color;
-			sscanf_s( keyFrameNode.attribute( "value" ).value(), "%f %f %f %f", &color.r, &color.g, &color.b, &color.a );
-
-			//Set Key Frame
-			attributeAnimation->colorAnimation->SetKeyFrame( time, color, easing );
-		}
+		if( data.animationType == AttributeAnimationType::Color )
+			attributeAnimation->colorAnimation->SetKeyFrame( keyFrame.time, Math::Color( keyFrame.value[0], keyFrame.value[1], keyFrame.value[2], keyFrame.value[3] ), keyFrame.easing );
 		//Blinking Color
-		else if( attributeAnimation->animationType == AttributeAnimationType::BlinkingColor )
-		{
-			float blinking;
-			sscanf_s( keyFrameNode.attribute( "value" ).value(), "%f", &blinking );
-
-			//Set Key Frame
-			attributeAnimation->colorAnimation->SetKeyFrame( time, Math::Color( blinking, blinking, blinking, 1.0f ), easing );
-		}
+		else if( data.animationType == AttributeAnimationType::BlinkingColor )
+			attributeAnimation->colorAnimation->SetKeyFrame( keyFrame.time, Math::Color( keyFrame.value[0], keyFrame.value[0], keyFrame.value[0], 1.0f ), keyFrame.easing );
 		//Scrolling Animation
-		else if( attributeAnimation->animationType == AttributeAnimationType::ScrollUV )
-		{
-			Math::Vector2 vector;
-			sscanf_s( keyFrameNode.attribute( "value" ).value(), "%f %f", &vector.x, &vector.y );
-
-			//Set Key Frame
-			attributeAnimation->vector2Animation->SetKeyFrame( time, vector, easing );
-		}
+		else if( data.animationType == AttributeAnimationType::ScrollUV )
+			attributeAnimation->vector2Animation->SetKeyFrame( keyFrame.time, Math::Vector2( keyFrame.value[0], keyFrame.value[1] ), keyFrame.easing );
 	}
 
 	attributeAnimation->loaded = true;
-
-	return true;
 }
 
 }
\ No newline at end of file
@@ -33,6 +33,19 @@ struct RetValue
 	};
 };
 
+struct AttributeAnimationKeyFrame
+{
+	float time;	//!< Time of Key Frame
+	Math::EasingAnimation easing;	//!< Easing to next Key Frame
+	float value[4];	//!< Value components (Color uses all, Blinking uses one and Scrolling uses two)
+};
+
+struct AttributeAnimationData
+{
+	AttributeAnimationType animationType;	//!< Animation Type
+	std::vector<AttributeAnimationKeyFrame> keyFrames;	//!< Key Frames parsed from XML
+};
+
 class AttributeAnimation : public Core::TimerImpl
 {
 friend class AttributeAnimationFactory;
@@ -106,10 +119,33 @@ public:
 	* @return Pointer to Attribute Animation Instance Created
 	 */
 	std::shared_ptr<AttributeAnimation> Create( const std::string& filePath, int index = 0 );
+
+	/**
+	* Create Instances of every Attribute Animation on File
+	* @param filePath File Path of Attribute Animation XML
+	* @return Attribute Animations Instances ordered by index
+	 */
+	std::vector<std::shared_ptr<AttributeAnimation>> CreateAll( const std::string& filePath );
+
+	/**
+	* Create Instances of every Attribute Animation from Animations parsed by ReadXML (Background Loader)
+	* @param filePath File Path of Attribute Animation XML
+	* @param animations Animations parsed from File (kept if File wasn't parsed yet)
+	* @return Attribute Animations Instances ordered by index
+	 */
+	std::vector<std::shared_ptr<AttributeAnimation>> CreateAll( const std::string& filePath, std::vector<AttributeAnimationData>&& animations );
+
+	//! Parse every Animation of XML (safe on worker threads, nothing is cached).
+	static bool ReadXML( const std::string& filePath, std::vector<AttributeAnimationData>& animations );
 private:
-	bool CreateFromXML( std::shared_ptr<AttributeAnimation> attributeAnimation, const std::string& filePath, int index );
+	//! Get Animations of File, XML is parsed only on first call.
+	const std::vector<AttributeAnimationData>& GetFileData( const std::string& filePath );
+
+	//! Create Value Animation of Attribute Animation from parsed data.
+	void CreateFromData( std::shared_ptr<AttributeAnimation> attributeAnimation, const AttributeAnimationData& data );
 
 	std::unordered_map<std::string, std::shared_ptr<AttributeAnimation>> cache;	//!< Cache
+	std::unordered_map<std::string, std::vector<AttributeAnimationData>> filesData;	//!< Parsed Files (empty if file couldn't be read)
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include "PrecompiledHeader.h"
+#include "BackgroundLoader.h"
+
+#include "../Graphics/Model.h"
+#include "../Graphics/Shader.h"
+#include "AttributeAnimation.h"
+
+namespace Delta3D::Resource
+{
+BackgroundLoader::BackgroundLoader( unsigned int threadsCount ) :
+	threads(),
+	readRequests(),
+	createRequests(),
+	readingCount( 0 ),
+	mutex(),
+	condition(),
+	readCondition(),
+	sequence( 0 ),
+	timeBudget( 4.0f ),
+	stop( false )
+{
+	threads.reserve( threadsCount );
+
+	for( unsigned int i = 0; i < threadsCount; i++ )
+		threads.emplace_back( &BackgroundLoader::Worker, this );
+}
+
+BackgroundLoader::~BackgroundLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		stop = true;
+	}
+
+	condition.notify_all();
+
+	for( auto& thread : threads )
+		if( thread.joinable() )
+			thread.join();
+
+	threads.clear();
+	readRequests.clear();
+	createRequests.clear();
+}
+
+LoadHandle BackgroundLoader::Load( std::function<bool()> read, std::function<LoadState()> create, std::function<void( LoadState )> callback, LoadPriority priority, LoadHandle dependency )
+{
+	auto request = std::make_shared<LoadRequest>();
+	request->read = std::move( read );
+	request->create = std::move( create );
+	request->callback = std::move( callback );
+	request->dependency = dependency;
+	request->priority = priority;
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		request->sequence = sequence++;
+		readRequests.push_back( request );
+	}
+
+	condition.notify_one();
+
+	return request;
+}
+
+LoadHandle BackgroundLoader::LoadModel( Graphics::Model* model, const std::string& filePath, Graphics::Model* skeleton, bool temporaryTextures, std::function<void( LoadState )> callback, LoadPriority priority, LoadHandle dependency )
+{
+	if( model == nullptr )
+		return nullptr;
+
+	auto Read = [model, filePath, skeleton, temporaryTextures]()
+	{
+		return model->Read( filePath, skeleton, temporaryTextures );
+	};
+
+	auto Create = [model]()
+	{
+		//Meshes created per call, so big Models (Terrains) are spread across frames
+		const unsigned int meshesCount = 32;
+
+		if( !model->Create( meshesCount ) )
+			return LoadState::Failed;
+
+		return model->IsLoading() ? LoadState::Creating : LoadState::Loaded;
+	};
+
+	return Load( Read, Create, callback, priority, dependency );
+}
+
+LoadHandle BackgroundLoader::LoadShader( Graphics::ShaderFactory* shaderFactory, const std::string& filePath, const std::vector<Graphics::ShaderDefine>& defines, std::function<void( std::shared_ptr<Graphics::Shader> )> callback, LoadPriority priority, LoadHandle dependency )
+{
+	if( shaderFactory == nullptr )
+		return nullptr;
+
+	struct ShaderRequest
+	{
+		std::vector<std::string> definesStrings;	//!< Names and Values of Defines
+		std::vector<Graphics::ShaderDefine> defines;	//!< Defines (pointing to definesStrings)
+		std::vector<char> compiled;	//!< Compiled Effect read by worker
+		std::shared_ptr<Graphics::Shader> shader;	//!< Effect created on device thread
+	};
+
+	auto request = std::make_shared<ShaderRequest>();
+
+	//Copy Defines until List Tail
+	for( const auto& define : defines )
+	{
+		if( define.name == nullptr )
+			break;
+
+		request->definesStrings.push_back( define.name );
+		request->definesStrings.push_back( define.value ? define.value : "" );
+	}
+
+	for( size_t i = 0; i < request->definesStrings.size(); i += 2 )
+		request->defines.push_back( Graphics::ShaderDefine{ request->definesStrings[i].c_str(), request->definesStrings[i + 1].c_str() } );
+
+	auto Read = [shaderFactory, filePath, request]()
+	{
+		return shaderFactory->Read( filePath, request->defines, request->compiled );
+	};
+
+	auto Create = [shaderFactory, filePath, request]()
+	{
+		request->shader = shaderFactory->Create( filePath, request->defines, request->compiled );
+		request->compiled.clear();
+		request->compiled.shrink_to_fit();
+
+		return request->shader ? LoadState::Loaded : LoadState::Failed;
+	};
+
+	auto Callback = [request, callback]( LoadState state )
+	{
+		if( callback )
+			callback( request->shader );
+	};
+
+	return Load( Read, Create, Callback, priority, dependency );
+}
+
+LoadHandle BackgroundLoader::LoadAttributeAnimations( AttributeAnimationFactory* attributeAnimationFactory, const std::string& filePath, std::function<void( std::vector<std::shared_ptr<AttributeAnimation>> )> callback, LoadPriority priority, LoadHandle dependency )
+{
+	if( attributeAnimationFactory == nullptr )
+		return nullptr;
+
+	auto animationsData = std::make_shared<std::vector<AttributeAnimationData>>();
+	auto animations = std::make_shared<std::vector<std::shared_ptr<AttributeAnimation>>>();
+
+	auto Read = [filePath, animationsData]()
+	{
+		return AttributeAnimationFactory::ReadXML( filePath, *animationsData );
+	};
+
+	auto Create = [attributeAnimationFactory, filePath, animationsData, animations]()
+	{
+		//Attribute Animations are Timers, so they are created on device thread
+		*animations = attributeAnimationFactory->CreateAll( filePath, std::move( *animationsData ) );
+
+		return LoadState::Loaded;
+	};
+
+	auto Callback = [animations, callback]( LoadState state )
+	{
+		if( callback )
+			callback( *animations );
+	};
+
+	return Load( Read, Create, Callback, priority, dependency );
+}
+
+bool BackgroundLoader::Cancel( LoadHandle handle )
+{
+	if( handle == nullptr )
+		return false;
+
+	std::unique_lock<std::mutex> lock( mutex );
+
+	switch( handle->GetState() )
+	{
+	case LoadState::Queued:
+		readRequests.erase( std::remove( readRequests.begin(), readRequests.end(), handle ), readRequests.end() );
+		break;
+	case LoadState::Reading:
+		//Resource can't be released while worker is using it
+		handle->canceled = true;
+		readCondition.wait( lock, [&handle]() { return handle->GetState() != LoadState::Reading; } );
+		break;
+	case LoadState::Creating:
+		createRequests.erase( std::remove( createRequests.begin(), createRequests.end(), handle ), createRequests.end() );
+		break;
+	default:
+		return false;
+	}
+
+	handle->state = LoadState::Canceled;
+	lock.unlock();
+
+	//Requests depending on it must fail
+	condition.notify_all();
+
+	return true;
+}
+
+void BackgroundLoader::SetPriority( LoadHandle handle, LoadPriority priority )
+{
+	if( handle == nullptr )
+		return;
+
+	std::lock_guard<std::mutex> lock( mutex );
+	handle->priority = priority;
+}
+
+void BackgroundLoader::Wait( LoadHandle handle )
+{
+	if( handle == nullptr )
+		return;
+
+	//Critical requests are picked up first
+	SetPriority( handle, LoadPriority::Critical );
+
+	while( !handle->IsDone() )
+	{
+		Update();
+
+		if( !handle->IsDone() )
+			std::this_thread::yield();
+	}
+}
+
+void BackgroundLoader::Update()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	while( true )
+	{
+		LoadHandle request;
+
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			request = GetCreateRequest();
+		}
+
+		if( request == nullptr )
+			break;
+
+		LoadState result = LoadState::Loaded;
+
+		if( request->failed )
+			result = LoadState::Failed;
+		else if( request->create )
+			result = request->create();
+
+		//Request done
+		if( result != LoadState::Creating )
+		{
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+
+				createRequests.erase( std::remove( createRequests.begin(), createRequests.end(), request ), createRequests.end() );
+				request->state = result;
+			}
+
+			//Requests depending on it can be read now
+			condition.notify_all();
+
+			if( request->callback )
+				request->callback( result );
+		}
+
+		//Time Budget exceeded, continue on next frame
+		if( std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count() >= timeBudget )
+			break;
+	}
+}
+
+size_t BackgroundLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	return readRequests.size() + readingCount + createRequests.size();
+}
+
+void BackgroundLoader::Worker()
+{
+	while( true )
+	{
+		LoadHandle request;
+
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+
+			while( !stop && (request = PopReadRequest()) == nullptr )
+				condition.wait( lock );
+
+			if( stop )
+				return;
+
+			request->state = LoadState::Reading;
+			readingCount++;
+		}
+
+		bool result = request->read ? request->read() : true;
+
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+
+			readingCount--;
+
+			if( request->canceled )
+				request->state = LoadState::Canceled;
+			else
+			{
+				request->failed = !result;
+				request->state = LoadState::Creating;
+				createRequests.push_back( request );
+			}
+		}
+
+		readCondition.notify_all();
+	}
+}
+
+LoadHandle BackgroundLoader::PopReadRequest()
+{
+	//Dependency failed, so request fails too (callback is fired by Update)
+	for( auto it = readRequests.begin(); it != readRequests.end(); )
+	{
+		LoadState dependencyState = (*it)->dependency ? (*it)->dependency->GetState() : LoadState::Loaded;
+
+		if( dependencyState == LoadState::Failed || dependencyState == LoadState::Canceled )
+		{
+			(*it)->failed = true;
+			(*it)->state = LoadState::Creating;
+			createRequests.push_back( *it );
+
+			it = readRequests.erase( it );
+		}
+		else
+			++it;
+	}
+
+	auto best = readRequests.end();
+
+	for( auto it = readRequests.begin(); it != readRequests.end(); ++it )
+	{
+		//Dependency not loaded yet
+		if( (*it)->dependency && (*it)->dependency->GetState() != LoadState::Loaded )
+			continue;
+
+		if( best == readRequests.end() || (*it)->priority > (*best)->priority || ((*it)->priority == (*best)->priority && (*it)->sequence < (*best)->sequence) )
+			best = it;
+	}
+
+	if( best == readRequests.end() )
+		return nullptr;
+
+	LoadHandle request = *best;
+	readRequests.erase( best );
+
+	return request;
+}
+
+LoadHandle BackgroundLoader::GetCreateRequest()
+{
+	LoadHandle best = nullptr;
+
+	for( const auto& request : createRequests )
+		if( best == nullptr || request->priority > best->priority || (request->priority == best->priority && request->sequence < best->sequence) )
+			best = request;
+
+	return best;
+}
+}
\ No newline at end of file
@@ -1,2 +1,168 @@
 #pragma once
 
+namespace Delta3D::Graphics { class Model; class Shader; class ShaderFactory; struct ShaderDefine; };
+
+namespace Delta3D::Resource
+{
+class AttributeAnimation;
+class AttributeAnimationFactory;
+
+enum class LoadState
+{
+	Queued,	//!< Waiting for a worker
+	Reading,	//!< File I/O and CPU decoding on a worker
+	Creating,	//!< GPU resources being created on device thread
+	Loaded,
+	Failed,
+	Canceled,
+};
+
+enum class LoadPriority
+{
+	Low,
+	Normal,
+	High,
+	Critical,
+};
+
+class LoadRequest
+{
+friend class BackgroundLoader;
+public:
+	//! Default Constructor for Load Request.
+	LoadRequest() : state( LoadState::Queued ), priority( LoadPriority::Normal ), sequence( 0 ), failed( false ), canceled( false ) {}
+
+	//! Get Request State.
+	LoadState GetState() const { return state.load(); }
+
+	//! Get Request Priority.
+	LoadPriority GetPriority() const { return priority; }
+
+	//! Check if Request is finished (loaded, failed or canceled).
+	bool IsDone() const { return GetState() >= LoadState::Loaded; }
+private:
+	std::function<bool()> read;	//!< Worker step (File I/O and CPU decoding)
+	std::function<LoadState()> create;	//!< Device thread step, called until it doesn't return Creating
+	std::function<void( LoadState )> callback;	//!< Completion Callback (device thread)
+	std::shared_ptr<LoadRequest> dependency;	//!< Request that must be loaded before this one is read
+
+	std::atomic<LoadState> state;	//!< Current State
+	LoadPriority priority;	//!< Priority
+	unsigned long long sequence;	//!< Request Order (same priority requests are FIFO)
+	bool failed;	//!< Flag to determinate if read (or dependency) failed, callback is fired by Update
+	bool canceled;	//!< Flag to determinate if request was canceled while reading
+};
+
+using LoadHandle = std::shared_ptr<LoadRequest>;
+
+class BackgroundLoader
+{
+public:
+	/**
+	 * Construct a Background Loader and start workers
+	 * @param threadsCount Number of workers reading files
+	 */
+	BackgroundLoader( unsigned int threadsCount = 2 );
+
+	//! Deconstructor (pending requests are dropped).
+	~BackgroundLoader();
+
+	//! Background Loaders can't be copied.
+	BackgroundLoader( const BackgroundLoader& ) = delete;
+	BackgroundLoader& operator=( const BackgroundLoader& ) = delete;
+
+	/**
+	 * Queue a Load Request
+	 * @param read Function called on a worker, must not touch the device
+	 * @param create Function called on device thread by Update until it doesn't return LoadState::Creating
+	 * @param callback Function called on device thread when request is loaded or failed
+	 * @param priority Priority of request
+	 * @param dependency Request that must be loaded before this one is read
+	 * @return Handle of request
+	 */
+	LoadHandle Load( std::function<bool()> read, std::function<LoadState()> create, std::function<void( LoadState )> callback = nullptr, LoadPriority priority = LoadPriority::Normal, LoadHandle dependency = nullptr );
+
+	/**
+	 * Queue a Model to be loaded, Model must be alive until callback is called or request is canceled
+	 * @param model Model to be loaded
+	 * @param filePath SMD File Path
+	 * @param skeleton Skeleton Model (if Skinned Model)
+	 * @param temporaryTextures Load Textures on Temporary Cache
+	 * @param callback Function called on device thread when Model is loaded or failed
+	 * @param priority Priority of request
+	 * @param dependency Request that must be loaded before this one is read (e.g. Skeleton request)
+	 * @return Handle of request
+	 */
+	LoadHandle LoadModel( Graphics::Model* model, const std::string& filePath, Graphics::Model* skeleton = nullptr, bool temporaryTextures = false, std::function<void( LoadState )> callback = nullptr, LoadPriority priority = LoadPriority::Normal, LoadHandle dependency = nullptr );
+
+	/**
+	 * Queue an Effect to be loaded, Compiled Effect is read (or compiled) by a worker and created on device thread
+	 * @param shaderFactory Effect Factory (Effect is put on its cache)
+	 * @param filePath Effect File Path
+	 * @param defines Effect Defines (copied, so callers strings can be released)
+	 * @param callback Function called on device thread with Effect created (nullptr if failed)
+	 * @param priority Priority of request
+	 * @param dependency Request that must be loaded before this one is read
+	 * @return Handle of request
+	 */
+	LoadHandle LoadShader( Graphics::ShaderFactory* shaderFactory, const std::string& filePath, const std::vector<Graphics::ShaderDefine>& defines, std::function<void( std::shared_ptr<Graphics::Shader> )> callback = nullptr, LoadPriority priority = LoadPriority::Normal, LoadHandle dependency = nullptr );
+
+	/**
+	 * Queue every Attribute Animation of a File to be loaded, XML is parsed by a worker and Animations are created on device thread
+	 * @param attributeAnimationFactory Attribute Animation Factory (Animations are put on its cache)
+	 * @param filePath File Path of Attribute Animation XML
+	 * @param callback Function called on device thread with Animations created ordered by index (empty if failed)
+	 * @param priority Priority of request
+	 * @param dependency Request that must be loaded before this one is read
+	 * @return Handle of request
+	 */
+	LoadHandle LoadAttributeAnimations( AttributeAnimationFactory* attributeAnimationFactory, const std::string& filePath, std::function<void( std::vector<std::shared_ptr<AttributeAnimation>> )> callback = nullptr, LoadPriority priority = LoadPriority::Normal, LoadHandle dependency = nullptr );
+
+	/**
+	 * Cancel a Load Request, waits if it is being read by a worker (callback is not called)
+	 * @param handle Handle of request
+	 * @return True if request was canceled before finish
+	 */
+	bool Cancel( LoadHandle handle );
+
+	//! Change Priority of a queued Request.
+	void SetPriority( LoadHandle handle, LoadPriority priority );
+
+	//! Block until Request is done, creating GPU resources on the calling thread (device thread).
+	void Wait( LoadHandle handle );
+
+	//! Create GPU resources of read Requests and fire callbacks, limited by time budget (device thread).
+	void Update();
+
+	//! Set time budget in milliseconds used by Update each frame.
+	void SetTimeBudget( float timeBudget_ ) { timeBudget = timeBudget_; }
+
+	//! Get time budget in milliseconds.
+	float GetTimeBudget() const { return timeBudget; }
+
+	//! Get number of Requests not done yet.
+	size_t GetPendingCount();
+private:
+	//! Worker Loop.
+	void Worker();
+
+	//! Get next Request ready to be read (mutex must be locked).
+	LoadHandle PopReadRequest();
+
+	//! Get next Request with GPU resources to be created (mutex must be locked).
+	LoadHandle GetCreateRequest();
+private:
+	std::vector<std::thread> threads;	//!< Workers
+	std::vector<LoadHandle> readRequests;	//!< Requests waiting to be read
+	std::vector<LoadHandle> createRequests;	//!< Requests waiting to be created on device thread
+	size_t readingCount;	//!< Requests being read
+
+	std::mutex mutex;	//!< Mutex for Requests
+	std::condition_variable condition;	//!< Signaled when workers have something to read or must finish
+	std::condition_variable readCondition;	//!< Signaled when a worker finished a read
+
+	unsigned long long sequence;	//!< Request Counter
+	float timeBudget;	//!< Time Budget per Update (milliseconds)
+	bool stop;	//!< Flag to determinate if workers must finish
+};
+}
\ No newline at end of file
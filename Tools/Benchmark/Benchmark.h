@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Delta3D::Tools
+{
+/**
+ * Benchmark KeyTrack::Find over long Rotation Tracks (forward playback, seeks and lookups without cursor)
+ * @param argc Arguments Count (after benchmark name)
+ * @param argv Arguments
+ * @return Exit Code (1 if a lookup returned a wrong Segment)
+ */
+int RunKeyTrackBenchmark( int argc, char* argv[] );
+
+/**
+ * Benchmark CPU Skinning kernels (Linear and Dual Quaternion) on rigid and scaled Skeletons
+ * @param argc Arguments Count (after benchmark name)
+ * @param argv Arguments
+ * @return Exit Code (1 if Dual Quaternions differ from Matrices on one Bone, or a scaled Skeleton isn't built or rejected as expected)
+ */
+int RunSkinningBenchmark( int argc, char* argv[] );
+
+//! Read an integer argument following a name (-name value), or a default value.
+int GetArgument( int argc, char* argv[], const char* name, int defaultValue );
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "PrecompiledHeader.h"
+#include "Benchmark.h"
+
+#include "../../Source/IO/SMD/KeyTrack.h"
+
+namespace Delta3D::Tools
+{
+//Frames between Keyframes of exported SMD Animations
+static const int keyFrameStep = 160;
+
+struct KeyLookupResult
+{
+	double lookupsPerSecond;	//!< Lookups per second
+	unsigned long long cursorHits;	//!< Lookups solved by the cursor
+	unsigned long long searches;	//!< Lookups solved by binary search
+	int errors;	//!< Lookups returning a Segment not containing the frame
+	float checksum;	//!< Sum of sampled Rotations (keeps lookups from being optimized away)
+};
+
+static KeyLookupResult RunLookups( const std::vector<IO::SMD::KeyTrack>& tracks, const std::vector<int>& frames, bool useCursor )
+{
+	KeyLookupResult result = {};
+	std::vector<int> cursors( tracks.size(), -1 );
+
+	IO::SMD::FlushKeyLookupStatistics();
+	IO::SMD::keyLookupStatistics.Reset();
+
+	auto start = std::chrono::steady_clock::now();
+
+	//Every Bone of a Skeleton is sampled on the same frame, as Mesh::Animate does
+	for( int frame : frames )
+	{
+		for( size_t i = 0; i < tracks.size(); i++ )
+		{
+			if( useCursor == false )
+				cursors[i] = -1;
+
+			int key = tracks[i].Find( 0, frame, cursors[i] );
+
+			if( key < 0 || tracks[i].GetFrame( key ) > frame || tracks[i].GetFrame( key + 1 ) <= frame )
+			{
+				result.errors++;
+				continue;
+			}
+
+			result.checksum += tracks[i].GetRotation( key ).w;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	IO::SMD::FlushKeyLookupStatistics();
+
+	result.lookupsPerSecond = seconds > 0.0 ? (double)(frames.size()* tracks.size()) / seconds : 0.0;
+	result.cursorHits = IO::SMD::keyLookupStatistics.cursorHits;
+	result.searches = IO::SMD::keyLookupStatistics.searches;
+
+	return result;
+}
+
+static void PrintResult( const char* name, const KeyLookupResult& result )
+{
+	printf( "%-16s %10.2f M lookups/s  cursor hits %12llu  searches %12llu  errors %d  (%.3f)\n", name, result.lookupsPerSecond / 1000000.0, result.cursorHits, result.searches, result.errors, result.checksum );
+}
+
+int RunKeyTrackBenchmark( int argc, char* argv[] )
+{
+	int bonesCount = std::max( GetArgument( argc, argv, "-bones", 64 ), 1 );
+	int keysCount = std::max( GetArgument( argc, argv, "-keys", 4096 ), 2 );
+	int lookupsCount = std::max( GetArgument( argc, argv, "-lookups", 20000000 ), 1 );
+
+	std::mt19937 random( 1 );
+	std::uniform_real_distribution<float> component( -1.0f, 1.0f );
+
+	//Build Rotation Tracks as Model::Read does (Previous Rotation is the accumulated rotation of each Keyframe)
+	std::vector<IO::SMD::KeyTrack> tracks( bonesCount );
+	size_t tracksSize = 0;
+
+	for( auto& track : tracks )
+	{
+		std::vector<IO::SMD::KeyRotation> keys( keysCount );
+		std::vector<Math::Matrix4> previousRotations( keysCount );
+		Math::Matrix4 previousRotation;
+
+		for( int i = 0; i < keysCount; i++ )
+		{
+			Math::Quaternion q( component( random ), component( random ), component( random ), component( random ) );
+			q.Normalize();
+
+			keys[i] = IO::SMD::KeyRotation{ i* keyFrameStep, q.x, q.y, q.z, q.w };
+
+			previousRotation = previousRotation* q.ToMatrix();
+			previousRotations[i] = previousRotation;
+		}
+
+		track.Build( IO::Span<IO::SMD::KeyRotation>( keys.data(), keys.size() ), IO::Span<Math::Matrix4>( previousRotations.data(), previousRotations.size() ) );
+		tracksSize += track.SizeBytes();
+	}
+
+	int lastFrame = (keysCount - 1)* keyFrameStep;
+	size_t framesCount = std::max( (size_t)lookupsCount / tracks.size(), (size_t)1 );
+
+	//Forward Playback advances a few frames per lookup and loops at the end of Track
+	std::vector<int> forwardFrames( framesCount );
+	for( size_t i = 0; i < framesCount; i++ )
+		forwardFrames[i] = (int)((i* 16) % (size_t)lastFrame);
+
+	//Seeks jump anywhere on Track
+	std::vector<int> seekFrames( framesCount );
+	std::uniform_int_distribution<int> seekFrame( 0, lastFrame - 1 );
+
+	for( auto& frame : seekFrames )
+		frame = seekFrame( random );
+
+	printf( "Rotation Tracks: %d Bones x %d Keyframes (%.2f MB), %zu frames per scenario\n", bonesCount, keysCount, (double)tracksSize / (1024.0* 1024.0), framesCount );
+
+	KeyLookupResult results[] =
+	{
+		RunLookups( tracks, forwardFrames, true ),
+		RunLookups( tracks, forwardFrames, false ),
+		RunLookups( tracks, seekFrames, true ),
+		RunLookups( tracks, seekFrames, false ),
+	};
+
+	PrintResult( "forward cursor", results[0] );
+	PrintResult( "forward search", results[1] );
+	PrintResult( "seek cursor", results[2] );
+	PrintResult( "seek search", results[3] );
+
+	for( const auto& result : results )
+		if( result.errors )
+			return 1;
+
+	return 0;
+}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "PrecompiledHeader.h"
+#include "Benchmark.h"
+
+namespace Delta3D::Tools
+{
+int GetArgument( int argc, char* argv[], const char* name, int defaultValue )
+{
+	for( int i = 0; i + 1 < argc; i++ )
+		if( _strcmpi( argv[i], name ) == 0 )
+			return atoi( argv[i + 1] );
+
+	return defaultValue;
+}
+}
+
+static void PrintUsage()
+{
+	printf( "Usage: Benchmark <benchmark> [options]\n" );
+	printf( "  keys [-bones <count>] [-keys <count>] [-lookups <count>]  Keyframe lookups over long Rotation Tracks\n" );
+	printf( "  skinning [-bones <count>] [-vertices <count>] [-iterations <count>]  Linear and Dual Quaternion Skinning on rigid and scaled Skeletons\n" );
+}
+
+int main( int argc, char* argv[] )
+{
+	if( argc < 2 )
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	if( _strcmpi( argv[1], "keys" ) == 0 )
+		return Delta3D::Tools::RunKeyTrackBenchmark( argc - 2, argv + 2 );
+
+	if( _strcmpi( argv[1], "skinning" ) == 0 )
+		return Delta3D::Tools::RunSkinningBenchmark( argc - 2, argv + 2 );
+
+	PrintUsage();
+	return 2;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+//Benchmark builds the D3D free parts of Delta3D (IO, Math and CPU Skinning), so it runs headless on machines without a GPU
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#undef min
+#undef max
+#endif
+
+#include <emmintrin.h>
+
+//STD:
+#include <cstdio>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <unordered_map>
+#include <map>
+#include <array>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+
+#include "../Cooker/Platform.h"
+
+#include "../../Source/IO/Log.h"
\ No newline at end of file
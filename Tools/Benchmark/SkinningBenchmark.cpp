@@ -0,0 +1,162 @@
+#include "PrecompiledHeader.h"
+#include "Benchmark.h"
+
+#include "../../Source/Graphics/Skinning.h"
+#include "../../Source/Math/Quaternion.h"
+
+namespace Delta3D::Tools
+{
+//Max error of Dual Quaternion Skinning against Linear Skinning, relative to Position length
+static const float skinningEpsilon = 1e-4f;
+
+struct SkinningScenario
+{
+	const char* name;	//!< Scenario Name
+	Math::Vector3 boneScale;	//!< Scaling on Bone space (before Animation)
+	Math::Vector3 modelScale;	//!< Scaling of Model (after Animation, as Mesh::UpdateWorld does)
+	bool useDualQuaternions;	//!< Bones can be held by Dual Quaternions
+};
+
+static double VerticesPerSecond( size_t count, int iterations, std::chrono::steady_clock::time_point start )
+{
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	return seconds > 0.0 ? (double)count* iterations / seconds : 0.0;
+}
+
+static int RunScenario( const SkinningScenario& scenario, const std::vector<Math::Matrix4>& animations, const std::vector<Graphics::SkinnedVertex>& vertices, const std::vector<Graphics::BoneInfluences>& rigidInfluences, const std::vector<Graphics::BoneInfluences>& blendedInfluences, int iterations )
+{
+	Math::Matrix4 boneScale;
+	boneScale.Scale( scenario.boneScale );
+
+	Math::Matrix4 modelScale;
+	modelScale.Scale( scenario.modelScale );
+
+	//Skinning Matrices are flipped, Dual Quaternions are built from World Matrices (Model::GetSkinningMatrices and GetSkinningDualQuaternions)
+	std::vector<Math::Matrix4> worlds( animations.size() );
+	std::vector<Math::Matrix4> matrices( animations.size() );
+
+	for( size_t i = 0; i < animations.size(); i++ )
+	{
+		worlds[i] = boneScale* animations[i]* modelScale;
+		matrices[i] = worlds[i].FlippedYZ();
+	}
+
+	std::vector<Graphics::BoneDualQuaternion> dualQuaternions( worlds.size() );
+	bool built = Graphics::BuildDualQuaternions( worlds.data(), worlds.size(), dualQuaternions.data() );
+
+	if( built != scenario.useDualQuaternions )
+	{
+		printf( "%-20s Dual Quaternions %s, expected %s\n", scenario.name, built ? "built" : "rejected", scenario.useDualQuaternions ? "built" : "rejected" );
+		return 1;
+	}
+
+	std::vector<float> linear( vertices.size()* 3 );
+	std::vector<float> dualQuaternion( vertices.size()* 3 );
+
+	//One Bone of weight 255 must give the same Position on both kernels
+	float maxError = 0.0f;
+
+	if( built )
+	{
+		Graphics::SkinVerticesLinear( vertices.data(), rigidInfluences.data(), vertices.size(), matrices.data(), linear.data() );
+		Graphics::SkinVerticesDualQuaternion( vertices.data(), rigidInfluences.data(), vertices.size(), dualQuaternions.data(), dualQuaternion.data() );
+
+		for( size_t i = 0; i < vertices.size(); i++ )
+		{
+			const float* a = &linear[i* 3];
+			const float* b = &dualQuaternion[i* 3];
+
+			float length = std::max( sqrtf( a[0]* a[0] + a[1]* a[1] + a[2]* a[2] ), 1.0f );
+			float error = std::max( { fabsf( a[0] - b[0] ), fabsf( a[1] - b[1] ), fabsf( a[2] - b[2] ) } ) / length;
+
+			maxError = std::max( maxError, error );
+		}
+	}
+
+	//Throughput of 4 weighted Bones per Vertex
+	auto start = std::chrono::steady_clock::now();
+
+	for( int i = 0; i < iterations; i++ )
+		Graphics::SkinVerticesLinear( vertices.data(), blendedInfluences.data(), vertices.size(), matrices.data(), linear.data() );
+
+	double linearSpeed = VerticesPerSecond( vertices.size(), iterations, start );
+	double dualQuaternionSpeed = 0.0;
+
+	if( built )
+	{
+		start = std::chrono::steady_clock::now();
+
+		for( int i = 0; i < iterations; i++ )
+			Graphics::SkinVerticesDualQuaternion( vertices.data(), blendedInfluences.data(), vertices.size(), dualQuaternions.data(), dualQuaternion.data() );
+
+		dualQuaternionSpeed = VerticesPerSecond( vertices.size(), iterations, start );
+	}
+
+	printf( "%-20s linear %8.2f M vertices/s  dual quaternion %8.2f M vertices/s  max error %.2e%s\n", scenario.name, linearSpeed / 1000000.0, dualQuaternionSpeed / 1000000.0, maxError, built ? "" : "  (rejected, Matrices are blended)" );
+
+	return maxError > skinningEpsilon ? 1 : 0;
+}
+
+int RunSkinningBenchmark( int argc, char* argv[] )
+{
+	int bonesCount = std::min( std::max( GetArgument( argc, argv, "-bones", 64 ), 1 ), 256 );
+	int verticesCount = std::max( GetArgument( argc, argv, "-vertices", 65536 ), 1 );
+	int iterations = std::max( GetArgument( argc, argv, "-iterations", 100 ), 1 );
+
+	std::mt19937 random( 1 );
+	std::uniform_real_distribution<float> component( -1.0f, 1.0f );
+	std::uniform_int_distribution<int> bone( 0, bonesCount - 1 );
+	std::uniform_int_distribution<int> weight( 0, 255 );
+
+	//Animated Bones are rigid (rotation and translation)
+	std::vector<Math::Matrix4> animations( bonesCount );
+
+	for( auto& animation : animations )
+	{
+		Math::Quaternion q( component( random ), component( random ), component( random ), component( random ) );
+		q.Normalize();
+
+		animation = q.ToMatrix();
+		animation.Translate( Math::Vector3( component( random ), component( random ), component( random ) )* 10.0f );
+	}
+
+	std::vector<Graphics::SkinnedVertex> vertices( verticesCount );
+	std::vector<Graphics::BoneInfluences> rigidInfluences( verticesCount );
+	std::vector<Graphics::BoneInfluences> blendedInfluences( verticesCount );
+
+	for( int i = 0; i < verticesCount; i++ )
+	{
+		vertices[i] = Graphics::SkinnedVertex{ component( random ), component( random ), component( random ), bone( random ) };
+
+		rigidInfluences[i] = Graphics::BoneInfluences{ { (unsigned char)vertices[i].bone, 0, 0, 0 }, { 255, 0, 0, 0 } };
+
+		Graphics::BoneInfluences influences;
+
+		for( int j = 0; j < Graphics::maxBoneInfluences; j++ )
+		{
+			influences.bones[j] = (unsigned char)bone( random );
+			influences.weights[j] = (unsigned char)weight( random );
+		}
+
+		blendedInfluences[i] = Graphics::NormalizeBoneInfluences( influences );
+	}
+
+	printf( "Skinning: %d Bones, %d Vertices x %d iterations (epsilon %.0e)\n", bonesCount, verticesCount, iterations, skinningEpsilon );
+
+	const SkinningScenario scenarios[] =
+	{
+		{ "rigid", Math::Vector3( 1.0f, 1.0f, 1.0f ), Math::Vector3( 1.0f, 1.0f, 1.0f ), true },
+		{ "model scale", Math::Vector3( 1.0f, 1.0f, 1.0f ), Math::Vector3( 1.5f, 1.5f, 1.5f ), true },
+		{ "bone scale", Math::Vector3( 1.5f, 0.75f, 1.25f ), Math::Vector3( 1.0f, 1.0f, 1.0f ), true },
+		{ "non-uniform model", Math::Vector3( 1.0f, 1.0f, 1.0f ), Math::Vector3( 1.5f, 0.75f, 1.25f ), false },
+	};
+
+	int result = 0;
+
+	for( const auto& scenario : scenarios )
+		result |= RunScenario( scenario, animations, vertices, rigidInfluences, blendedInfluences, iterations );
+
+	return result;
+}
+}
\ No newline at end of file
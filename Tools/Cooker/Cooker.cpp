@@ -0,0 +1,468 @@
+#include "PrecompiledHeader.h"
+#include "Cooker.h"
+
+#include "../../Source/Core/ThreadPool.h"
+#include "../../Source/IO/FileSystem.h"
+#include "../../Source/IO/Hash.h"
+#include "../../Source/IO/SMD/MeshCache.h"
+
+namespace Delta3D::Tools
+{
+static const char* ManifestFileName = "cooker.manifest";
+
+Cooker::Cooker( const std::string& inputDirectory_, const std::string& outputDirectory_ ) :
+	inputDirectory( inputDirectory_ ),
+	outputDirectory( outputDirectory_ ),
+	force( false ),
+	files(),
+	manifest(),
+	results(),
+	elapsedTime( 0.0f )
+{
+}
+
+bool Cooker::Run()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	Walk();
+	ReadManifest();
+
+	//Assets don't share outputs, so each one is cooked by a single worker
+	Core::ThreadPool::Get()->ParallelFor( results.size(), [this]( size_t i )
+	{
+		Cook( results[i] );
+	} );
+
+	WriteManifest();
+
+	elapsedTime = std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+	return std::none_of( results.begin(), results.end(), []( const CookResult& result ) { return result.state == CookState::Failed; } );
+}
+
+bool Cooker::WritePack( const std::string& filePath )
+{
+	IO::PackWriter writer;
+	std::error_code error;
+
+	filesystem::path packPath = filesystem::absolute( filePath, error );
+
+	for( auto it = filesystem::recursive_directory_iterator( outputDirectory, error ); it != filesystem::recursive_directory_iterator(); it.increment( error ) )
+	{
+		if( error )
+			break;
+
+		if( !it->is_regular_file( error ) || it->path().filename() == ManifestFileName || filesystem::equivalent( it->path(), packPath, error ) )
+			continue;
+
+		//Packed with the same path used by the engine (relative to game directory)
+		if( !writer.AddFile( it->path().lexically_relative( outputDirectory ).string(), it->path().string() ) )
+			return false;
+	}
+
+	if( !writer.Save( filePath ) )
+		return false;
+
+	printf( "Packed %d files to %s\n", (int)writer.GetFilesCount(), filePath.c_str() );
+
+	return true;
+}
+
+void Cooker::PrintReport() const
+{
+	int counts[4] = { 0 };
+	size_t inputSize = 0;
+	size_t outputSize = 0;
+	float cookTime = 0.0f;
+
+	printf( "%-20s %-10s %10s %12s %12s %7s  %s\n", "Type", "State", "Time (ms)", "Input", "Output", "Saved", "Asset" );
+
+	for( const auto& result : results )
+	{
+		//Files that aren't assets (e.g. other XMLs)
+		if( result.type == AssetType::Unknown )
+			continue;
+
+		static const char* states[] = { "Cooked", "UpToDate", "Skipped", "Failed" };
+
+		char saved[16] = "-";
+		if( result.state != CookState::Failed && result.inputSize && result.outputSize < result.inputSize )
+			snprintf( saved, sizeof( saved ), "%.1f%%", 100.0f* (float)(result.inputSize - result.outputSize) / (float)result.inputSize );
+
+		printf( "%-20s %-10s %10.2f %12zu %12zu %7s  %s%s%s\n", GetTypeName( result.type ), states[(int)result.state], result.time, result.inputSize, result.outputSize, saved,
+			result.filePath.c_str(), result.message.empty() ? "" : " - ", result.message.c_str() );
+
+		counts[(int)result.state]++;
+		cookTime += result.time;
+
+		if( result.state == CookState::Cooked || result.state == CookState::UpToDate )
+		{
+			inputSize += result.inputSize;
+			outputSize += result.outputSize;
+		}
+	}
+
+	printf( "\n%d cooked, %d up to date, %d skipped, %d failed\n", counts[(int)CookState::Cooked], counts[(int)CookState::UpToDate], counts[(int)CookState::Skipped], counts[(int)CookState::Failed] );
+	printf( "Input %zu bytes, Output %zu bytes\n", inputSize, outputSize );
+	printf( "Cook time %.2f ms on %d threads, wall time %.2f ms\n", cookTime, (int)Core::ThreadPool::Get()->GetThreadsCount() + 1, elapsedTime );
+}
+
+const char* Cooker::GetTypeName( AssetType type )
+{
+	switch( type )
+	{
+	case AssetType::Model:
+		return "Model";
+	case AssetType::MaterialList:
+		return "MaterialList";
+	case AssetType::Terrain:
+		return "Terrain";
+	case AssetType::AttributeAnimation:
+		return "AttributeAnimation";
+	default:
+		return "Unknown";
+	}
+}
+
+void Cooker::Walk()
+{
+	std::vector<filesystem::path> paths;
+	std::error_code error;
+
+	files.clear();
+	results.clear();
+
+	for( auto it = filesystem::recursive_directory_iterator( inputDirectory, error ); it != filesystem::recursive_directory_iterator(); it.increment( error ) )
+	{
+		if( error )
+		{
+			printf( "Could not walk %s: %s\n", inputDirectory.string().c_str(), error.message().c_str() );
+			break;
+		}
+
+		if( !it->is_regular_file( error ) )
+			continue;
+
+		filesystem::path relativePath = it->path().lexically_relative( inputDirectory );
+
+		files.insert( IO::FileSystem::NormalizePath( relativePath.string() ) );
+		paths.push_back( relativePath );
+	}
+
+	for( const auto& path : paths )
+	{
+		std::string extension = path.extension().string();
+		AssetType type = GetAssetType( path );
+
+		//XMLs are identified when parsed
+		if( type == AssetType::Unknown && _strcmpi( extension.c_str(), ".xml" ) != 0 )
+			continue;
+
+		CookResult result;
+		result.filePath = path.string();
+		result.type = type;
+		result.state = CookState::Skipped;
+		result.hash = 0;
+		result.inputSize = 0;
+		result.outputSize = 0;
+		result.time = 0.0f;
+
+		results.push_back( result );
+	}
+
+	//Big Models first, so workers finish close to each other
+	std::stable_sort( results.begin(), results.end(), []( const CookResult& lhs, const CookResult& rhs ) { return lhs.type == AssetType::Model && rhs.type != AssetType::Model; } );
+}
+
+void Cooker::Cook( CookResult& result )
+{
+	auto start = std::chrono::steady_clock::now();
+
+	filesystem::path input = inputDirectory / result.filePath;
+	bool success = false;
+
+	if( result.type == AssetType::Model )
+		success = CookModel( input, outputDirectory / GetOutputPath( result ), result );
+	else
+	{
+		std::vector<char> data;
+
+		if( !IO::FileSystem::Get()->Read( input.string(), data ) )
+			result.message = "Could not read file";
+		else
+		{
+			result.inputSize = data.size();
+
+			if( result.type == AssetType::MaterialList )
+				success = CookMaterialList( data, outputDirectory / GetOutputPath( result ), result );
+			else
+				success = CookXML( data, outputDirectory / GetOutputPath( result ), result );
+		}
+	}
+
+	if( !success )
+		result.state = CookState::Failed;
+
+	result.time = std::chrono::duration<float, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+bool Cooker::CookModel( const filesystem::path& input, const filesystem::path& output, CookResult& result )
+{
+	IO::SMD::MeshLoader meshLoader;
+
+	if( !meshLoader.Open( input.string() ) )
+	{
+		result.message = "Invalid SMD file";
+		return false;
+	}
+
+	const IO::SMD::Header& header = *meshLoader.GetHeader();
+	result.inputSize = meshLoader.GetFile().Size();
+
+	//Objects of SMD 0.64 are stored after Materials, their size is only known by Graphics::Material
+	if( _strnicmp( header.header, "SMD Model data Ver 0.64", sizeof( header.header ) ) == 0 )
+	{
+		result.state = CookState::Skipped;
+		result.message = "SMD 0.64 is cooked by the engine on first load";
+		return true;
+	}
+
+	//Same Source Hash used by Model to validate Mesh Cache
+	unsigned long long sourceHash = IO::Hash64( meshLoader.GetFile().Data(), meshLoader.GetFile().Size() );
+	result.hash = IO::Hash64( &sourceHash, sizeof( sourceHash ), Version );
+
+	if( IsUpToDate( result, output ) )
+		return true;
+
+	//Materials Count is the header of Material Collection, right after Objects Info
+	int materialsCount = 0;
+
+	if( header.materialCount )
+	{
+		IO::BinaryReader reader = meshLoader.GetReader();
+		reader.Skip( 8 );
+		reader.Read( materialsCount );
+	}
+
+	//Models are cooked without Skeleton (Skinned Models have a Skeleton Hash and are cooked by the engine)
+	std::vector<IO::SMD::MeshGeometry> geometries( meshLoader.GetObjects().Size() );
+	std::vector<IO::SMD::MeshGeometryView> views;
+	views.reserve( geometries.size() );
+
+	for( size_t i = 0; i < geometries.size(); i++ )
+	{
+		IO::SMD::MeshData meshData;
+
+		if( !meshLoader.SeekObject( i ) || !meshLoader.ReadMesh( meshData, false, false ) )
+		{
+			result.message = "Could not read object " + std::to_string( i );
+			return false;
+		}
+
+		geometries[i].Build( meshData, std::vector<int>(), materialsCount );
+		views.push_back( geometries[i].View() );
+	}
+
+	std::error_code error;
+	filesystem::create_directories( output.parent_path(), error );
+
+	if( !IO::SMD::MeshCache::Write( output.string(), sourceHash, 0, views ) )
+	{
+		result.message = "Could not write " + output.string();
+		return false;
+	}
+
+	result.state = CookState::Cooked;
+	result.outputSize = (size_t)filesystem::file_size( output, error );
+
+	return true;
+}
+
+bool Cooker::CookMaterialList( const std::vector<char>& data, const filesystem::path& output, CookResult& result )
+{
+	std::istringstream stream( std::string( data.data(), data.size() ) );
+	std::string cooked;
+	std::string line;
+
+	//Materials that don't exist are resolved here, so the engine doesn't look for them
+	while( std::getline( stream, line ) )
+	{
+		if( !line.empty() && line.back() == '\r' )
+			line.pop_back();
+
+		if( line.find( "NoTexture" ) == std::string::npos && Exists( line ) )
+			cooked += line;
+
+		cooked += '\n';
+	}
+
+	//Output depends on which Materials exist too
+	result.hash = IO::Hash64( cooked.data(), cooked.length(), IO::Hash64( data.data(), data.size(), Version ) );
+
+	if( IsUpToDate( result, output ) )
+		return true;
+
+	std::error_code error;
+	filesystem::create_directories( output.parent_path(), error );
+
+	std::ofstream file( output, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+	file.write( cooked.data(), cooked.length() );
+
+	if( !file.good() )
+	{
+		result.message = "Could not write " + output.string();
+		return false;
+	}
+
+	result.state = CookState::Cooked;
+	result.outputSize = cooked.length();
+
+	return true;
+}
+
+bool Cooker::CookXML( const std::vector<char>& data, const filesystem::path& output, CookResult& result )
+{
+	pugi::xml_document doc;
+
+	if( !doc.load_buffer( data.data(), data.size() ) )
+	{
+		result.message = "Invalid XML";
+		return false;
+	}
+
+	std::string root = doc.document_element().name();
+
+	if( root == "Terrain" )
+		result.type = AssetType::Terrain;
+	else if( root == "AttributeAnimation" )
+		result.type = AssetType::AttributeAnimation;
+	else
+	{
+		//Not an asset cooked by Cooker
+		result.state = CookState::Skipped;
+		return true;
+	}
+
+	result.hash = IO::Hash64( data.data(), data.size(), Version );
+
+	if( IsUpToDate( result, output ) )
+		return true;
+
+	//Whitespace, comments and indentation removed
+	std::ostringstream stream;
+	doc.save( stream, "", pugi::format_raw );
+	std::string cooked = stream.str();
+
+	std::error_code error;
+	filesystem::create_directories( output.parent_path(), error );
+
+	std::ofstream file( output, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc );
+	file.write( cooked.data(), cooked.length() );
+
+	if( !file.good() )
+	{
+		result.message = "Could not write " + output.string();
+		return false;
+	}
+
+	result.state = CookState::Cooked;
+	result.outputSize = cooked.length();
+
+	return true;
+}
+
+std::string Cooker::GetOutputPath( const CookResult& result )
+{
+	//Model loads your Mesh Cache from SMD path + "c"
+	if( result.type == AssetType::Model )
+		return result.filePath + "c";
+
+	return result.filePath;
+}
+
+bool Cooker::IsUpToDate( CookResult& result, const filesystem::path& output ) const
+{
+	if( force )
+		return false;
+
+	auto it = manifest.find( result.filePath );
+	std::error_code error;
+
+	if( it == manifest.end() || it->second != result.hash || !filesystem::is_regular_file( output, error ) )
+		return false;
+
+	result.state = CookState::UpToDate;
+	result.outputSize = (size_t)filesystem::file_size( output, error );
+
+	return true;
+}
+
+AssetType Cooker::GetAssetType( const filesystem::path& filePath ) const
+{
+	std::string extension = filePath.extension().string();
+
+	if( _strcmpi( extension.c_str(), ".smd" ) == 0 )
+		return AssetType::Model;
+
+	//Material List is loaded from SMD path with .txt extension
+	if( _strcmpi( extension.c_str(), ".txt" ) == 0 )
+	{
+		filesystem::path modelPath = filePath;
+		modelPath.replace_extension( ".smd" );
+
+		if( Exists( modelPath.string() ) )
+			return AssetType::MaterialList;
+	}
+
+	return AssetType::Unknown;
+}
+
+bool Cooker::Exists( const std::string& filePath ) const
+{
+	if( filePath.empty() )
+		return false;
+
+	return files.find( IO::FileSystem::NormalizePath( filePath ) ) != files.end();
+}
+
+void Cooker::ReadManifest()
+{
+	manifest.clear();
+
+	std::ifstream file( outputDirectory / ManifestFileName );
+	std::string line;
+
+	//Each line is "<hash> <asset path>"
+	while( std::getline( file, line ) )
+	{
+		size_t separator = line.find( ' ' );
+
+		if( separator == std::string::npos )
+			continue;
+
+		manifest[line.substr( separator + 1 )] = std::stoull( line.substr( 0, separator ), nullptr, 16 );
+	}
+}
+
+bool Cooker::WriteManifest() const
+{
+	std::error_code error;
+	filesystem::create_directories( outputDirectory, error );
+
+	std::ofstream file( outputDirectory / ManifestFileName, std::ofstream::out | std::ofstream::trunc );
+
+	if( !file.is_open() )
+	{
+		printf( "Could not write manifest on %s\n", outputDirectory.string().c_str() );
+		return false;
+	}
+
+	//Failed assets are left out, so they are cooked again
+	for( const auto& result : results )
+		if( result.state == CookState::Cooked || result.state == CookState::UpToDate )
+			file << std::hex << result.hash << " " << result.filePath << "\n";
+
+	return file.good();
+}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+namespace Delta3D::Tools
+{
+enum class AssetType
+{
+	Unknown,
+
+	Model,	//!< SMD Model, cooked to Mesh Cache (.smdc)
+	MaterialList,	//!< Material List of a Model (.txt), missing Materials are resolved offline
+	Terrain,	//!< Terrain XML, minified
+	AttributeAnimation,	//!< Attribute Animation XML, minified
+};
+
+enum class CookState
+{
+	Cooked,
+	UpToDate,	//!< Input hash didn't change since last cook
+	Skipped,	//!< Asset can't be cooked offline (engine cooks it on first load)
+	Failed,
+};
+
+struct CookResult
+{
+	std::string filePath;	//!< Asset Path relative to input directory
+	AssetType type;	//!< Asset Type
+	CookState state;	//!< Result
+	std::string message;	//!< Reason of failure or skip
+
+	unsigned long long hash;	//!< Hash of Input
+	size_t inputSize;	//!< Size in bytes of Input
+	size_t outputSize;	//!< Size in bytes of Output
+	float time;	//!< Cook Time in milliseconds
+};
+
+class Cooker
+{
+public:
+	//! Cooker Format Version (increase it when any output changes).
+	static const unsigned int Version = 1;
+
+	/**
+	 * Construct a Cooker
+	 * @param inputDirectory_ Root of Asset Tree (game directory)
+	 * @param outputDirectory_ Directory where cooked files are written with the same layout
+	 */
+	Cooker( const std::string& inputDirectory_, const std::string& outputDirectory_ );
+
+	//! Deconstructor.
+	~Cooker() = default;
+
+	//! Set if every asset is cooked, even if your hash didn't change.
+	void SetForce( bool force_ ) { force = force_; }
+
+	/**
+	 * Walk Asset Tree and cook changed assets in parallel
+	 * @return True if no asset failed
+	 */
+	bool Run();
+
+	/**
+	 * Pack every cooked file of output directory
+	 * @param filePath Path of Pack
+	 * @return True if Pack was written
+	 */
+	bool WritePack( const std::string& filePath );
+
+	//! Print per asset timing and size, plus totals.
+	void PrintReport() const;
+
+	//! Results Getter.
+	const std::vector<CookResult>& GetResults() const { return results; }
+
+	//! Get Asset Type name.
+	static const char* GetTypeName( AssetType type );
+private:
+	//! Find assets on input directory and register every file (for references lookup).
+	void Walk();
+
+	//! Cook an Asset if your Input changed.
+	void Cook( CookResult& result );
+
+	//! Cook SMD Model to Mesh Cache.
+	bool CookModel( const filesystem::path& input, const filesystem::path& output, CookResult& result );
+
+	//! Cook Material List.
+	bool CookMaterialList( const std::vector<char>& data, const filesystem::path& output, CookResult& result );
+
+	//! Cook XML.
+	bool CookXML( const std::vector<char>& data, const filesystem::path& output, CookResult& result );
+
+	//! Get Output File of an Asset (relative to output directory).
+	static std::string GetOutputPath( const CookResult& result );
+
+	//! Check if Asset was cooked with same Input and your Output still exists.
+	bool IsUpToDate( CookResult& result, const filesystem::path& output ) const;
+
+	//! Get Asset Type of a File (XMLs are identified by your root element when cooked).
+	AssetType GetAssetType( const filesystem::path& filePath ) const;
+
+	//! Check if a File exists on input directory (paths on asset files are case insensitive).
+	bool Exists( const std::string& filePath ) const;
+
+	//! Read Manifest with hash of last cook of each asset.
+	void ReadManifest();
+
+	//! Write Manifest.
+	bool WriteManifest() const;
+private:
+	filesystem::path inputDirectory;	//!< Root of Asset Tree
+	filesystem::path outputDirectory;	//!< Root of cooked files
+	bool force;	//!< Cook assets even if up to date
+
+	std::unordered_set<std::string> files;	//!< Every File on input directory (normalized relative paths)
+	std::unordered_map<std::string, unsigned long long> manifest;	//!< Hash of last cook by asset path
+	std::vector<CookResult> results;	//!< Assets found by Walk
+	float elapsedTime;	//!< Wall time of last Run in milliseconds
+};
+}
\ No newline at end of file
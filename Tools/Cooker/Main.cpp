@@ -0,0 +1,45 @@
+#include "PrecompiledHeader.h"
+#include "Cooker.h"
+
+static void PrintUsage()
+{
+	printf( "Usage: Cooker <input directory> <output directory> [-pack <file>] [-force]\n" );
+	printf( "  -pack <file>  Pack every cooked file after cooking\n" );
+	printf( "  -force        Cook every asset, even if up to date\n" );
+}
+
+int main( int argc, char* argv[] )
+{
+	if( argc < 3 )
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::string packPath;
+	bool force = false;
+
+	for( int i = 3; i < argc; i++ )
+	{
+		if( _strcmpi( argv[i], "-pack" ) == 0 && i + 1 < argc )
+			packPath = argv[++i];
+		else if( _strcmpi( argv[i], "-force" ) == 0 )
+			force = true;
+		else
+		{
+			PrintUsage();
+			return 2;
+		}
+	}
+
+	Delta3D::Tools::Cooker cooker( argv[1], argv[2] );
+	cooker.SetForce( force );
+
+	bool success = cooker.Run();
+	cooker.PrintReport();
+
+	if( success && !packPath.empty() )
+		success = cooker.WritePack( packPath );
+
+	return success ? 0 : 1;
+}
\ No newline at end of file
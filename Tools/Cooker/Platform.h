@@ -0,0 +1,223 @@
+#pragma once
+
+//Delta3D headers convert Math types to D3DX ones, Cooker never creates a device so only the layout is needed
+#define D3DX_PI ((float)3.141592654f)
+
+struct D3DXVECTOR2
+{
+	float x, y;
+
+	D3DXVECTOR2( const float* f ) : x( f[0] ), y( f[1] ) {}
+};
+
+struct D3DXVECTOR3
+{
+	float x, y, z;
+
+	D3DXVECTOR3( const float* f ) : x( f[0] ), y( f[1] ), z( f[2] ) {}
+};
+
+struct D3DXMATRIX
+{
+	float m[16];
+
+	D3DXMATRIX( const float* f ) { memcpy( m, f, sizeof( m ) ); }
+};
+
+#ifndef _WIN32
+//POSIX implementation of the Win32 calls used by Delta3D IO (file mapping, logging and CRT secure functions)
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef void* HANDLE;
+typedef unsigned int DWORD;
+typedef int BOOL;
+typedef long long LONGLONG;
+
+struct LARGE_INTEGER
+{
+	LONGLONG QuadPart;
+};
+
+struct SYSTEM_INFO
+{
+	DWORD dwAllocationGranularity;
+};
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define GENERIC_READ 0
+#define FILE_SHARE_READ 0
+#define OPEN_EXISTING 0
+#define FILE_ATTRIBUTE_NORMAL 0
+#define FILE_FLAG_SEQUENTIAL_SCAN 0
+#define FILE_FLAG_RANDOM_ACCESS 0
+#define PAGE_READONLY 0
+#define FILE_MAP_READ 0
+
+#define _countof( a ) (sizeof( a ) / sizeof( (a)[0] ))
+#define _strnicmp strncasecmp
+#define _strcmpi strcasecmp
+
+#define DEFINE_ENUM_FLAG_OPERATORS( T ) \
+	inline T operator|( T a, T b ) { return (T)((int)a | (int)b); } \
+	inline T operator&( T a, T b ) { return (T)((int)a & (int)b); } \
+	inline T& operator|=( T& a, T b ) { return a = a | b; } \
+	inline T& operator&=( T& a, T b ) { return a = a & b; }
+
+namespace Delta3D::Platform
+{
+struct FileHandle
+{
+	int descriptor;	//!< File Descriptor
+};
+
+//Size of each mapped view, munmap needs it
+inline std::unordered_map<const void*, size_t> mappedViews;
+inline std::mutex mappedViewsMutex;
+}
+
+inline HANDLE CreateFileA( const char* filePath, DWORD, DWORD, void*, DWORD, DWORD, void* )
+{
+	int descriptor = open( filePath, O_RDONLY );
+
+	if( descriptor < 0 )
+		return INVALID_HANDLE_VALUE;
+
+	return new Delta3D::Platform::FileHandle{ descriptor };
+}
+
+inline BOOL CloseHandle( HANDLE handle )
+{
+	auto file = (Delta3D::Platform::FileHandle*)handle;
+
+	if( file == nullptr || handle == INVALID_HANDLE_VALUE )
+		return false;
+
+	close( file->descriptor );
+	delete file;
+
+	return true;
+}
+
+inline BOOL GetFileSizeEx( HANDLE handle, LARGE_INTEGER* size )
+{
+	struct stat status;
+
+	if( fstat( ((Delta3D::Platform::FileHandle*)handle)->descriptor, &status ) != 0 )
+		return false;
+
+	size->QuadPart = (LONGLONG)status.st_size;
+
+	return true;
+}
+
+inline BOOL ReadFile( HANDLE handle, void* buffer, DWORD size, DWORD* bytesRead, void* )
+{
+	ssize_t result = read( ((Delta3D::Platform::FileHandle*)handle)->descriptor, buffer, size );
+
+	if( result < 0 )
+		return false;
+
+	*bytesRead = (DWORD)result;
+
+	return true;
+}
+
+inline HANDLE CreateFileMappingA( HANDLE handle, void*, DWORD, DWORD, DWORD, void* )
+{
+	//Mapping owns a duplicated descriptor, so both handles can be closed in any order
+	int descriptor = dup( ((Delta3D::Platform::FileHandle*)handle)->descriptor );
+
+	if( descriptor < 0 )
+		return nullptr;
+
+	return new Delta3D::Platform::FileHandle{ descriptor };
+}
+
+inline void* MapViewOfFile( HANDLE mapping, DWORD, DWORD offsetHigh, DWORD offsetLow, size_t size )
+{
+	int descriptor = ((Delta3D::Platform::FileHandle*)mapping)->descriptor;
+	off_t offset = (off_t)(((unsigned long long)offsetHigh << 32) | offsetLow);
+
+	//Whole File
+	if( size == 0 )
+	{
+		struct stat status;
+
+		if( fstat( descriptor, &status ) != 0 || status.st_size <= offset )
+			return nullptr;
+
+		size = (size_t)(status.st_size - offset);
+	}
+
+	void* view = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, offset );
+
+	if( view == MAP_FAILED )
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock( Delta3D::Platform::mappedViewsMutex );
+	Delta3D::Platform::mappedViews[view] = size;
+
+	return view;
+}
+
+inline BOOL UnmapViewOfFile( const void* view )
+{
+	size_t size = 0;
+
+	{
+		std::lock_guard<std::mutex> lock( Delta3D::Platform::mappedViewsMutex );
+
+		auto it = Delta3D::Platform::mappedViews.find( view );
+		if( it == Delta3D::Platform::mappedViews.end() )
+			return false;
+
+		size = it->second;
+		Delta3D::Platform::mappedViews.erase( it );
+	}
+
+	return munmap( (void*)view, size ) == 0;
+}
+
+inline void GetSystemInfo( SYSTEM_INFO* systemInfo )
+{
+	systemInfo->dwAllocationGranularity = (DWORD)sysconf( _SC_PAGESIZE );
+}
+
+inline BOOL DeleteFileA( const char* filePath )
+{
+	return remove( filePath ) == 0;
+}
+
+inline int _vscprintf( const char* format, va_list args )
+{
+	va_list copy;
+	va_copy( copy, args );
+	int length = vsnprintf( nullptr, 0, format, copy );
+	va_end( copy );
+
+	return length;
+}
+
+inline int vsprintf_s( char* buffer, size_t size, const char* format, va_list args )
+{
+	return vsnprintf( buffer, size, format, args );
+}
+
+inline int localtime_s( struct tm* out, const time_t* time )
+{
+	return localtime_r( time, out ) ? 0 : -1;
+}
+
+inline int fopen_s( FILE** file, const char* filePath, const char* mode )
+{
+	*file = fopen( filePath, mode );
+
+	return *file ? 0 : -1;
+}
+#endif
+
+typedef DWORD D3DCOLOR;
\ No newline at end of file
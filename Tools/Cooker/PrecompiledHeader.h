@@ -0,0 +1,49 @@
+#pragma once
+
+//Cooker builds the D3D free parts of Delta3D (IO, Core and Math), so it runs on machines without a GPU
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#undef min
+#undef max
+#endif
+
+#include <emmintrin.h>
+
+//STD:
+#include <cstdio>
+#include <cstring>
+#include <cstdarg>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <array>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <filesystem>
+
+//PugiXML:
+#include <pugixml.hpp>
+
+#include "Platform.h"
+
+#include "../../Source/IO/Log.h"
+
+namespace filesystem = std::filesystem;
\ No newline at end of file
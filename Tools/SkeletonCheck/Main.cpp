@@ -0,0 +1,150 @@
+#include "PrecompiledHeader.h"
+
+#include "../../Source/Graphics/Graphics.h"
+#include "../../Source/Graphics/Model.h"
+#include "../../Source/Graphics/SkeletonEvaluator.h"
+
+using namespace Delta3D;
+
+struct SkeletonPose
+{
+	const char* name;	//!< Pose Name
+	Math::Vector3Int rotation;	//!< Rotation to Model
+	Math::Vector3 scaling;	//!< Scaling to Model
+};
+
+static void PrintUsage()
+{
+	printf( "Usage: SkeletonCheck <skeleton file> [-step <frames>] [-epsilon <value>] [-iterations <count>]\n" );
+	printf( "  -step <frames>        Frames between sampled frames (default 7)\n" );
+	printf( "  -epsilon <value>      Max difference of World Matrices (default 0.001)\n" );
+	printf( "  -iterations <count>   Passes over sampled frames timed on each path (default 100)\n" );
+}
+
+static const char* GetArgument( int argc, char* argv[], const char* name )
+{
+	for( int i = 2; i + 1 < argc; i++ )
+		if( _strcmpi( argv[i], name ) == 0 )
+			return argv[i + 1];
+
+	return nullptr;
+}
+
+int main( int argc, char* argv[] )
+{
+	if( argc < 2 )
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	const char* step = GetArgument( argc, argv, "-step" );
+	const char* epsilon = GetArgument( argc, argv, "-epsilon" );
+	const char* iterations = GetArgument( argc, argv, "-iterations" );
+
+	int framesStep = step ? std::max( atoi( step ), 1 ) : 7;
+	float maxError = epsilon ? (float)atof( epsilon ) : 0.001f;
+	int iterationsCount = iterations ? std::max( atoi( iterations ), 1 ) : 100;
+
+	//Graphics is never initialized, Skeleton is read with streamed Meshes so no GPU resource is created
+	Graphics::Graphics::GetInstance();
+	Graphics::Model::SetUseMeshCache( false );
+
+	Graphics::Model skeleton;
+	skeleton.SetStreamMeshes( true );
+
+	if( !skeleton.Read( argv[1] ) || !skeleton.Create() )
+	{
+		printf( "Could not read Skeleton %s\n", argv[1] );
+		return 1;
+	}
+
+	const std::vector<Graphics::Mesh*>& bones = skeleton.orderedMeshes;
+
+	Graphics::SkeletonEvaluator evaluator;
+
+	if( bones.empty() || !evaluator.Build( bones ) )
+	{
+		printf( "Could not build Skeleton Evaluator of %s\n", argv[1] );
+		return 1;
+	}
+
+	std::vector<int> frames;
+	for( int frame = 0; frame <= skeleton.maxFrame; frame += framesStep )
+		frames.push_back( frame );
+
+	printf( "Skeleton %s: %d Bones, %d Animations, %zu frames sampled\n", argv[1], (int)bones.size(), (int)skeleton.animationsFrameInfo.size(), frames.size() );
+
+	//Model Rotation and Scaling are folded into Bones World Matrices, so both paths are compared with them too
+	const SkeletonPose poses[] =
+	{
+		{ "base", Math::Vector3Int::Null, Math::Vector3( 1.0f, 1.0f, 1.0f ) },
+		{ "rotated", Math::Vector3Int( 0, 1024, 0 ), Math::Vector3( 1.0f, 1.0f, 1.0f ) },
+		{ "scaled", Math::Vector3Int( 0, 512, 0 ), Math::Vector3( 1.5f, 0.75f, 1.25f ) },
+	};
+
+	int mismatches = 0;
+
+	for( const auto& pose : poses )
+	{
+		skeleton.scaling = pose.scaling;
+
+		float poseError = 0.0f;
+		int poseMismatches = 0;
+
+		for( int frame : frames )
+		{
+			evaluator.Evaluate( frame, pose.rotation, pose.scaling );
+
+			const Math::Matrix4* worlds = evaluator.GetWorlds();
+
+			for( size_t i = 0; i < bones.size(); i++ )
+			{
+				bones[i]->Animate( frame, pose.rotation );
+
+				float error = 0.0f;
+				for( int j = 0; j < 16; j++ )
+					error = std::max( error, fabsf( bones[i]->world.f[j] - worlds[i].f[j] ) );
+
+				poseError = std::max( poseError, error );
+
+				if( error > maxError )
+				{
+					if( poseMismatches++ == 0 )
+						printf( "  %s: Bone %s differs by %f on frame %d\n", pose.name, bones[i]->name, error, frame );
+				}
+			}
+		}
+
+		printf( "%-8s max error %f, %d Bones over epsilon\n", pose.name, poseError, poseMismatches );
+
+		mismatches += poseMismatches;
+	}
+
+	skeleton.scaling = Math::Vector3( 1.0f, 1.0f, 1.0f );
+
+	//Throughput of each path over the same frames
+	double evaluatedBones = (double)bones.size()* (double)frames.size()* (double)iterationsCount;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for( int i = 0; i < iterationsCount; i++ )
+		for( int frame : frames )
+			evaluator.Evaluate( frame, Math::Vector3Int::Null, skeleton.scaling );
+
+	double evaluatorTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	start = std::chrono::steady_clock::now();
+
+	for( int i = 0; i < iterationsCount; i++ )
+		for( int frame : frames )
+			for( const auto& bone : bones )
+				bone->Animate( frame );
+
+	double meshesTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	printf( "Skeleton Evaluator %10.2f M bones/s\n", evaluatorTime > 0.0 ? evaluatedBones / evaluatorTime / 1000000.0 : 0.0 );
+	printf( "Mesh::Animate      %10.2f M bones/s\n", meshesTime > 0.0 ? evaluatedBones / meshesTime / 1000000.0 : 0.0 );
+
+	return mismatches ? 1 : 0;
+}
\ No newline at end of file
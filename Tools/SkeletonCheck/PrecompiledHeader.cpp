@@ -0,0 +1 @@
+#include "PrecompiledHeader.h"
\ No newline at end of file
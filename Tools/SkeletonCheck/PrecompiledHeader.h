@@ -0,0 +1,4 @@
+#pragma once
+
+//SkeletonCheck links Delta3D library, Graphics is created without a Device so it runs headless
+#include "../../Source/Header/PrecompiledHeader.h"
\ No newline at end of file